@@ -26,15 +26,30 @@
 #include <math.h>
 #include <string.h>
 #include "fecdec.h"
+#include "lib_gf256.h"
 
 
 #define _now(this) gst_clock_get_time (this->sysclock)
-
-typedef struct {
+#define _rcv_slot(this, seq) (this->rcv_packets + ((seq) & (FECDECODER_WINDOW_SIZE - 1)))
+#define _fec_slot(this, seq) (this->fec_packets + ((seq) & (FECDECODER_WINDOW_SIZE - 1)))
+
+//Packets older than this compared to the last received one are not used for repairing
+#define FECDECODER_OBSOLATION_TIME (300 * GST_MSECOND)
+//Number of packets kept if no FEC packet is available
+#define FECDECODER_MAX_PACKETS_WITHOUT_FEC 20
+//Number of sequence numbers a missing packet at the head can wait for reordering
+#define FECDECODER_MAX_REORDER_SPAN 64
+
+//A fec packet slot holds either a single parity XOR buffer or
+//the Reed-Solomon repair buffers of a block indexed by their repair index
+struct _FECPacket{
   guint16 base_sn;
   guint16 protected_num;
+  GstClockTime added;
   GstBuffer* buffer;
-}FECPacket;
+  GstBuffer* repairs[GST_RTPFEC_MAX_REPAIR_NUM];
+  gint32 repairs_num;
+};
 
 static gint
 _cmp_uint16 (guint16 x, guint16 y)
@@ -59,10 +74,14 @@ G_DEFINE_TYPE (FECDecoder, fecdecoder, G_TYPE_OBJECT);
 
 static void fecdecoder_finalize (GObject * object);
 static void _obsolete_packets(FECDecoder *this);
-static gint _cmp_rcvpacket_abs_seq_custom(RcvPacket *a, RcvPacket* b, gpointer udata);
-static gint _cmp_fec_packet_by_missing_seq(FECPacket *fec_packet, guint16* missing_seq);
-static gint _cmp_rcv_packet_by_missing_seq(RcvPacket *rcv_packet, FECPacket* fec_packet);
-static GstBuffer* _get_repaired_rtpbuffer(FECDecoder *this, GList* rcv_packets_list, FECPacket* fec_packet, guint16 missing_seq);
+static void _release_rcv_slot(FECDecoder *this, guint16 seq);
+static void _release_fec_slot(FECDecoder *this, guint16 base_sn);
+static void _release_head(FECDecoder *this);
+static void _advance_head(FECDecoder *this, guint16 head_seq);
+static GstBuffer* _get_repaired_rtpbuffer(FECDecoder *this, RcvPacket** rcv_packets, gint32 rcv_packets_num, FECPacket* fec_packet, guint16 missing_seq);
+static GstBuffer* _get_rs_repaired_rtpbuffer(FECDecoder *this, FECPacket* fec_packet, guint16 missing_seq);
+static FECPacket* _make_fec_packet(FECDecoder *this, guint16 base_sn, guint16 protected_num);
+static void _clear_fec_packet(FECPacket* fec_packet);
 
 void
 fecdecoder_class_init (FECDecoderClass * klass)
@@ -82,12 +101,23 @@ void
 fecdecoder_finalize (GObject * object)
 {
   FECDecoder *this;
+  gint32 i;
   this = FECDECODER(object);
 
   g_object_unref(this->sysclock);
 
-  g_queue_free(this->rcv_packets);
-  g_queue_free(this->fec_packets);
+  for(i = 0; i < FECDECODER_WINDOW_SIZE; ++i){
+    if(this->rcv_packets[i]){
+      rcvpacket_unref(this->rcv_packets[i]);
+    }
+    if(this->fec_packets[i]){
+      _clear_fec_packet(this->fec_packets[i]);
+      g_slice_free(FECPacket, this->fec_packets[i]);
+    }
+  }
+  while(!g_queue_is_empty(this->fec_recycle)){
+    g_slice_free(FECPacket, g_queue_pop_head(this->fec_recycle));
+  }
   g_queue_free(this->fec_recycle);
 }
 
@@ -96,8 +126,6 @@ fecdecoder_init (FECDecoder * this)
 {
   this->sysclock    = gst_system_clock_obtain();
 
-  this->rcv_packets = g_queue_new();
-  this->fec_packets = g_queue_new();
   this->fec_recycle = g_queue_new();
   g_mutex_init(&this->mutex);
 }
@@ -116,143 +144,309 @@ FECDecoder *make_fecdecoder(void)
   return this;
 }
 
-gint _cmp_fec_packet_by_missing_seq(FECPacket *fec_packet, guint16* missing_seq)
-{
-  if (_cmp_uint16(*missing_seq, fec_packet->base_sn) < 0) {
-    return -1;
-  }
-  if (_cmp_uint16(fec_packet->base_sn + fec_packet->protected_num - 1, *missing_seq) < 0) {
-    return -1;
-  }
-  return 0;
-}
-
-
-gint _cmp_rcv_packet_by_missing_seq(RcvPacket *rcv_packet, FECPacket* fec_packet)
-{
-  if (_cmp_uint16(rcv_packet->abs_seq, fec_packet->base_sn) < 0) {
-    return -1;
-  }
-  if (_cmp_uint16(fec_packet->base_sn + fec_packet->protected_num - 1, rcv_packet->abs_seq) < 0) {
-    return 1;
-  }
-  return 0;
+static gboolean _is_fec_packet_obsolete(FECDecoder *this, FECPacket* fec_packet) {
+  return fec_packet->added + FECDECODER_OBSOLATION_TIME < this->last_received;
 }
 
-static gboolean _is_repair_possible(GList *rcv_packets_list, FECPacket* fec_packet) {
-  if(!rcv_packets_list) {
-    return FALSE;
+//Collects the received packets protected by the fec packet. Repair is possible
+//with a single parity only if exactly the missing one is absent.
+static gint32 _collect_protected_packets(FECDecoder *this, FECPacket* fec_packet, guint16 missing_seq, RcvPacket** result) {
+  gint32 i, count = 0;
+  guint16 seq;
+  RcvPacket* packet;
+  for(i = 0; i < fec_packet->protected_num; ++i){
+    seq = fec_packet->base_sn + i;
+    if(seq == missing_seq){
+      continue;
+    }
+    packet = *_rcv_slot(this, seq);
+    if(!packet || packet->abs_seq != seq){
+      return -1;
+    }
+    result[count++] = packet;
   }
-  // TODO: if we start using parity format the possibilty of the repair must be changed
-  return g_list_length(rcv_packets_list) == fec_packet->protected_num - 1;
+  return count;
 }
 
 GstBuffer* fecdecoder_pop_rtp_packet(FECDecoder *this, guint16 seq_num)
 {
   GstBuffer* result = NULL;
-  GList* rcv_packets_list = NULL, *fec_it;
+  RcvPacket* rcv_packets[GST_RTPFEC_MAX_PROTECTION_NUM];
+  gint32 rcv_packets_num;
   FECPacket* fec_packet;
-  GList* rtp_it;
+  guint16 offset, base_sn;
   g_mutex_lock (&this->mutex);
-  for(fec_it = this->fec_packets->head; fec_it; fec_it = fec_it->next) {
-    if (_cmp_fec_packet_by_missing_seq(fec_it->data,  &seq_num) != 0) {
+  //Any fec packet protecting seq_num has its base at most
+  //GST_RTPFEC_MAX_PROTECTION_NUM - 1 before it.
+  for(offset = 0; offset < GST_RTPFEC_MAX_PROTECTION_NUM; ++offset) {
+    base_sn = seq_num - offset;
+    fec_packet = *_fec_slot(this, base_sn);
+    if (!fec_packet || fec_packet->base_sn != base_sn || fec_packet->protected_num <= offset) {
       continue;
     }
-    fec_packet = fec_it->data;
-    for (rtp_it = this->rcv_packets->head; rtp_it; rtp_it = rtp_it->next) {
-      if (_cmp_rcv_packet_by_missing_seq(rtp_it->data, fec_packet) != 0) {
+    if (_is_fec_packet_obsolete(this, fec_packet)) {
+      _release_fec_slot(this, base_sn);
+      continue;
+    }
+    if (!fec_packet->buffer) {
+      result = _get_rs_repaired_rtpbuffer(this, fec_packet, seq_num);
+      if(!result) {
         continue;
       }
-      rcv_packets_list = g_list_prepend(rcv_packets_list, rtp_it->data);
+      break;
     }
-    if(!_is_repair_possible(rcv_packets_list, fec_packet)) {
+    rcv_packets_num = _collect_protected_packets(this, fec_packet, seq_num, rcv_packets);
+    if(rcv_packets_num < 1) {
       continue;
     }
-    result = _get_repaired_rtpbuffer(this, rcv_packets_list, fec_packet, seq_num);
+    result = _get_repaired_rtpbuffer(this, rcv_packets, rcv_packets_num, fec_packet, seq_num);
     break;
   }
   g_mutex_unlock (&this->mutex);
   return result;
 }
 
+static void _push_rcv_packet(FECDecoder *this, RcvPacket *packet)
+{
+  RcvPacket** slot;
+  if(!this->initialized){
+    this->head_seq = this->tail_seq = packet->abs_seq;
+    this->initialized = TRUE;
+  }
+  if(_cmp_uint16(packet->abs_seq, this->head_seq) < 0){
+    //arrived after its window is obsolated
+    return;
+  }
+  if(FECDECODER_WINDOW_SIZE <= (guint16)(packet->abs_seq - this->head_seq)){
+    _advance_head(this, packet->abs_seq - FECDECODER_WINDOW_SIZE + 1);
+  }
+  slot = _rcv_slot(this, packet->abs_seq);
+  if(*slot){
+    rcvpacket_unref(*slot);
+  }
+  *slot = rcvpacket_ref(packet);
+  if(_cmp_uint16(this->tail_seq, packet->abs_seq) < 0){
+    this->tail_seq = packet->abs_seq;
+  }
+  this->last_received = MAX(this->last_received, packet->received);
+  _obsolete_packets(this);
+}
+
 void fecdecoder_push_rcv_packet(FECDecoder *this, RcvPacket *packet)
 {
   g_mutex_lock (&this->mutex);
-  packet = rcvpacket_ref(packet);
-  g_queue_insert_sorted(this->rcv_packets, packet, (GCompareDataFunc) _cmp_rcvpacket_abs_seq_custom, NULL);
-  _obsolete_packets(this);
+  _push_rcv_packet(this, packet);
+  g_mutex_unlock (&this->mutex);
+}
+
+void fecdecoder_push_rcv_packets(FECDecoder *this, RcvPacket **packets, gint32 packets_num)
+{
+  gint32 i;
+  g_mutex_lock (&this->mutex);
+  for(i = 0; i < packets_num; ++i){
+    _push_rcv_packet(this, packets[i]);
+  }
   g_mutex_unlock (&this->mutex);
 }
 
+static gboolean _read_fec_header(GstBuffer *buffer, guint16* base_sn, guint8* n_mask, guint8* m_mask) {
+  GstRTPFECHeader* fec_header;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  gboolean result = FALSE;
+  if(!gst_rtp_buffer_map(buffer, GST_MAP_READ, &rtp)){
+    return FALSE;
+  }
+  if(sizeof(GstRTPFECHeader) < gst_rtp_buffer_get_payload_len(&rtp)){
+    fec_header = (GstRTPFECHeader*) gst_rtp_buffer_get_payload(&rtp);
+    *base_sn = g_ntohs(fec_header->sn_base);
+    *n_mask  = fec_header->N_MASK;
+    *m_mask  = fec_header->M_MASK;
+    result   = TRUE;
+  }
+  gst_rtp_buffer_unmap(&rtp);
+  return result;
+}
+
 void fecdecoder_push_fec_buffer(FECDecoder *this, GstBuffer *buffer)
 {
   FECPacket* packet;
+  guint16 base_sn;
+  guint8 protected_num, m_mask;
   g_mutex_lock (&this->mutex);
-  packet = g_queue_is_empty(this->fec_recycle) ? g_slice_new0(FECPacket) : g_queue_pop_head(this->fec_recycle);
+  if(!_read_fec_header(buffer, &base_sn, &protected_num, &m_mask) ||
+     protected_num < 1 || GST_RTPFEC_MAX_PROTECTION_NUM < protected_num){
+    gst_buffer_unref(buffer);
+    goto done;
+  }
+  _release_fec_slot(this, base_sn);
+  packet = _make_fec_packet(this, base_sn, protected_num);
   packet->buffer = buffer;
-  {
-    GstRTPFECHeader* fec_header;
-    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
-    gst_rtp_buffer_map(packet->buffer, GST_MAP_READ, &rtp);
-    fec_header = (GstRTPFECHeader*) gst_rtp_buffer_get_payload(&rtp);
-    packet->base_sn = g_ntohs(fec_header->sn_base);
-    packet->protected_num = fec_header->N_MASK;
-    gst_rtp_buffer_unmap(&rtp);
+done:
+  g_mutex_unlock (&this->mutex);
+}
+
+//Repair packets of the same block are gathered in one slot,
+//a packet for another block or scheme at the same base replaces it.
+void fecdecoder_push_rs_fec_buffer(FECDecoder *this, GstBuffer *buffer)
+{
+  FECPacket* packet;
+  guint16 base_sn;
+  guint8 protected_num, repair_index;
+  g_mutex_lock (&this->mutex);
+  if(!_read_fec_header(buffer, &base_sn, &protected_num, &repair_index) ||
+     protected_num < 1 || GST_RTPFEC_MAX_PROTECTION_NUM < protected_num ||
+     GST_RTPFEC_MAX_REPAIR_NUM <= repair_index){
+    gst_buffer_unref(buffer);
+    goto done;
+  }
+  packet = *_fec_slot(this, base_sn);
+  if(!packet || packet->buffer || packet->base_sn != base_sn || packet->protected_num != protected_num){
+    _release_fec_slot(this, base_sn);
+    packet = _make_fec_packet(this, base_sn, protected_num);
+  }
+  if(packet->repairs[repair_index]){
+    gst_buffer_unref(packet->repairs[repair_index]);
+  }else{
+    ++packet->repairs_num;
   }
-  g_queue_push_tail(this->fec_packets, packet);
+  packet->repairs[repair_index] = buffer;
+done:
   g_mutex_unlock (&this->mutex);
 }
 
-void _obsolete_packets(FECDecoder *this) {
-  RcvPacket *rcv_packets_head,*rtp_tail;
-  FECPacket* fec_buffer;
-again:
-  if(g_queue_is_empty(this->rcv_packets)) {
-    return;
+FECPacket* _make_fec_packet(FECDecoder *this, guint16 base_sn, guint16 protected_num) {
+  FECPacket* packet;
+  packet = g_queue_is_empty(this->fec_recycle) ? g_slice_new0(FECPacket) : g_queue_pop_head(this->fec_recycle);
+  packet->base_sn       = base_sn;
+  packet->protected_num = protected_num;
+  packet->added         = this->last_received;
+  *_fec_slot(this, base_sn) = packet;
+  ++this->fec_packets_num;
+  return packet;
+}
+
+void _clear_fec_packet(FECPacket* fec_packet) {
+  gint32 i;
+  if(fec_packet->buffer){
+    gst_buffer_unref(fec_packet->buffer);
   }
-  if(g_queue_is_empty(this->fec_packets)) {
-    if(20 < g_queue_get_length(this->rcv_packets)) {
-      rcvpacket_unref(g_queue_pop_head(this->rcv_packets));
+  for(i = 0; i < GST_RTPFEC_MAX_REPAIR_NUM; ++i){
+    if(fec_packet->repairs[i]){
+      gst_buffer_unref(fec_packet->repairs[i]);
     }
+  }
+  memset(fec_packet, 0, sizeof(FECPacket));
+}
+
+void _release_rcv_slot(FECDecoder *this, guint16 seq) {
+  RcvPacket** slot = _rcv_slot(this, seq);
+  if(!*slot){
     return;
   }
-  rcv_packets_head = g_queue_peek_head(this->rcv_packets);
-  rtp_tail = g_queue_peek_tail(this->rcv_packets);
-  if (rtp_tail->received - rcv_packets_head->received < 300 * GST_MSECOND) {
+  rcvpacket_unref(*slot);
+  *slot = NULL;
+}
+
+void _release_fec_slot(FECDecoder *this, guint16 base_sn) {
+  FECPacket** slot = _fec_slot(this, base_sn);
+  if(!*slot){
     return;
   }
-  rcv_packets_head = g_queue_pop_head(this->rcv_packets);
-  fec_buffer = g_queue_peek_head(this->fec_packets);
-  if (_cmp_uint16(rcv_packets_head->abs_seq, fec_buffer->base_sn) < 0) {
-    rcvpacket_unref(rcv_packets_head);
-    goto again;
-  }
-  fec_buffer = g_queue_pop_head(this->fec_packets);
-  memset(fec_buffer, 0, sizeof(FECPacket));
-  g_queue_push_head(this->fec_recycle, fec_buffer);
-  rcvpacket_unref(rcv_packets_head);
-  goto again;
+  _clear_fec_packet(*slot);
+  g_queue_push_head(this->fec_recycle, *slot);
+  *slot = NULL;
+  --this->fec_packets_num;
 }
 
-gint _cmp_rcvpacket_abs_seq_custom(RcvPacket *a, RcvPacket* b, gpointer udata)
-{
-  return _cmp_uint16(a->abs_seq, b->abs_seq);
+//Moves the head of the window forward while it points to an obsolated packet.
+//Each sequence number is passed once, so it is amortized constant per packet.
+void _obsolete_packets(FECDecoder *this) {
+  RcvPacket* head;
+  guint16 span;
+  while(this->head_seq != this->tail_seq) {
+    head = *_rcv_slot(this, this->head_seq);
+    span = this->tail_seq - this->head_seq;
+    if(!head) {
+      if(span < FECDECODER_MAX_REORDER_SPAN) {
+        return;
+      }
+    } else if(this->fec_packets_num < 1) {
+      if(span < FECDECODER_MAX_PACKETS_WITHOUT_FEC) {
+        return;
+      }
+    } else if(this->last_received < head->received + FECDECODER_OBSOLATION_TIME) {
+      return;
+    }
+    _release_head(this);
+  }
 }
 
+//Releases the packet at the head and the fec packet sharing its slot
+//if its base is not ahead of the head, then steps the head forward.
+void _release_head(FECDecoder *this) {
+  FECPacket* fec_packet;
+  _release_rcv_slot(this, this->head_seq);
+  fec_packet = *_fec_slot(this, this->head_seq);
+  if(fec_packet && _cmp_uint16(fec_packet->base_sn, this->head_seq) <= 0) {
+    _release_fec_slot(this, this->head_seq);
+  }
+  ++this->head_seq;
+}
 
-GstBuffer* _get_repaired_rtpbuffer(FECDecoder *this, GList* rcv_packets_list, FECPacket* fec_packet, guint16 missing_seq) {
-  GList* it;
-  guint8 bitstring[1600];
-  gint16 bitstring_length;
-  guint8 fecbitstring[1600];
-  guint16 length = 0;
+//A jump of a window or more leaves nothing of the old window,
+//so both rings are cleared at once instead of passing every sequence number.
+void _advance_head(FECDecoder *this, guint16 head_seq) {
+  gint32 i;
+  if((guint16)(head_seq - this->head_seq) < FECDECODER_WINDOW_SIZE) {
+    while(this->head_seq != head_seq) {
+      _release_head(this);
+    }
+    return;
+  }
+  for(i = 0; i < FECDECODER_WINDOW_SIZE; ++i) {
+    _release_rcv_slot(this, i);
+    _release_fec_slot(this, i);
+  }
+  this->head_seq = head_seq;
+}
+
+
+static GstBuffer* _make_rtpbuffer_from_bitstring(guint8* bitstring, gint32 bitstring_length, guint16 missing_seq, guint32 ssrc) {
   GstBasicRTPHeader* rtpheader;
-  GstBuffer*         result = NULL;
   guint8* databed;
+  guint16 length = 0;
+
+  memcpy(&length, bitstring + 8, 2);
+  length = g_ntohs(length);
+  if(bitstring_length < length + 10){
+    //the repair went wrong
+    return NULL;
+  }
+
+  databed = g_malloc0(length + 12);
+
+  memcpy(databed,     bitstring,     2);
+  memcpy(databed + 4, bitstring + 4, 4);
+
+  rtpheader = (GstBasicRTPHeader*) databed;
+  rtpheader->version = 2;
+  rtpheader->seq_num = g_htons(missing_seq);
+  rtpheader->ssrc    = g_htonl(ssrc);
+
+  memcpy(databed + 12, bitstring + 10, length);
+
+  return gst_buffer_new_wrapped(databed, length + 12);
+}
+
+GstBuffer* _get_repaired_rtpbuffer(FECDecoder *this, RcvPacket** rcv_packets, gint32 rcv_packets_num, FECPacket* fec_packet, guint16 missing_seq) {
+  guint8 bitstrings[GST_RTPFEC_MAX_PROTECTION_NUM][1600];
+  gint16 bitstring_lengths[GST_RTPFEC_MAX_PROTECTION_NUM];
+  guint8* sources[GST_RTPFEC_MAX_PROTECTION_NUM];
+  gint32 sources_num, xor_length, i;
+  guint8* fecbitstring = bitstrings[0];
   guint32 fec_header_ssrc;
 
   memset(fecbitstring, 0, 1600);
-  memset(bitstring, 0, 1600);
 
   {
     GstRTPFECHeader* fec_header;
@@ -267,32 +461,106 @@ GstBuffer* _get_repaired_rtpbuffer(FECDecoder *this, GList* rcv_packets_list, FE
     memcpy(fecbitstring + 8, &fec_header->length_recovery, 2);
     memcpy(fecbitstring + 10, (guint8*)payload + sizeof(GstRTPFECHeader), payload_length - sizeof(GstRTPFECHeader));
     fec_header_ssrc = fec_header->ssrc;
+    xor_length = payload_length - sizeof(GstRTPFECHeader) + 10;
     gst_rtp_buffer_unmap(&rtp);
   }
 
-  for(it = rcv_packets_list; it; it = it->next){
-    RcvPacket *rcv_packet = it->data;
-    rtpfecbuffer_setup_bitstring(rcv_packet->buffer, bitstring, &bitstring_length);
-    do_bitxor(fecbitstring, bitstring, bitstring_length);
+  //The fec bitstring is the first source, the protected packets are the rest.
+  //A fec packet protects at most GST_RTPFEC_MAX_PROTECTION_NUM packets
+  //and one of them is the missing one, so all of them fit into one pass.
+  sources[0] = fecbitstring;
+  for(sources_num = 1; sources_num <= rcv_packets_num; ++sources_num){
+    rtpfecbuffer_setup_bitstring(rcv_packets[sources_num - 1]->buffer, bitstrings[sources_num], &bitstring_lengths[sources_num]);
+    sources[sources_num] = bitstrings[sources_num];
+    xor_length = MAX(xor_length, bitstring_lengths[sources_num]);
   }
-  memcpy(&length, fecbitstring + 8, 2);
-  length = g_ntohs(length);
-
-  databed = g_malloc0(length + 12);
+  for(i = 1; i < sources_num; ++i){
+    memset(bitstrings[i] + bitstring_lengths[i], 0, xor_length - bitstring_lengths[i]);
+  }
+  do_bitxor_n(fecbitstring, sources, sources_num, xor_length);
 
-  memcpy(databed,     fecbitstring,     2);
-  memcpy(databed + 4, fecbitstring + 4, 4);
+  return _make_rtpbuffer_from_bitstring(fecbitstring, xor_length, missing_seq, g_ntohl(fec_header_ssrc));
+}
 
-  rtpheader = (GstBasicRTPHeader*) databed;
-  rtpheader->version = 2;
-  rtpheader->seq_num = g_htons(missing_seq);
-  rtpheader->ssrc    = g_htonl(fec_header_ssrc);
+//Decodes the missing packet of a Reed-Solomon block. With e packets missing
+//the first e repair packets give e syndromes, and the missing bitstring is
+//the corresponding row of the inverted e x e Cauchy submatrix applied to them.
+GstBuffer* _get_rs_repaired_rtpbuffer(FECDecoder *this, FECPacket* fec_packet, guint16 missing_seq) {
+  guint8 syndromes[GST_RTPFEC_MAX_REPAIR_NUM][1600];
+  guint8 bitstring[1600];
+  guint8 matrix[GST_RTPFEC_MAX_REPAIR_NUM * GST_RTPFEC_MAX_REPAIR_NUM];
+  gint32 missing[GST_RTPFEC_MAX_PROTECTION_NUM];
+  gint32 rows[GST_RTPFEC_MAX_REPAIR_NUM];
+  RcvPacket* received[GST_RTPFEC_MAX_PROTECTION_NUM];
+  gint32 missing_num = 0, rows_num = 0, length = 0, target = -1, i, j;
+  gint16 bitstring_length;
+  guint32 ssrc = 0;
+  RcvPacket* packet;
+  guint16 seq;
+
+  for(i = 0; i < fec_packet->protected_num; ++i){
+    seq = fec_packet->base_sn + i;
+    packet = *_rcv_slot(this, seq);
+    if(packet && packet->abs_seq == seq && seq != missing_seq){
+      received[i] = packet;
+      continue;
+    }
+    received[i] = NULL;
+    if(seq == missing_seq){
+      target = missing_num;
+    }
+    missing[missing_num++] = i;
+  }
+  if(target < 0 || fec_packet->repairs_num < missing_num){
+    return NULL;
+  }
 
-  memcpy(databed + 12, fecbitstring + 10, length);
+  for(j = 0; j < GST_RTPFEC_MAX_REPAIR_NUM && rows_num < missing_num; ++j){
+    GstRTPFECHeader* fec_header;
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    gint32 repair_length;
+    if(!fec_packet->repairs[j]){
+      continue;
+    }
+    gst_rtp_buffer_map(fec_packet->repairs[j], GST_MAP_READ, &rtp);
+    fec_header = (GstRTPFECHeader*) gst_rtp_buffer_get_payload(&rtp);
+    repair_length = MIN(gst_rtp_buffer_get_payload_len(&rtp) - sizeof(GstRTPFECHeader), 1600);
+    if(rows_num == 0){
+      length = repair_length;
+      ssrc = g_ntohl(fec_header->ssrc);
+    }
+    memset(syndromes[rows_num], 0, length);
+    memcpy(syndromes[rows_num], (guint8*)fec_header + sizeof(GstRTPFECHeader), MIN(repair_length, length));
+    gst_rtp_buffer_unmap(&rtp);
+    rows[rows_num++] = j;
+  }
 
-  result = gst_buffer_new_wrapped(databed, length + 12);
-  return result;
+  //removing the contribution of the received packets
+  for(i = 0; i < fec_packet->protected_num; ++i){
+    if(!received[i]){
+      continue;
+    }
+    rtpfecbuffer_setup_bitstring(received[i]->buffer, bitstring, &bitstring_length);
+    if(length < bitstring_length){
+      return NULL;
+    }
+    memset(bitstring + bitstring_length, 0, length - bitstring_length);
+    for(j = 0; j < rows_num; ++j){
+      gf256_muladd_region(syndromes[j], bitstring, gf256_cauchy_coef(rows[j], i), length);
+    }
+  }
 
+  for(j = 0; j < rows_num; ++j){
+    for(i = 0; i < missing_num; ++i){
+      matrix[j * missing_num + i] = gf256_cauchy_coef(rows[j], missing[i]);
+    }
+  }
+  if(!gf256_invert_matrix(matrix, missing_num)){
+    return NULL;
+  }
+  memset(bitstring, 0, length);
+  for(j = 0; j < rows_num; ++j){
+    gf256_muladd_region(bitstring, syndromes[j], matrix[target * missing_num + j], length);
+  }
+  return _make_rtpbuffer_from_bitstring(bitstring, length, missing_seq, ssrc);
 }
-
-
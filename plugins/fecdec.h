@@ -25,15 +25,26 @@ typedef struct _FECDecoderClass FECDecoderClass;
 #define FECDECODER_IS_SOURCE_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass),FECDECODER_TYPE))
 #define FECDECODER_CAST(src)        ((FECDecoder *)(src))
 
+//Number of sequence numbers the received and the fec packets are indexed by
+#define FECDECODER_WINDOW_SIZE 1024
+
+typedef struct _FECPacket FECPacket;
+
 struct _FECDecoder
 {
   GObject       object;
   GMutex        mutex;
   GstClockTime  made;
   GstClock*     sysclock;
-  GQueue*       rcv_packets;
   GQueue*       fec_recycle;
-  GQueue*       fec_packets;
+
+  RcvPacket*    rcv_packets[FECDECODER_WINDOW_SIZE];
+  FECPacket*    fec_packets[FECDECODER_WINDOW_SIZE];
+  gint32        fec_packets_num;
+  gboolean      initialized;
+  guint16       head_seq;
+  guint16       tail_seq;
+  GstClockTime  last_received;
 };
 
 
@@ -48,6 +59,8 @@ void fecdecoder_reset(FECDecoder *this);
 
 GstBuffer* fecdecoder_pop_rtp_packet(FECDecoder *this, guint16 seq_num);
 void fecdecoder_push_rcv_packet(FECDecoder *this, RcvPacket *packet);
+void fecdecoder_push_rcv_packets(FECDecoder *this, RcvPacket **packets, gint32 packets_num);
 void fecdecoder_push_fec_buffer(FECDecoder *this, GstBuffer *buffer);
+void fecdecoder_push_rs_fec_buffer(FECDecoder *this, GstBuffer *buffer);
 
 #endif /* FECDECODER_H_ */
@@ -28,6 +28,7 @@
 #include "fecenc.h"
 #include "gstmprtcpbuffer.h"
 #include "mprtputils.h"
+#include "lib_gf256.h"
 
 #define _now(this) gst_clock_get_time (this->sysclock)
 
@@ -51,6 +52,7 @@ typedef enum{
   FECENCODER_MESSAGE_TYPE_PAYLOAD_CHANGE         = 2,
   FECENCODER_REQUEST_MPRTP_EXT_HEADER_ID_CHANGE  = 3,
   FECENCODER_MESSAGE_TYPE_RTP_BUFFER             = 4,
+  FECENCODER_MESSAGE_TYPE_REED_SOLOMON_SETUP     = 5,
 }MessageTypes;
 
 typedef struct{
@@ -68,6 +70,12 @@ typedef struct{
   guint8       mprtp_ext_header_id;
 }MPRTPExtHeaderIDChangeMessage;
 
+typedef struct{
+  MessageTypes type;
+  guint8       payload_type;
+  guint8       repair_num;
+}ReedSolomonSetupMessage;
+
 typedef struct{
   MessageTypes type;
   guint8       subflow_id;
@@ -85,6 +93,7 @@ static void _fecenc_process(FECEncoder * this);
 static FECEncoderResponse* _fec_response_ctor(void);
 static void _fecencoder_add_rtpbuffer(FECEncoder *this, GstBuffer *buf);
 static GstBuffer* _fecencoder_get_fec_packet(FECEncoder *this, guint8 subflow_id, guint8 protected_num, gint32* packet_length);
+static gint32 _fecencoder_get_rs_packets(FECEncoder *this, guint8 subflow_id, guint8 protected_num, GstBuffer** result, gint32* packets_length);
 
 DEFINE_RECYCLE_TYPE(static, bitstring, BitString);
 
@@ -110,6 +119,7 @@ fecencoder_finalize (GObject * object)
   FECEncoder *this;
   this = FECENCODER(object);
   gst_task_stop(this->thread);
+  messenger_wake_up(this->messenger);
   gst_task_join (this->thread);
 
   g_object_unref(this->response_handler);
@@ -154,6 +164,7 @@ fecencoder_init (FECEncoder * this)
   this->pending_responses = g_queue_new();
   this->seqtracks  = g_malloc0(sizeof(SubflowSeqTrack) * 256);
   this->mprtp_ext_header_id = MPRTP_DEFAULT_EXTENSION_HEADER_ID;
+  this->rs_payload_type = FEC_RS_PAYLOAD_DEFAULT_ID;
 }
 
 
@@ -167,40 +178,42 @@ void fecencoder_add_rtpbuffer(FECEncoder *this, GstBuffer *buffer)
 {
   RTPBufferMessage* msg;
 
-  messenger_lock(this->messenger);
-
-  msg = messenger_retrieve_block_unlocked(this->messenger);
+  msg = messenger_retrieve_block(this->messenger);
   msg->type = FECENCODER_MESSAGE_TYPE_RTP_BUFFER;
   msg->buffer = buffer;
 
-  messenger_push_block_unlocked(this->messenger, msg);
-  messenger_unlock(this->messenger);
+  messenger_push_block(this->messenger, msg);
 }
 
 void fecencoder_request_fec(FECEncoder *this, guint8 subflow_id, guint8 protected_num)
 {
   FECRequestMessage* msg;
-  messenger_lock(this->messenger);
-
-  msg = messenger_retrieve_block_unlocked(this->messenger);
+  msg = messenger_retrieve_block(this->messenger);
   msg->type = FECENCODER_MESSAGE_TYPE_FEC_REQUEST;
   msg->subflow_id = subflow_id;
   msg->protected_num = protected_num;
-  messenger_push_block_unlocked(this->messenger, msg);
-  messenger_unlock(this->messenger);
+  messenger_push_block(this->messenger, msg);
 }
 
 
 void fecencoder_set_payload_type(FECEncoder* this, guint8 fec_payload_type)
 {
   PayloadChangeMessage* msg;
-  messenger_lock(this->messenger);
-
-  msg = messenger_retrieve_block_unlocked(this->messenger);
+  msg = messenger_retrieve_block(this->messenger);
   msg->type = FECENCODER_MESSAGE_TYPE_PAYLOAD_CHANGE;
   msg->payload_type = fec_payload_type;
-  messenger_push_block_unlocked(this->messenger, msg);
-  messenger_unlock(this->messenger);
+  messenger_push_block(this->messenger, msg);
+}
+
+//repair_num 0 switches back to the single parity XOR scheme
+void fecencoder_set_reed_solomon(FECEncoder* this, guint8 rs_payload_type, guint8 repair_num)
+{
+  ReedSolomonSetupMessage* msg;
+  msg = messenger_retrieve_block(this->messenger);
+  msg->type = FECENCODER_MESSAGE_TYPE_REED_SOLOMON_SETUP;
+  msg->payload_type = rs_payload_type;
+  msg->repair_num = MIN(repair_num, GST_RTPFEC_MAX_REPAIR_NUM);
+  messenger_push_block(this->messenger, msg);
 }
 
 void fecencoder_ref_response(FECEncoderResponse* response)
@@ -231,20 +244,19 @@ void _fecencoder_add_rtpbuffer(FECEncoder *this, GstBuffer *buf)
 static BitString* _assemble_fec_bitstring(FECEncoder *this, guint8 subflow_id, guint8 protected_num, gint* n_mask) {
   BitString* result = recycle_retrieve_and_shape(this->bitstring_recycle, NULL);
   BitString *actual = NULL;
+  guint8* sources[GST_RTPFEC_MAX_PROTECTION_NUM];
   GList* it;
-  gboolean init = FALSE;
   *n_mask = 0;
-  for (it = this->bitstrings->tail; it && *n_mask < protected_num; it = it->prev) {
-    ++(*n_mask);
+  //bitstrings are zero padded, so the parity of the longest one covers all of them
+  for (it = this->bitstrings->tail; it && *n_mask < protected_num && *n_mask < GST_RTPFEC_MAX_PROTECTION_NUM; it = it->prev) {
     actual = it->data;
+    sources[(*n_mask)++] = actual->bytes;
     result->length = MAX(result->length, actual->length);
-    do_bitxor(result->bytes, actual->bytes, result->length);
-    if(!init){
-      init = TRUE;
-      result->seq_num = actual->seq_num;
-      result->ssrc    = actual->ssrc;
-    }
+    //the base is the oldest protected packet
+    result->seq_num = actual->seq_num;
+    result->ssrc    = actual->ssrc;
   }
+  do_bitxor_n(result->bytes, sources, *n_mask, result->length);
   return result;
 }
 
@@ -307,24 +319,104 @@ done:
   return result;
 }
 
+//Collects the last protected_num bitstrings, the oldest is the first
+static gint32 _collect_rs_sources(FECEncoder *this, guint8 protected_num, BitString** result, gint16* length) {
+  gint32 i, count = 0;
+  GList* it;
+  *length = 0;
+  for (it = this->bitstrings->tail; it && count < protected_num && count < GST_RTPFEC_MAX_PROTECTION_NUM; it = it->prev) {
+    ++count;
+  }
+  for (i = count - 1, it = this->bitstrings->tail; 0 <= i; --i, it = it->prev) {
+    result[i] = it->data;
+    *length = MAX(*length, result[i]->length);
+  }
+  return count;
+}
+
+//Systematic Cauchy Reed-Solomon code: the j-th repair packet is
+//sum(coef(j, i) * bitstring_i) over GF(256), so any e losses in the
+//block can be recovered from any e repair packets.
+//The repair packets carry the whole coded bitstring after the fec header,
+//the base is in sn_base, the block size in N_MASK and the repair index in M_MASK.
+gint32
+_fecencoder_get_rs_packets(FECEncoder *this, guint8 subflow_id, guint8 protected_num, GstBuffer** result, gint32* packets_length)
+{
+  BitString* sources[GST_RTPFEC_MAX_PROTECTION_NUM];
+  BitString* repair;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstRTPFECHeader *fecheader;
+  guint8* payload;
+  gint32 sources_num, i, j;
+  gint16 length;
+
+  *packets_length = 0;
+  sources_num = _collect_rs_sources(this, MAX(protected_num, 1), sources, &length);
+  if(sources_num < 1){
+    return 0;
+  }
+
+  repair = recycle_retrieve_and_shape(this->bitstring_recycle, NULL);
+  for(j = 0; j < this->repair_num; ++j){
+    memset(repair->bytes, 0, length);
+    for(i = 0; i < sources_num; ++i){
+      gf256_muladd_region(repair->bytes, sources[i]->bytes, gf256_cauchy_coef(j, i), length);
+    }
+
+    result[j] = gst_rtp_buffer_new_allocate (sizeof(GstRTPFECHeader) + length, 0, 0);
+    gst_rtp_buffer_map(result[j], GST_MAP_READWRITE, &rtp);
+    gst_rtp_buffer_set_payload_type(&rtp, this->rs_payload_type);
+    gst_rtp_buffer_set_seq(&rtp, ++this->seq_num);
+    gst_rtp_buffer_set_ssrc(&rtp, sources[0]->ssrc);
+
+    if(0 < subflow_id)
+    {
+      guint16 subflow_seq = subflowseqtracker_increase(this->seqtracks + subflow_id);
+      gst_rtp_buffer_set_mprtp_extension(&rtp, this->mprtp_ext_header_id, subflow_id, subflow_seq);
+    }
+
+    payload = gst_rtp_buffer_get_payload(&rtp);
+    fecheader = (GstRTPFECHeader*) payload;
+    memset(fecheader, 0, sizeof(GstRTPFECHeader));
+    fecheader->F               = 1;
+    fecheader->length_recovery = g_htons(length);
+    fecheader->sn_base         = g_htons(sources[0]->seq_num);
+    fecheader->ssrc            = g_htonl(sources[0]->ssrc);
+    fecheader->SSRC_Count      = 1;
+    fecheader->N_MASK          = sources_num;
+    fecheader->M_MASK          = j;
+    memcpy(payload + sizeof(GstRTPFECHeader), repair->bytes, length);
+    gst_rtp_buffer_unmap(&rtp);
+
+    *packets_length += sizeof(GstRTPFECHeader) + length;
+  }
+  recycle_add(this->bitstring_recycle, repair);
+  return this->repair_num;
+}
 
 BitString* _make_bitstring(FECEncoder* this, GstBuffer* buf)
 {
   BitString *result;
-  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint32 ssrc;
   result = recycle_retrieve_and_shape(this->bitstring_recycle, NULL);
   rtpfecbuffer_setup_bitstring(buf, result->bytes, &result->length);
-  gst_rtp_buffer_map(buf, GST_MAP_READ, &rtp);
-  result->seq_num = gst_rtp_buffer_get_seq(&rtp);
-  result->ssrc    = gst_rtp_buffer_get_ssrc(&rtp);
-  gst_rtp_buffer_unmap(&rtp);
+  //the bitstring starts with the first 8 bytes of the RTP header
+  result->seq_num = GST_READ_UINT16_BE(result->bytes + 2);
+  gst_buffer_extract(buf, 8, &ssrc, 4);
+  result->ssrc    = g_ntohl(ssrc);
   return result;
 }
 
 static void _send_fec_response(FECEncoder* this, FECEncoderResponse *response)
 {
-  response->fecbuffer  = _fecencoder_get_fec_packet(this, response->subflow_id, response->protected_num, &response->payload_size);
-  if(!response->fecbuffer){
+  if(0 < this->repair_num){
+    response->fecbuffers_num = _fecencoder_get_rs_packets(this, response->subflow_id, response->protected_num,
+        response->fecbuffers, &response->payload_size);
+  }else{
+    response->fecbuffers[0]  = _fecencoder_get_fec_packet(this, response->subflow_id, response->protected_num, &response->payload_size);
+    response->fecbuffers_num = response->fecbuffers[0] ? 1 : 0;
+  }
+  if(response->fecbuffers_num < 1){
     g_queue_push_tail(this->pending_responses, response);
   }else{
     mediator_set_response(this->response_handler, response);
@@ -356,6 +448,13 @@ static void _process_message(FECEncoder* this, Message* message)
       this->mprtp_ext_header_id = fec_payload_message->mprtp_ext_header_id;
     }
     break;
+    case FECENCODER_MESSAGE_TYPE_REED_SOLOMON_SETUP:
+    {
+      ReedSolomonSetupMessage* rs_setup_message = (ReedSolomonSetupMessage*)message;
+      this->rs_payload_type = rs_setup_message->payload_type;
+      this->repair_num      = rs_setup_message->repair_num;
+    }
+    break;
     case FECENCODER_MESSAGE_TYPE_FEC_REQUEST:
     {
       FECRequestMessage* fec_request = (FECRequestMessage*)message;
@@ -375,7 +474,8 @@ static void _fecenc_process(FECEncoder* this)
 {
   Message* message;
 
-  message = (Message*) messenger_pop_block_with_timeout(this->messenger, 10000);
+  //sleeps until a message arrives instead of polling, finalize wakes it up to stop
+  message = (Message*) messenger_pop_block_or_wake_up(this->messenger);
 
   if(!message){
     goto done;
@@ -27,7 +27,8 @@ typedef struct _FECEncoderClass FECEncoderClass;
 
 typedef struct{
   guint              ref;
-  GstBuffer*         fecbuffer;
+  GstBuffer*         fecbuffers[GST_RTPFEC_MAX_REPAIR_NUM];
+  gint32             fecbuffers_num;
   gint32             payload_size;
   guint8             subflow_id;
   guint8             protected_num;
@@ -42,6 +43,8 @@ struct _FECEncoder
   gint32                     max_protection_num;
   guint16                    seq_num;
   guint8                     payload_type;
+  guint8                     rs_payload_type;
+  guint8                     repair_num;
   guint8                     mprtp_ext_header_id;
 
   GQueue*                    bitstrings;
@@ -71,6 +74,7 @@ void fecencoder_reset(FECEncoder *this);
 
 void fecencoder_add_rtpbuffer(FECEncoder *this, GstBuffer* buffer);
 void fecencoder_set_payload_type(FECEncoder* this, guint8 fec_payload_type);
+void fecencoder_set_reed_solomon(FECEncoder* this, guint8 rs_payload_type, guint8 repair_num);
 void fecencoder_request_fec(FECEncoder* this, guint8 subflow_id, guint8 protected_num);
 
 void fecencoder_ref_response(FECEncoderResponse* response);
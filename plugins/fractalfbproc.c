@@ -61,8 +61,10 @@ _cmp_ts (guint32 x, guint32 y)
 #include <math.h>                           /* math functions */
 
 
+#ifdef MPRTP_PACKET_ANALYSIS
 static gboolean csv_header_printed = FALSE;
-static void _print_packet_stat(FRACTaLFBProcessor *this, SndPacket* packet) {
+static void _print_packet_stat(gpointer udata, SndPacket* packet) {
+  FRACTaLFBProcessor *this = udata;
   gchar result[1024];
   if (packet->subflow_id != this->subflow->id) {
     return;
@@ -109,24 +111,25 @@ static void _print_packet_stat(FRACTaLFBProcessor *this, SndPacket* packet) {
           this->subflow->id,                         // 1
           GST_TIME_AS_MSECONDS(_now(this) - this->made) / 1000., // 2
           this->min_dts,                             // 3
-          packet->qts,                               // 4
+          packet->analysis.qts,                      // 4
           packet->subflow_seq,                       // 5
-          packet->arrival_status,                    // 6
-          packet->subflow_skew,                      // 7
+          packet->analysis.arrival_status,           // 6
+          packet->analysis.subflow_skew,             // 7
           packet->ref,                               // 8
           this->cc_begin_seq,                        // 9
           this->cc_end_seq,                          // 10
           _stat(this)->sender_bitrate / 1000,        // 11
           _stat(this)->fraction_lost,                // 12
-          packet->qsample                            // 13
+          packet->analysis.qsample                   // 13
           );
 
   g_print("Packet:%s\n",result);
-  if (packet->arrival_status == 0) {
+  if (packet->analysis.arrival_status == 0) {
     g_print("Unknown: %hu, %hu\n", packet->subflow_seq, packet->subflow_id);
   }
 
 }
+#endif
 
 
 
@@ -141,7 +144,6 @@ fractalfbprocessor_class_init (FRACTaLFBProcessorClass * klass)
 
   GST_DEBUG_CATEGORY_INIT (fractalfbprocessor_debug_category, "fractalfbprocessor", 0,
       "FRACTaLFBProcessor");
-
 }
 
 void
@@ -161,7 +163,7 @@ fractalfbprocessor_init (FRACTaLFBProcessor * this)
   this->sysclock         = gst_system_clock_obtain();
 }
 
-static void _on_packet_sent(FRACTaLFBProcessor* this, SndPacket* packet);
+static void _on_packet_sent(gpointer udata, SndPacket* packet);
 static void _refresh_windows_thresholds(FRACTaLFBProcessor *this);
 
 
@@ -194,8 +196,10 @@ FRACTaLFBProcessor *make_fractalfbprocessor(SndTracker* sndtracker, SndSubflow*
 //  this->qdelay_bucket = make_bucket(QDELAY_BUCKET_LIST_LENGTH, 10 * GST_MSECOND);
 //  this->qdelay_devs = make_bucket(2, 0);
 
-  sndtracker_add_on_packet_sent(this->sndtracker, (ListenerFunc)_on_packet_sent, this);
-  DISABLE_LINE sndtracker_add_on_packet_obsolated(this->sndtracker, (ListenerFunc)_print_packet_stat, this);
+  sndtracker_add_on_packet_sent(this->sndtracker, _on_packet_sent, this);
+#ifdef MPRTP_PACKET_ANALYSIS
+  DISABLE_LINE sndtracker_add_on_packet_obsolated(this->sndtracker, _print_packet_stat, this);
+#endif
 
   fractalfbprocessor_set_evaluation_window_margins(this, 0.25 * GST_SECOND, 0.5 * GST_SECOND);
 
@@ -271,6 +275,7 @@ void _process_cc_rle_discvector(FRACTaLFBProcessor *this, GstMPRTCPXRReportSumma
   guint32 act_ato;
   guint32 report_timestamp;
   gint number_of_qd_packets = 0;
+  gint32 vector_length, acked_num = 0, found_num = 0;
 
   this->cc_begin_seq = act_seq = xr->CongestionControlFeedback.begin_seq;
   this->cc_end_seq = end_seq = xr->CongestionControlFeedback.end_seq;
@@ -291,38 +296,48 @@ void _process_cc_rle_discvector(FRACTaLFBProcessor *this, GstMPRTCPXRReportSumma
 
 //  g_print("Received chunks: %d (%d->%d): ", this->subflow->id, act_seq, end_seq);
 //  for(i=0; act_seq != end_seq; ++act_seq, ++i) {
-  for (i = 0; i < xr->CongestionControlFeedback.vector_length; ++i, ++act_seq) {
-    packet = sndtracker_retrieve_sent_packet(this->sndtracker, this->subflow->id, act_seq);
+  vector_length = xr->CongestionControlFeedback.vector_length;
+  sndtracker_retrieve_sent_packets(this->sndtracker, this->subflow->id, act_seq, vector_length, this->cc_packets);
+  //acknowledged packets are collected in place at the beginning of cc_packets,
+  //and handed to the tracker together after the vector is processed
+  for (i = 0; i < vector_length; ++i, ++act_seq) {
+    packet = this->cc_packets[i];
     if(!packet){
       GST_WARNING_OBJECT(this, "Packet %hu has not in subflow tracked sequences. "
           "Either too late acknowledged or never sent", act_seq);
       continue;
     }
-//    g_print("(%d, %d) ", (guint16)(packet->subflow_seq), xr->CongestionControlFeedback.vector[i].lost);
+//    g_print("(%d, %d) ", (guint16)(packet->subflow_seq), report_summary_bit_get(xr->CongestionControlFeedback.lost, i));
 
-    act_ato = xr->CongestionControlFeedback.vector[i].ato;
+    act_ato = report_summary_get_cc_ato(xr, i);
 
     if(packet->acknowledged) {
-      if(packet->lost && xr->CongestionControlFeedback.vector[i].lost) {
+      if(packet->lost && report_summary_bit_get(xr->CongestionControlFeedback.lost, i)) {
         packet->lost = FALSE;
         packet->rcvd_ts = _subtract_ts(report_timestamp, act_ato);
-        sndtracker_packet_found(this->sndtracker, packet);
-        packet->arrival_status |= 4;
+        this->found_packets[found_num++] = packet;
+#ifdef MPRTP_PACKET_ANALYSIS
+        packet->analysis.arrival_status |= 4;
+#endif
       }
       continue;
     }
 
-    if (!xr->CongestionControlFeedback.vector[i].lost) {
+    if (!report_summary_bit_get(xr->CongestionControlFeedback.lost, i)) {
       packet->acknowledged = TRUE;
       packet->lost = TRUE;
       packet->skew = 0;
-      sndtracker_packet_acked(this->sndtracker, packet);
-      packet->arrival_status |= 1;
+      this->cc_packets[acked_num++] = packet;
+#ifdef MPRTP_PACKET_ANALYSIS
+      packet->analysis.arrival_status |= 1;
+#endif
       ++_stat(this)->lost_or_discarded;
       continue;
     }
     ++number_of_qd_packets;
-    packet->arrival_status |= 2;
+#ifdef MPRTP_PACKET_ANALYSIS
+    packet->analysis.arrival_status |= 2;
+#endif
 
     packet->rcvd_ts = _subtract_ts(report_timestamp, act_ato);
     {
@@ -366,12 +381,14 @@ void _process_cc_rle_discvector(FRACTaLFBProcessor *this, GstMPRTCPXRReportSumma
       _stat(this)->qd_max = MAX(_stat(this)->qd_max, qts);
       _stat(this)->qd_min = MIN(_stat(this)->qd_min, qts);
 
-      packet->dts = dts;
-      packet->qts = qts;
+#ifdef MPRTP_PACKET_ANALYSIS
+      packet->analysis.dts = dts;
+      packet->analysis.qts = qts;
 
       if (0 < this->last_dts) {
-        packet->subflow_skew = dts < this->last_dts ? this->last_dts - dts : dts - this->last_dts;
+        packet->analysis.subflow_skew = dts < this->last_dts ? this->last_dts - dts : dts - this->last_dts;
       }
+#endif
       this->last_dts = dts;
 
       if (!reference_dts_init || dts < reference_dts) {
@@ -384,8 +401,10 @@ void _process_cc_rle_discvector(FRACTaLFBProcessor *this, GstMPRTCPXRReportSumma
 
     packet->acknowledged = TRUE;
     packet->lost = FALSE;
-    sndtracker_packet_acked(this->sndtracker, packet);
+    this->cc_packets[acked_num++] = packet;
   }
+  sndtracker_packets_found(this->sndtracker, this->subflow->id, this->found_packets, found_num);
+  sndtracker_packets_acked(this->sndtracker, this->subflow->id, this->cc_packets, acked_num);
   _stat(this)->arrived_packets = number_of_qd_packets;
 
   if (reference_sent_ts) {
@@ -469,7 +488,8 @@ void _process_stat(FRACTaLFBProcessor *this)
 
 
 
-static void _on_packet_sent(FRACTaLFBProcessor* this, SndPacket* packet) {
+static void _on_packet_sent(gpointer udata, SndPacket* packet) {
+  FRACTaLFBProcessor *this = udata;
   if(packet->subflow_id != this->subflow->id){
     return;
   }
@@ -483,5 +503,3 @@ static void _refresh_windows_thresholds(FRACTaLFBProcessor *this) {
   qdelay_stability_calcer_set_time_threshold(this->qdelay_stability_calcer, 2 * ewi_in_ns);
   fl_stability_calcer_set_time_threshold(this->fl_stability_calcer, ewi_in_ns);
 }
-
-
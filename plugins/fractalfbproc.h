@@ -122,6 +122,9 @@ struct _FRACTaLFBProcessor
   gdouble                  fb_interval_avg;
 
   guint16 cc_begin_seq, cc_end_seq;
+  //sent packets of the feedback vector being processed
+  SndPacket*               cc_packets[REPORT_SUMMARY_MAX_VECTOR_LENGTH];
+  SndPacket*               found_packets[REPORT_SUMMARY_MAX_VECTOR_LENGTH];
 
 };
 
@@ -38,26 +38,22 @@ GST_DEBUG_CATEGORY_STATIC (fractalfbproducer_debug_category);
 G_DEFINE_TYPE (FRACTaLFBProducer, fractalfbproducer, G_TYPE_OBJECT);
 
 #define RLE_LENGTH (FRACTALPRODUCER_CHUNKS_MAX_LENGTH-2)
+//Packets received earlier than this are not reported again
+#define RLE_WINDOW_TIME (500 * GST_MSECOND)
 
-typedef struct{
-  FRACTaLFBProducer* this;
-  gboolean initialized;
-}IteratorMinMaxHelper;
-
-typedef struct {
-  guint16 begin_seq;
-  gboolean found;
-}RLEFilterHelper;
+#define _slot(seq) ((seq) & (FRACTALPRODUCER_RING_LENGTH - 1))
+#define _is_arrived(this, seq) (((this)->arrived[_slot(seq) >> 6] >> (_slot(seq) & 63)) & 1)
+#define _set_arrived(this, seq) ((this)->arrived[_slot(seq) >> 6] |= G_GUINT64_CONSTANT(1) << (_slot(seq) & 63))
+#define _clear_arrived(this, seq) ((this)->arrived[_slot(seq) >> 6] &= ~(G_GUINT64_CONSTANT(1) << (_slot(seq) & 63)))
 
 static void fractalfbproducer_finalize (GObject * object);
 static gboolean _do_fb(FRACTaLFBProducer* data);;
-static gboolean _packet_subflow_filter(FRACTaLFBProducer *this, RcvPacket *packet);
-static void _on_received_packet(FRACTaLFBProducer *this, RcvPacket *packet);
+static gboolean _packet_subflow_filter(gpointer udata, RcvPacket *packet);
+static void _on_received_packet(gpointer udata, RcvPacket *packet);
 static void _setup_xr_cc_fb_rle(FRACTaLFBProducer * this,  ReportProducer* reportproducer);
 static void _on_fb_update(FRACTaLFBProducer *this,  ReportProducer* reportproducer);
-static void _rle_minmax_iterator(RcvPacket* packet, IteratorMinMaxHelper* helper);
-static void _refresh_begin_end_seq(FRACTaLFBProducer * this);
-static gboolean _rle_tail_filter(RLEFilterHelper *helper, RcvPacket *packet);
+static void _clear_arrivals(FRACTaLFBProducer *this, guint16 from_seq, guint16 to_seq);
+static void _expire_arrivals(FRACTaLFBProducer *this, GstClockTime threshold);
 
 
 static gint
@@ -109,7 +105,7 @@ fractalfbproducer_finalize (GObject * object)
   FRACTaLFBProducer *this;
   this = FRACTALFBPRODUCER(object);
 
-  rcvtracker_rem_on_received_packet_listener(this->tracker,  (ListenerFunc)_on_received_packet);
+  rcvtracker_rem_on_received_packet_listener(this->tracker,  _on_received_packet);
   rcvsubflow_rem_on_rtcp_fb_cb(this->subflow, (ListenerFunc) _on_fb_update);
 
   g_object_unref(this->sysclock);
@@ -124,36 +120,20 @@ fractalfbproducer_init (FRACTaLFBProducer * this)
   this->sysclock = gst_system_clock_obtain();
 }
 
-static void _packet_unrefer(FRACTaLFBProducer* this, RcvPacket* packet) {
-  rcvpacket_unref(packet);
-}
-
-static void _packet_refer(FRACTaLFBProducer* this, RcvPacket* packet) {
-  rcvpacket_ref(packet);
-}
-
-static void _packet_debug(RcvPacket* packet, gchar* string) {
-  sprintf(string, "(%p, %hu, %hu, %d)", packet, packet->subflow_id, packet->subflow_seq, packet->ref);
-}
 FRACTaLFBProducer *make_fractalfbproducer(RcvSubflow* subflow, RcvTracker *tracker)
 {
   FRACTaLFBProducer *this;
   this = g_object_new (FRACTALFBPRODUCER_TYPE, NULL);
   this->subflow         = subflow;
   this->tracker         = g_object_ref(tracker);
-  this->rle_sw          = make_slidingwindow(RLE_LENGTH, .5 * GST_SECOND);
   this->ts_generator    = g_object_ref(rcvtracker_get_cc_ts_generator(tracker));
 
-  slidingwindow_add_postprocessor(this->rle_sw, (ListenerFunc)_packet_unrefer, this);
-  slidingwindow_add_preprocessor(this->rle_sw, (ListenerFunc)_packet_refer, this);
-
   rcvtracker_add_on_received_packet_listener_with_filter(this->tracker,
-      (ListenerFunc) _on_received_packet,
-      (ListenerFilterFunc) _packet_subflow_filter,
+      _on_received_packet,
+      _packet_subflow_filter,
       this);
 
   rcvsubflow_add_on_rtcp_fb_cb(subflow, (ListenerFunc) _on_fb_update, this);
-  DISABLE_LINE slidingwindow_setup_debug(this->rle_sw, (SlidingWindowItemSprintf)_packet_debug, g_print);
   return this;
 }
 
@@ -162,40 +142,74 @@ void fractalfbproducer_reset(FRACTaLFBProducer *this)
   this->initialized = FALSE;
 }
 
-gboolean _packet_subflow_filter(FRACTaLFBProducer *this, RcvPacket *packet)
+gboolean _packet_subflow_filter(gpointer udata, RcvPacket *packet)
 {
+  FRACTaLFBProducer *this = udata;
   return packet->subflow_id == this->subflow->id;
 }
 
-void _on_received_packet(FRACTaLFBProducer *this, RcvPacket *packet)
+void _on_received_packet(gpointer udata, RcvPacket *packet)
 {
-//  g_print("Received %hu-%hu packet subflow %d on fractalprod (%p) %d, subflow_seq: %hu\n",
-//      this->begin_seq, this->end_seq, packet->subflow_id, this->rle_sw, this->subflow->id, packet->subflow_seq);
+  FRACTaLFBProducer *this = udata;
+  guint16 seq = packet->subflow_seq;
+//  g_print("Received %hu-%hu packet subflow %d on fractalprod %d, subflow_seq: %hu\n",
+//      this->begin_seq, this->end_seq, packet->subflow_id, this->subflow->id, packet->subflow_seq);
 
   if(!this->initialized){
     this->initialized = TRUE;
-    this->begin_seq = this->end_seq = packet->subflow_seq;
-    slidingwindow_add_data(this->rle_sw, packet);
-    ++this->rcved_packets;
-    goto done;
-  }
-
-  if (_cmp_seq(packet->subflow_seq, this->begin_seq) < 0 && RLE_LENGTH < _delta_seq(packet->subflow_seq, this->end_seq)) {
-    // do not add the queue and report discarded
-    goto done;
+    memset(this->arrived, 0, sizeof(this->arrived));
+    this->begin_seq = this->end_seq = seq;
+  } else if (_cmp_seq(seq, this->begin_seq) < 0) {
+    if (RLE_LENGTH < _delta_seq(seq, this->end_seq)) {
+      // do not add the queue and report discarded
+      goto done;
+    }
+    _clear_arrivals(this, seq, this->begin_seq);
+    this->begin_seq = seq;
+  } else if (_cmp_seq(this->end_seq, seq) < 0) {
+    _clear_arrivals(this, this->end_seq + 1, seq + 1);
+    this->end_seq = seq;
+    if (RLE_LENGTH < _delta_seq(this->begin_seq, this->end_seq)) {
+      this->begin_seq = this->end_seq - RLE_LENGTH;
+    }
   }
-  slidingwindow_add_data(this->rle_sw, packet);
+  _set_arrived(this, seq);
+  this->arrival_cc_ts[_slot(seq)] = packet->cc_ts;
+  this->arrival_time[_slot(seq)] = packet->received;
   ++this->rcved_packets;
 
 done:
   return;
 }
 
+//Clears the slots of [from_seq, to_seq), they are reused for new sequence numbers
+void _clear_arrivals(FRACTaLFBProducer *this, guint16 from_seq, guint16 to_seq)
+{
+  if (FRACTALPRODUCER_RING_LENGTH <= _delta_seq(from_seq, to_seq)) {
+    memset(this->arrived, 0, sizeof(this->arrived));
+    return;
+  }
+  for (; from_seq != to_seq; ++from_seq) {
+    _clear_arrived(this, from_seq);
+  }
+}
+
+//Moves the begin of the reported range to the first packet received after the threshold,
+//the last received packet is always kept
+void _expire_arrivals(FRACTaLFBProducer *this, GstClockTime threshold)
+{
+  for (; this->begin_seq != this->end_seq; ++this->begin_seq) {
+    if (_is_arrived(this, this->begin_seq) && threshold <= this->arrival_time[_slot(this->begin_seq)]) {
+      break;
+    }
+    _clear_arrived(this, this->begin_seq);
+  }
+}
+
 
 static gboolean _do_fb(FRACTaLFBProducer *this)
 {
   GstClockTime now = _now(this);
-  slidingwindow_refresh(this->rle_sw);
 
   if(now - 20 * GST_MSECOND < this->last_fb){
     return FALSE;
@@ -223,58 +237,33 @@ done:
   return;
 }
 
-typedef struct{
-  FRACTaLFBProducer* this;
-  guint32 report_timestamp;
-}IteratorChunkHelper;
-
-static void _rle_chunk_iterator(RcvPacket* packet, IteratorChunkHelper* helper) {
-  FRACTaLFBProducer* this = helper->this;
-  gint index;
-  GstRTCPXRChunk* chunk;
-//  g_print("Iterate on %hu->%hu fractalprod (%p)%d, subflow_seq: (%p)%hu\n",
-//      this->begin_seq, this->end_seq, this, this->subflow->id, packet, packet->subflow_seq);
-  if (this->begin_seq <= packet->subflow_seq) {
-    index = packet->subflow_seq - this->begin_seq;
-  } else {
-//    g_print("begin seq: %hu, subflow_seq: %hu\n", this->begin_seq, packet->subflow_seq);
-    index = 65536 - this->begin_seq + packet->subflow_seq;
-  }
-  if (64 < index) {
-//      g_print("Problem on %hu->%hu fractalprod (%p)%d, subflow_seq: (%p)%hu\n",
-//          this->begin_seq, this->end_seq, this, this->subflow->id, packet, packet->subflow_seq);
-//    g_print("There is a problem with the index calculatioin at FRACTaLProducer %d\n", index);
-    return;
-  }
-  chunk = this->chunks + index;
-  chunk->CCFeedback.lost = 1;
-  chunk->CCFeedback.ecn = 1;
-  chunk->CCFeedback.ato = _delta_ts(packet->cc_ts, helper->report_timestamp);
-}
-
-
 void _setup_xr_cc_fb_rle(FRACTaLFBProducer * this,  ReportProducer* reportproducer) {
   guint32 report_count = 1;
+  guint32 report_timestamp;
+  GstClockTime now = _now(this);
+  GstRTCPXRChunk* chunk;
   gint chunks_num;
-  IteratorChunkHelper chunk_helper;
+  gint index;
+  guint16 seq;
 
   if (!this->initialized) {
     goto done;
   }
 
-  _refresh_begin_end_seq(this);
-
-  while(RLE_LENGTH < _delta_seq(this->begin_seq, this->end_seq)) {
-    RLEFilterHelper helper = {this->begin_seq, FALSE};
-    slidingwindow_filter_out_from_tail(this->rle_sw, (SlidingWindowPredicator) _rle_tail_filter, &helper);
-    _refresh_begin_end_seq(this);
-  }
+  _expire_arrivals(this, now < RLE_WINDOW_TIME ? 0 : now - RLE_WINDOW_TIME);
 
-  memset(this->chunks, 0, sizeof(guint16) * FRACTALPRODUCER_CHUNKS_MAX_LENGTH);
-  chunk_helper.this = this;
-  chunk_helper.report_timestamp = timestamp_generator_get_ts(this->ts_generator);
-  slidingwindow_iterate(this->rle_sw, (SlidingWindowIterator) _rle_chunk_iterator, &chunk_helper);
+  report_timestamp = timestamp_generator_get_ts(this->ts_generator);
   chunks_num = _delta_seq(this->begin_seq, this->end_seq) + 1;
+  for (index = 0, seq = this->begin_seq; index < chunks_num; ++index, ++seq) {
+    chunk = this->chunks + index;
+    memset(chunk, 0, sizeof(GstRTCPXRChunk));
+    if (!_is_arrived(this, seq)) {
+      continue;
+    }
+    chunk->CCFeedback.lost = 1;
+    chunk->CCFeedback.ecn = 1;
+    chunk->CCFeedback.ato = _delta_ts(this->arrival_cc_ts[_slot(seq)], report_timestamp);
+  }
 
 //  g_print("Sent chunks: %d (%d->%d): ", this->subflow->id, this->begin_seq, this->end_seq);
 //  for (int i = 0; i < chunks_num; ++i) {
@@ -285,7 +274,7 @@ void _setup_xr_cc_fb_rle(FRACTaLFBProducer * this,  ReportProducer* reportproduc
 
   report_producer_add_xr_cc_rle_fb(reportproducer,
       report_count,
-      chunk_helper.report_timestamp,
+      report_timestamp,
       this->begin_seq,
       this->end_seq,
       this->chunks,
@@ -296,43 +285,7 @@ done:
 }
 
 
-void _rle_minmax_iterator(RcvPacket* packet, IteratorMinMaxHelper* helper) {
-  FRACTaLFBProducer* this = helper->this;
-  if (!helper->initialized) {
-    this->begin_seq = this->end_seq = packet->subflow_seq;
-    helper->initialized = TRUE;
-    return;
-  }
-  if (_cmp_seq(this->end_seq, packet->subflow_seq) < 0) {
-    this->end_seq = packet->subflow_seq;
-  }
-  if (_cmp_seq(packet->subflow_seq, this->begin_seq) < 0) {
-    this->begin_seq = packet->subflow_seq;
-  }
-
-//  g_print("(%hu, %hu) ", packet->subflow_seq, packet->subflow_id);
-
-  if (packet->subflow_id != this->subflow->id) {
-      g_print("(%p, %hu, %hu, %d) ", packet, packet->subflow_seq, packet->subflow_id, packet->ref);
-  }
-}
-
-void _refresh_begin_end_seq(FRACTaLFBProducer * this) {
-  IteratorMinMaxHelper minmax_helper;
-  minmax_helper.this = this;
-  minmax_helper.initialized = FALSE;
-  slidingwindow_iterate(this->rle_sw, (SlidingWindowIterator) _rle_minmax_iterator, &minmax_helper);
-}
-
-gboolean _rle_tail_filter(RLEFilterHelper *helper, RcvPacket *packet) {
-  if (helper->found){
-    return FALSE;
-  }
-  helper->found = helper->begin_seq == packet->subflow_seq;
-  return TRUE;
-}
-
-
+#undef RLE_WINDOW_TIME
 #undef RLE_LENGTH
 
 
@@ -26,6 +26,8 @@ typedef struct _FRACTaLFBProducerClass FRACTaLFBProducerClass;
 typedef struct _CorrBlock CorrBlock;
 
 #define FRACTALPRODUCER_CHUNKS_MAX_LENGTH 64
+//Slots of the arrival ring, the reported range always fits into it
+#define FRACTALPRODUCER_RING_LENGTH 64
 
 struct _FRACTaLFBProducer
 {
@@ -41,7 +43,11 @@ struct _FRACTaLFBProducer
   guint16                  begin_seq;
   guint16                  end_seq;
 
-  SlidingWindow*           rle_sw;
+  //Arrivals of the last subflow sequence numbers indexed by seq % FRACTALPRODUCER_RING_LENGTH,
+  //so a received packet is recorded and a report is made without walking any list
+  guint64                  arrived[FRACTALPRODUCER_RING_LENGTH / 64];
+  guint32                  arrival_cc_ts[FRACTALPRODUCER_RING_LENGTH];
+  GstClockTime             arrival_time[FRACTALPRODUCER_RING_LENGTH];
   TimestampGenerator*      ts_generator;
 
   GstClockTime             last_fb;
@@ -192,12 +192,12 @@ void fractalsubctrler_finalize (GObject * object);
 
  static gboolean
  _rtp_sending_filter(
-     FRACTaLSubController* this,
+     gpointer udata,
      SndPacket *packet);
 
  static void
  _on_rtp_sending(
-     FRACTaLSubController* this,
+     gpointer udata,
      SndPacket *packet);
 
  static gdouble
@@ -351,7 +351,7 @@ fractalsubctrler_finalize (GObject * object)
   FRACTaLSubController *this;
   this = FRACTALSUBCTRLER(object);
 
-  sndtracker_rem_on_packet_sent(this->sndtracker, (ListenerFunc) _on_rtp_sending);
+  sndtracker_rem_on_packet_sent(this->sndtracker, _on_rtp_sending);
 
   g_free(this->priv);
 
@@ -415,8 +415,8 @@ FRACTaLSubController *make_fractalsubctrler(SndTracker *sndtracker, SndSubflow *
   _switch_stage_to(this, STAGE_KEEP, FALSE);
 
   sndtracker_add_on_packet_sent_with_filter(this->sndtracker,
-      (ListenerFunc) _on_rtp_sending,
-      (ListenerFilterFunc) _rtp_sending_filter,
+      _on_rtp_sending,
+      _rtp_sending_filter,
       this);
 
   fractalfbprocessor_set_evaluation_window_margins(this->fbprocessor,
@@ -448,13 +448,15 @@ void fractalsubctrler_disable(FRACTaLSubController *this)
   this->enabled = FALSE;
 }
 
-gboolean _rtp_sending_filter(FRACTaLSubController* this, SndPacket *packet)
+gboolean _rtp_sending_filter(gpointer udata, SndPacket *packet)
 {
+  FRACTaLSubController* this = udata;
   return this->subflow->id == packet->subflow_id;
 }
 
-void _on_rtp_sending(FRACTaLSubController* this, SndPacket *packet)
+void _on_rtp_sending(gpointer udata, SndPacket *packet)
 {
+  FRACTaLSubController* this = udata;
 
   ++this->sent_packets;
   if(!this->enabled || this->stat->measurements_num < 10){
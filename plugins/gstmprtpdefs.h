@@ -19,6 +19,7 @@
 #define MPRTP_DEFAULT_EXTENSION_HEADER_ID 3
 #define ABS_TIME_DEFAULT_EXTENSION_HEADER_ID 8
 #define FEC_PAYLOAD_DEFAULT_ID 126
+#define FEC_RS_PAYLOAD_DEFAULT_ID 125
 #define SUBFLOW_DEFAULT_SENDING_RATE 300000
 #define TOTAL_MIN_SENDING_RATE 128000
 
@@ -48,6 +48,8 @@ static gboolean gst_mprtpplayouter_query (GstElement * element,
     GstQuery * query);
 static GstFlowReturn gst_mprtpplayouter_mprtp_sink_chain (GstPad * pad,
     GstObject * parent, GstBuffer * buffer);
+static GstFlowReturn gst_mprtpplayouter_mprtp_sink_chainlist (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static void
 _rcvctrler_time_update(GstMprtpplayouter *this);
 static GstFlowReturn gst_mprtpplayouter_mprtcp_sr_sink_chain (GstPad * pad,
@@ -80,6 +82,9 @@ _render_process (
 
 #define _now(this) gst_clock_get_time (this->sysclock)
 
+//Upper bound of a render sleep, so a stopped task notices it even without incoming packets
+#define PLAYOUTER_MAX_IDLE_WAIT (100 * GST_MSECOND)
+
 //static void _forward_process(GstMprtpplayouter* this);
 
 
@@ -95,6 +100,8 @@ enum
   PROP_MAX_REAPIR_DELAY,
   PROP_MAX_JOIN_DELAY,
   PROP_SETUP_RTCP_INTERVAL_TYPE,
+  PROP_FEC_RS_PAYLOAD_TYPE,
+  PROP_LATENCY_STATS,
 
 };
 
@@ -183,6 +190,18 @@ gst_mprtpplayouter_class_init (GstMprtpplayouterClass * klass)
           "Set or get the payload type of FEC packets.",
           0, 127, FEC_PAYLOAD_DEFAULT_ID, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_FEC_RS_PAYLOAD_TYPE,
+      g_param_spec_uint ("fec-rs-payload-type",
+          "Set or get the payload type of Reed-Solomon FEC packets.",
+          "Set or get the payload type of Reed-Solomon FEC packets.",
+          0, 127, FEC_RS_PAYLOAD_DEFAULT_ID, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_LATENCY_STATS,
+      g_param_spec_boxed ("latency-stats",
+          "Latency statistics of the hot path",
+          "Count, p50, p90, p99, p999 and max in nanoseconds of mprtp-chain, mprtp-chainlist and pad-push",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_property (gobject_class, PROP_JOIN_SUBFLOW,
         g_param_spec_uint ("join-subflow",
             "Join a subflow with a given id",
@@ -260,6 +279,8 @@ gst_mprtpplayouter_init (GstMprtpplayouter * this)
 
   gst_pad_set_chain_function (this->mprtp_sinkpad,
       GST_DEBUG_FUNCPTR (gst_mprtpplayouter_mprtp_sink_chain));
+  gst_pad_set_chain_list_function (this->mprtp_sinkpad,
+      GST_DEBUG_FUNCPTR (gst_mprtpplayouter_mprtp_sink_chainlist));
   gst_pad_set_query_function (this->mprtp_sinkpad,
       GST_DEBUG_FUNCPTR (gst_mprtpplayouter_sink_query));
   gst_pad_set_event_function (this->mprtp_sinkpad,
@@ -284,6 +305,7 @@ gst_mprtpplayouter_init (GstMprtpplayouter * this)
 
   this->sysclock                 = gst_system_clock_obtain();
   this->fec_payload_type         = FEC_PAYLOAD_DEFAULT_ID;
+  this->fec_rs_payload_type      = FEC_RS_PAYLOAD_DEFAULT_ID;
 
   this->pivot_address_subflow_id = 0;
   this->pivot_address            = NULL;
@@ -319,6 +341,9 @@ gst_mprtpplayouter_init (GstMprtpplayouter * this)
 
   this->packets_in = g_async_queue_new();
 
+  this->mprtp_chain_latency     = latencyhist_ctor("mprtp-chain");
+  this->mprtp_chainlist_latency = latencyhist_ctor("mprtp-chainlist");
+  this->pad_push_latency        = latencyhist_ctor("pad-push");
 }
 
 
@@ -336,6 +361,9 @@ gst_mprtpplayouter_finalize (GObject * object)
   g_object_unref(this->cc_ts_generator);
   g_object_unref(this->rtp_ts_generator);
   g_async_queue_unref(this->packets_in);
+  latencyhist_dtor(this->mprtp_chain_latency);
+  latencyhist_dtor(this->mprtp_chainlist_latency);
+  latencyhist_dtor(this->pad_push_latency);
 
   /* clean up object here */
   G_OBJECT_CLASS (gst_mprtpplayouter_parent_class)->finalize (object);
@@ -367,6 +395,9 @@ gst_mprtpplayouter_set_property (GObject * object, guint property_id,
     case PROP_FEC_PAYLOAD_TYPE:
       this->fec_payload_type = g_value_get_uint (value);
       break;
+    case PROP_FEC_RS_PAYLOAD_TYPE:
+      this->fec_rs_payload_type = g_value_get_uint (value);
+      break;
     case PROP_JOIN_SUBFLOW:
       rcvsubflows_join(this->subflows, g_value_get_uint (value));
       break;
@@ -418,6 +449,18 @@ gst_mprtpplayouter_get_property (GObject * object, guint property_id,
     case PROP_FEC_PAYLOAD_TYPE:
       g_value_set_uint (value, (guint) this->fec_payload_type);
       break;
+    case PROP_FEC_RS_PAYLOAD_TYPE:
+      g_value_set_uint (value, (guint) this->fec_rs_payload_type);
+      break;
+    case PROP_LATENCY_STATS:
+      {
+        GstStructure* stats = gst_structure_new_empty("mprtpplayouter-latency-stats");
+        latencyhist_append_to_structure(this->mprtp_chain_latency, stats);
+        latencyhist_append_to_structure(this->mprtp_chainlist_latency, stats);
+        latencyhist_append_to_structure(this->pad_push_latency, stats);
+        g_value_take_boxed (value, stats);
+      }
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -613,6 +656,7 @@ gst_mprtpplayouter_mprtp_sink_chain (GstPad * pad, GstObject * parent,
   RcvPacket* packet;
   GstFlowReturn result = GST_FLOW_OK;
   guint32 rcv_ts;
+  guint64 started = latencyhist_now();
   this = GST_MPRTPPLAYOUTER (parent);
   rcv_ts = timestamp_generator_get_ts(this->cc_ts_generator);
 
@@ -667,6 +711,11 @@ gst_mprtpplayouter_mprtp_sink_chain (GstPad * pad, GstObject * parent,
     goto done;
   }
 
+  if (*buf_2nd_byte == this->fec_rs_payload_type) {
+    fecdecoder_push_rs_fec_buffer(this->fec_decoder, gst_buffer_ref(buf));
+    goto done;
+  }
+
 //  packet = rcvpackets_get_packet(this->rcvpackets, gst_buffer_ref(buf));
 //  return gst_pad_push(this->mprtp_srcpad, rcvpacket_retrieve_buffer_and_unref(packet));
 //  packet = rcvpackets_get_packet(this->rcvpackets, gst_buffer_ref(buf));
@@ -688,11 +737,97 @@ gst_mprtpplayouter_mprtp_sink_chain (GstPad * pad, GstObject * parent,
 
   g_async_queue_push(this->packets_in, packet);
 done:
+  latencyhist_record(this->mprtp_chain_latency, latencyhist_now() - started);
   return result;
 
 }
 
 
+//Media packets go through the batched path, everything else
+//(MPRTCP, RTCP, non-MPRTP and FEC buffers) through the regular chain
+static gboolean _is_mprtp_media_packet(GstMprtpplayouter * this, GstBuffer * buf)
+{
+  GstMapInfo info;
+  guint8 buf_2nd_byte;
+  if (!gst_buffer_map (buf, &info, GST_MAP_READ)) {
+    return FALSE;
+  }
+  buf_2nd_byte = info.size < 2 ? 0 : info.data[1];
+  gst_buffer_unmap (buf, &info);
+
+  if (buf_2nd_byte == MPRTCP_PACKET_TYPE_IDENTIFIER ||
+      (buf_2nd_byte > 192 && buf_2nd_byte < 223) ||
+      buf_2nd_byte == this->fec_payload_type ||
+      buf_2nd_byte == this->fec_rs_payload_type) {
+    return FALSE;
+  }
+  return gst_buffer_is_mprtp(buf, rcvpackets_get_mprtp_ext_header_id(this->rcvpackets));
+}
+
+static void _ingest_packets(GstMprtpplayouter * this, RcvPacket** packets, gint32 packets_num)
+{
+  gint32 i;
+  if (packets_num < 1) {
+    return;
+  }
+  fecdecoder_push_rcv_packets(this->fec_decoder, packets, packets_num);
+
+  THIS_LOCK(this);
+  for (i = 0; i < packets_num; ++i) {
+    rcvtracker_add_packet(this->rcvtracker, packets[i]);
+  }
+  THIS_UNLOCK(this);
+
+  g_async_queue_lock(this->packets_in);
+  for (i = 0; i < packets_num; ++i) {
+    g_async_queue_push_unlocked(this->packets_in, packets[i]);
+  }
+  g_async_queue_unlock(this->packets_in);
+}
+
+static GstFlowReturn
+gst_mprtpplayouter_mprtp_sink_chainlist (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstMprtpplayouter *this;
+  RcvPacket* packets[PLAYOUTER_INGESTION_BATCH_SIZE];
+  gint32 packets_num = 0;
+  GstBuffer *buffer;
+  GstFlowReturn result = GST_FLOW_OK;
+  guint32 rcv_ts;
+  guint i, len;
+  guint64 started = latencyhist_now();
+
+  this = GST_MPRTPPLAYOUTER (parent);
+  rcv_ts = timestamp_generator_get_ts(this->cc_ts_generator);
+  len = gst_buffer_list_length (list);
+
+  for (i = 0; i < len; ++i) {
+    buffer = gst_buffer_list_get (list, i);
+    if (!_is_mprtp_media_packet(this, buffer)) {
+      _ingest_packets(this, packets, packets_num);
+      packets_num = 0;
+      result = gst_mprtpplayouter_mprtp_sink_chain (pad, parent, gst_buffer_ref(buffer));
+      if (result != GST_FLOW_OK) {
+        break;
+      }
+      continue;
+    }
+    packets[packets_num] = rcvpackets_get_packet(this->rcvpackets, gst_buffer_ref(buffer));
+    packets[packets_num]->cc_ts = rcv_ts;
+    if (PLAYOUTER_INGESTION_BATCH_SIZE <= ++packets_num) {
+      _ingest_packets(this, packets, packets_num);
+      packets_num = 0;
+    }
+  }
+  _ingest_packets(this, packets, packets_num);
+
+  gst_buffer_list_unref (list);
+  latencyhist_record(this->mprtp_chainlist_latency, latencyhist_now() - started);
+  return result;
+}
+
+
 void _rcvctrler_time_update(GstMprtpplayouter *this)
 {
   THIS_LOCK(this);
@@ -729,6 +864,11 @@ gst_mprtpplayouter_mprtcp_sr_sink_chain (GstPad * pad, GstObject * parent,
     goto done;
   }
 
+  if (*buf_2nd_byte == this->fec_rs_payload_type) {
+    fecdecoder_push_rs_fec_buffer(this->fec_decoder, gst_buffer_ref(buf));
+    goto done;
+  }
+
   result = _processing_mprtcp_packet (this, buf);
 
 done:
@@ -829,6 +969,26 @@ static GstBuffer* _get_buffer_for_forwarding(GstMprtpplayouter * this, RcvPacket
 }
 
 
+//Sleeps until a packet arrives or the next playout deadline of the jitterbuffer is due.
+static RcvPacket*
+_wait_for_packet(GstMprtpplayouter *this)
+{
+  GstClockTime deadline, now;
+  guint64 timeout;
+
+  deadline = jitterbuffer_get_next_playout_time(this->jitterbuffer);
+  if(!GST_CLOCK_TIME_IS_VALID(deadline)){
+    timeout = PLAYOUTER_MAX_IDLE_WAIT;
+  }else{
+    now = _now(this);
+    if(deadline <= now){
+      return g_async_queue_try_pop(this->packets_in);
+    }
+    timeout = MIN(deadline - now, PLAYOUTER_MAX_IDLE_WAIT);
+  }
+  return g_async_queue_timeout_pop(this->packets_in, MAX(GST_TIME_AS_USECONDS(timeout), 1));
+}
+
 static void
 _render_process_ (GstMprtpplayouter *this)
 {
@@ -836,7 +996,9 @@ _render_process_ (GstMprtpplayouter *this)
   RcvPacket* packet;
   GstBuffer* buffer;
 
-  while((packet = g_async_queue_timeout_pop(this->packets_in, 1000)) != NULL) {
+  packet = _wait_for_packet(this);
+  clocktick_begin(this->sysclock);
+  for(; packet != NULL; packet = g_async_queue_try_pop(this->packets_in)) {
     jitterbuffer_push_packet(this->jitterbuffer, packet);
     //stream_joiner_push_packet(this->joiner, packet);
 
@@ -879,13 +1041,14 @@ playout:
 //  buffer = packet->buffer;
 
 //  g_print("Packet (ref:%d) arrived at subflow %d with abs seq %hu ts: %u forwarded\n", packet->ref, packet->subflow_id, packet->abs_seq, packet->snd_rtp_ts);
-  //PROFILING("gst_pad_push",
+  LATENCYHIST_RECORD(this->pad_push_latency,
     gst_pad_push(this->mprtp_srcpad, buffer);
-  //);
+  );
 //  g_async_queue_push(this->buffers_out,  packet->buffer);
   rcvpacket_unref(packet); // The final point where the original ref should be zerod
   goto again;
 done:
+  clocktick_end();
   return;
 }
 
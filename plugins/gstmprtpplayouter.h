@@ -27,6 +27,7 @@
 #include "fecdec.h"
 #include "jitterbuffer.h"
 #include "timestampgenerator.h"
+#include "lib_latencyhist.h"
 
 #if GLIB_CHECK_VERSION (2, 35, 7)
 #include <gio/gnetworking.h>
@@ -57,6 +58,10 @@ G_BEGIN_DECLS
 #define GST_MPRTCP_PLAYOUTER_SENT_BYTES_STRUCTURE_NAME "GstCustomQueryMpRTCPPlayouter"
 #define GST_MPRTCP_PLAYOUTER_SENT_OCTET_SUM_FIELD "RTCPPlayouterSentBytes"
 
+//Number of packets ingested under one lock of the fec decoder,
+//the playouter and the render queue
+#define PLAYOUTER_INGESTION_BATCH_SIZE 64
+
 typedef struct _GstMprtpplayouter GstMprtpplayouter;
 typedef struct _GstMprtpplayouterClass GstMprtpplayouterClass;
 
@@ -83,6 +88,7 @@ struct _GstMprtpplayouter
   TimestampGenerator* rtp_ts_generator;
 
   guint8          fec_payload_type;
+  guint8          fec_rs_payload_type;
 
   GstTask*        thread;
   GRecMutex       thread_mutex;
@@ -99,6 +105,10 @@ struct _GstMprtpplayouter
 
   GAsyncQueue*    packets_in;
 
+  latencyhist_t*  mprtp_chain_latency;
+  latencyhist_t*  mprtp_chainlist_latency;
+  latencyhist_t*  pad_push_latency;
+
   guint32              pivot_clock_rate;
   GSocketAddress*      pivot_address;
   guint8               pivot_address_subflow_id;
@@ -89,14 +89,18 @@ static GstPadLinkReturn gst_mprtpreceiver_sink_link (GstPad * pad,
 static void gst_mprtpreceiver_sink_unlink (GstPad * pad, GstObject * parent);
 static GstFlowReturn gst_mprtpreceiver_sink_chain (GstPad * pad,
     GstObject * parent, GstBuffer * buffer);
+static GstFlowReturn gst_mprtpreceiver_sink_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 
 GstFlowReturn _send_mprtcp_buffer (GstMprtpreceiver * this, GstBuffer * buf);
+static GstPad *_select_mprtcp_outpad (GstMprtpreceiver * this, GstBuffer * buf);
 enum
 {
   PROP_0,
   PROP_MPRTP_EXT_HEADER_ID,
   PROP_REPORT_ONLY,
   PROP_FEC_PAYLOAD_TYPE,
+  PROP_FEC_RS_PAYLOAD_TYPE,
 };
 
 
@@ -192,6 +196,12 @@ gst_mprtpreceiver_class_init (GstMprtpreceiverClass * klass)
           "Set or get the payload type of fec packets. The default is 126",
           0, 127, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_FEC_RS_PAYLOAD_TYPE,
+      g_param_spec_uint ("fec-rs-payload-type",
+          "Set or get the payload type of Reed-Solomon fec packets",
+          "Set or get the payload type of Reed-Solomon fec packets. The default is 125",
+          0, 127, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   element_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_mprtpreceiver_request_new_pad);
   element_class->release_pad =
@@ -233,6 +243,7 @@ gst_mprtpreceiver_init (GstMprtpreceiver * mprtpreceiver)
   mprtpreceiver->only_report_receiving = FALSE;
   mprtpreceiver->mprtp_ext_header_id = MPRTP_DEFAULT_EXTENSION_HEADER_ID;
   mprtpreceiver->fec_payload_type = FEC_PAYLOAD_DEFAULT_ID;
+  mprtpreceiver->fec_rs_payload_type = FEC_RS_PAYLOAD_DEFAULT_ID;
   mprtpreceiver->sysclock = gst_system_clock_obtain();
 
 }
@@ -252,6 +263,9 @@ gst_mprtpreceiver_set_property (GObject * object, guint property_id,
     case PROP_FEC_PAYLOAD_TYPE:
       this->fec_payload_type = (guint8) g_value_get_uint (value);
       break;
+    case PROP_FEC_RS_PAYLOAD_TYPE:
+      this->fec_rs_payload_type = (guint8) g_value_get_uint (value);
+      break;
     case PROP_REPORT_ONLY:
       this->only_report_receiving = g_value_get_boolean (value);
       break;
@@ -278,6 +292,9 @@ gst_mprtpreceiver_get_property (GObject * object, guint property_id,
     case PROP_FEC_PAYLOAD_TYPE:
        g_value_set_uint (value, (guint) this->fec_payload_type);
        break;
+    case PROP_FEC_RS_PAYLOAD_TYPE:
+       g_value_set_uint (value, (guint) this->fec_rs_payload_type);
+       break;
     case PROP_REPORT_ONLY:
       g_value_set_boolean (value, this->only_report_receiving);
       break;
@@ -348,6 +365,8 @@ gst_mprtpreceiver_request_new_pad (GstElement * element, GstPadTemplate * templ,
       GST_DEBUG_FUNCPTR (gst_mprtpreceiver_sink_unlink));
   gst_pad_set_chain_function (sinkpad,
       GST_DEBUG_FUNCPTR (gst_mprtpreceiver_sink_chain));
+  gst_pad_set_chain_list_function (sinkpad,
+      GST_DEBUG_FUNCPTR (gst_mprtpreceiver_sink_chain_list));
 
   for(it = this->subflows; it; it = it->next){
     subflow = it->data;
@@ -559,109 +578,152 @@ typedef enum
   PACKET_IS_MPRTP_MONITORING,
 } PacketTypes;
 
+//Peeks into the beginning of the packet instead of mapping it
 static PacketTypes
 _get_packet_mptype (GstMprtpreceiver * this,
-    GstBuffer * buf, GstMapInfo * info, guint8 * subflow_id)
+    GstBuffer * buf, guint8 * subflow_id)
 {
-
-  guint8 first_byte, second_byte;
+  guint8 data[MPRTP_PEEK_HEADER_LENGTH];
+  const guint8 *mprtp_ext;
+  guint8 payload_type;
+  gsize size;
   PacketTypes result = PACKET_IS_NOT_MP;
-  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
-  MPRTPSubflowHeaderExtension *subflow_infos = NULL;
-  guint size;
-  gpointer pointer;
 
-  if (gst_buffer_extract (buf, 0, &first_byte, 1) != 1 ||
-      gst_buffer_extract (buf, 1, &second_byte, 1) != 1) {
+  size = gst_buffer_extract (buf, 0, data, sizeof (data));
+  if (size < 2) {
     GST_WARNING_OBJECT (this, "could not extract first byte from buffer");
     goto done;
   }
 
-  if (PACKET_IS_DTLS (first_byte)) {
+  if (PACKET_IS_DTLS (data[0]) || !PACKET_IS_RTP_OR_RTCP (data[0])) {
     goto done;
   }
 
-  if (PACKET_IS_RTP_OR_RTCP (first_byte)) {
-    if (PACKET_IS_RTCP (second_byte)) {
-      if (second_byte != MPRTCP_PACKET_TYPE_IDENTIFIER) {
-        goto done;
-      }
-      if (subflow_id) {
-        *subflow_id = (guint8)
-            g_ntohs (*((guint16 *) (info->data + 8 /*RTCP Header */  +
-                    6 /*first block info until subflow id */ )));
-      }
-      result = PACKET_IS_MPRTCP;
-      goto done;
-    }
-    if (G_UNLIKELY (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp))) {
-      GST_WARNING_OBJECT (this, "The RTP packet is not readable");
-      goto done;
-    }
-
-    if (!gst_rtp_buffer_get_extension (&rtp)) {
-      gst_rtp_buffer_unmap (&rtp);
-      goto done;
-    }
-    if (!gst_rtp_buffer_get_extension_onebyte_header (&rtp,
-            this->mprtp_ext_header_id, 0, &pointer, &size)) {
-      gst_rtp_buffer_unmap (&rtp);
+  if (PACKET_IS_RTCP (data[1])) {
+    if (data[1] != MPRTCP_PACKET_TYPE_IDENTIFIER || size < 16) {
       goto done;
     }
+    *subflow_id = (guint8) GST_READ_UINT16_BE (data + 8 /*RTCP Header */  +
+        6 /*first block info until subflow id */ );
+    result = PACKET_IS_MPRTCP;
+    goto done;
+  }
 
-    if (subflow_id) {
-      subflow_infos = (MPRTPSubflowHeaderExtension *) pointer;
-      *subflow_id = subflow_infos->id;
-    }
-    if(gst_rtp_buffer_get_payload_type(&rtp) == this->fec_payload_type){
-      result = PACKET_IS_MPRTP_MONITORING;
-    }else{
-      result = PACKET_IS_MPRTP;
-    }
-//    g_print("%d-%u|", *subflow_id, gst_rtp_buffer_get_timestamp(&rtp));
-    gst_rtp_buffer_unmap (&rtp);
+  mprtp_ext = mprtp_peek_onebyte_extension (data, size, this->mprtp_ext_header_id);
+  if (!mprtp_ext) {
     goto done;
   }
+  //the subflow id is the first field of MPRTPSubflowHeaderExtension
+  *subflow_id = mprtp_ext[0];
+  payload_type = data[1] & 0x7f;
+  if(payload_type == this->fec_payload_type ||
+     payload_type == this->fec_rs_payload_type){
+    result = PACKET_IS_MPRTP_MONITORING;
+  }else{
+    result = PACKET_IS_MPRTP;
+  }
 
 done:
   return result;
 }
 
+//Returns NULL if the buffer has to be dropped, MPRTCP reports
+//are split by _select_mprtcp_outpad as in _send_mprtcp_buffer
+static GstPad *
+_select_outpad (GstMprtpreceiver * this, GstBuffer * buf)
+{
+  PacketTypes packet_type;
+  guint8 subflow_id = 0;
+
+  packet_type = _get_packet_mptype (this, buf, &subflow_id);
+  if (packet_type == PACKET_IS_MPRTCP) {
+    return _select_mprtcp_outpad (this, buf);
+  } else if(packet_type == PACKET_IS_MPRTP_MONITORING){
+    return this->mprtcp_sr_srcpad;
+  }
+  return this->mprtp_srcpad;
+}
 
 static GstFlowReturn
 gst_mprtpreceiver_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 {
   GstMprtpreceiver *this;
   GstFlowReturn result;
-  GstMapInfo map;
   PacketTypes packet_type;
   guint8 subflow_id = 0;
 
   this = GST_MPRTPRECEIVER (parent);
   GST_DEBUG_OBJECT (this, "RTP/MPRTP/OTHER sink");
-  if (!gst_buffer_map (buf, &map, GST_MAP_READ)) {
-    GST_ERROR_OBJECT (this, "Buffer is not readable");
-    result = GST_FLOW_CUSTOM_ERROR;
-    goto exit;
-  }
 
   THIS_READLOCK (this);
 //  PROFILING("gst_mprtpreceiver_sink_chain",
-  packet_type = _get_packet_mptype (this, buf, &map, &subflow_id);
+  packet_type = _get_packet_mptype (this, buf, &subflow_id);
 //  );
   if (packet_type == PACKET_IS_MPRTCP) {
     result = _send_mprtcp_buffer (this, buf);
   } else if(packet_type == PACKET_IS_MPRTP_MONITORING){
-    gst_buffer_unmap (buf, &map);
     result = gst_pad_push (this->mprtcp_sr_srcpad, buf);
   }else{
-    gst_buffer_unmap (buf, &map);
     result = gst_pad_push (this->mprtp_srcpad, buf);
   }
 
   THIS_READUNLOCK (this);
 
-exit:
+  return result;
+}
+
+//Classifies the buffers of the list in one pass and pushes
+//one list per outpad, buffers keep their order on every outpad.
+static GstFlowReturn
+gst_mprtpreceiver_sink_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstMprtpreceiver *this;
+  GstFlowReturn result = GST_FLOW_OK, flow;
+  GstPad *outpads[3];
+  GstBufferList *outlists[3] = {NULL, NULL, NULL};
+  GstBuffer *buf;
+  GstPad *outpad;
+  guint i, j, length;
+
+  this = GST_MPRTPRECEIVER (parent);
+  GST_DEBUG_OBJECT (this, "RTP/MPRTP/OTHER sink list");
+
+  THIS_READLOCK (this);
+  outpads[0] = this->mprtp_srcpad;
+  outpads[1] = this->mprtcp_sr_srcpad;
+  outpads[2] = this->mprtcp_rr_srcpad;
+  length = gst_buffer_list_length (list);
+  for (i = 0; i < length; ++i) {
+    buf = gst_buffer_list_get (list, i);
+    outpad = _select_outpad (this, buf);
+    for (j = 0; j < 3; ++j) {
+      if (outpads[j] == outpad) {
+        break;
+      }
+    }
+    if (j == 3) {
+      //unreadable report
+      continue;
+    }
+    if (!outlists[j]) {
+      outlists[j] = gst_buffer_list_new_sized (length - i);
+    }
+    gst_buffer_list_add (outlists[j], gst_buffer_ref (buf));
+  }
+  gst_buffer_list_unref (list);
+
+  for (j = 0; j < 3; ++j) {
+    if (!outlists[j]) {
+      continue;
+    }
+    flow = gst_pad_push_list (outpads[j], outlists[j]);
+    if (result == GST_FLOW_OK) {
+      result = flow;
+    }
+  }
+  THIS_READUNLOCK (this);
+
   return result;
 }
 
@@ -671,7 +733,19 @@ exit:
 GstFlowReturn
 _send_mprtcp_buffer (GstMprtpreceiver * this, GstBuffer * buf)
 {
-  GstFlowReturn result = GST_FLOW_OK;
+  GstPad *outpad = _select_mprtcp_outpad (this, buf);
+  if (!outpad) {
+    gst_buffer_unref (buf);
+    return GST_FLOW_OK;
+  }
+  return gst_pad_push (outpad, buf);
+}
+
+//A report goes to the SR outpad if it has a sender report block,
+//otherwise it goes to the RR outpad
+static GstPad *
+_select_mprtcp_outpad (GstMprtpreceiver * this, GstBuffer * buf)
+{
   GstPad *outpad;
   GstRTCPBuffer rtcp = { NULL, };
   GstRTCPHeader *header;
@@ -685,7 +759,7 @@ _send_mprtcp_buffer (GstMprtpreceiver * this, GstBuffer * buf)
 
   if (G_UNLIKELY (!gst_rtcp_buffer_map (buf, GST_MAP_READ, &rtcp))) {
     GST_WARNING_OBJECT (this, "The RTCP packet is not readable");
-    return result;
+    return NULL;
   }
 
   report = (GstMPRTCPSubflowReport *) gst_rtcp_get_first_header (&rtcp);
@@ -704,8 +778,8 @@ _send_mprtcp_buffer (GstMprtpreceiver * this, GstBuffer * buf)
       processed_length +=actual_length + 1;
       header = actual = processed_length * 4 + (gchar*)databed;
   }
-  result = gst_pad_push (outpad, buf);
-  return result;
+  gst_rtcp_buffer_unmap (&rtcp);
+  return outpad;
 }
 
 
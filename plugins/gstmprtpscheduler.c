@@ -56,6 +56,8 @@ GST_DEBUG_CATEGORY_STATIC (gst_mprtpscheduler_debug_category);
 
 #define _now(this) gst_clock_get_time (this->sysclock)
 
+#define INCOMING_BUFFERS_RING_SIZE 2048
+
 static void gst_mprtpscheduler_set_property (GObject * object,
     guint property_id, const GValue * value, GParamSpec * pspec);
 static void gst_mprtpscheduler_get_property (GObject * object,
@@ -89,6 +91,10 @@ static void _on_rtcp_ready(GstMprtpscheduler * this, GstBuffer *buffer);
 static void _on_monitoring_request(GstMprtpscheduler * this, SndSubflow* subflow);
 static void _on_monitoring_response(GstMprtpscheduler * this, FECEncoderResponse *response);
 static void _mprtpscheduler_send_packet (GstMprtpscheduler * this, SndPacket *packet);
+static void _wake_up_approval(GstMprtpscheduler * this);
+static void _process_incoming_buffers(GstMprtpscheduler * this);
+static void _process_buffer(GstMprtpscheduler * this, GstBuffer* buffer);
+static void _stop_approval(GstMprtpscheduler * this);
 static void mprtpscheduler_approval_process(GstMprtpscheduler *this);
 static void mprtpscheduler_emitter_process(gpointer udata);
 
@@ -111,6 +117,9 @@ enum
   PROP_SETUP_REPORT_TIMEOUT,
   PROP_FEC_INTERVAL,
   PROP_ALLOWED_SSRC,
+  PROP_FEC_RS_PAYLOAD_TYPE,
+  PROP_FEC_REPAIR_PACKETS,
+  PROP_LATENCY_STATS,
 };
 
 /* signals and args */
@@ -283,6 +292,25 @@ gst_mprtpscheduler_class_init (GstMprtpschedulerClass * klass)
           "Apply MPRTP and Congestion Control only for a certain packet with the given SSRC (0 means any)",
           0, 4294967295, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_FEC_RS_PAYLOAD_TYPE,
+      g_param_spec_uint ("fec-rs-payload-type",
+          "Set or get the payload type of Reed-Solomon FEC packets.",
+          "Set or get the payload type of Reed-Solomon FEC packets.",
+          0, 127, FEC_RS_PAYLOAD_DEFAULT_ID, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_FEC_REPAIR_PACKETS,
+      g_param_spec_uint ("fec-repair-packets",
+          "Set or get the number of Reed-Solomon repair packets per FEC block",
+          "Set or get the number of Reed-Solomon repair packets per FEC block. 0 - single parity XOR FEC with fec-payload-type, "
+          "1..8 - Reed-Solomon FEC with fec-rs-payload-type recovering up to that many losses",
+          0, GST_RTPFEC_MAX_REPAIR_NUM, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_LATENCY_STATS,
+      g_param_spec_boxed ("latency-stats",
+          "Latency statistics of the hot path",
+          "Count, p50, p90, p99, p999 and max in nanoseconds of rtp-chain, mprtcp-chain, send-packet and pad-push",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   _subflows_utilization =
       g_signal_new ("mprtp-subflows-utilization", G_TYPE_FROM_CLASS (klass),
       G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstMprtpschedulerClass, mprtp_media_rate_utilization),
@@ -302,6 +330,7 @@ gst_mprtpscheduler_init (GstMprtpscheduler * this)
 //  }
 
   this->sendq = g_async_queue_new();
+  this->incoming_buffers = spscring_ctor(INCOMING_BUFFERS_RING_SIZE);
 
   this->rtp_sinkpad =
       gst_pad_new_from_static_template (&gst_mprtpscheduler_rtp_sink_template,
@@ -360,8 +389,10 @@ gst_mprtpscheduler_init (GstMprtpscheduler * this)
   g_mutex_init (&this->mutex);
   g_cond_init(&this->waiting_signal);
   g_cond_init(&this->receiving_signal);
+  g_cond_init(&this->ring_space_signal);
 
   this->fec_payload_type = FEC_PAYLOAD_DEFAULT_ID;
+  this->fec_rs_payload_type = FEC_RS_PAYLOAD_DEFAULT_ID;
 
   this->monitoring    = make_mediator();
   this->on_rtcp_ready = make_notifier("MPRTPSch: on-rtcp-ready");
@@ -371,6 +402,11 @@ gst_mprtpscheduler_init (GstMprtpscheduler * this)
   this->emit_msger    = make_messenger(sizeof(MPRTPPluginSignal));
   this->allowed_ssrc  = 0;
 
+  this->rtp_chain_latency    = latencyhist_ctor("rtp-chain");
+  this->mprtcp_chain_latency = latencyhist_ctor("mprtcp-chain");
+  this->send_packet_latency  = latencyhist_ctor("send-packet");
+  this->pad_push_latency     = latencyhist_ctor("pad-push");
+
   this->sndqueue      = make_sndqueue(this->subflows);
   this->sndtracker    = make_sndtracker(this->subflows, this->sndqueue);
   this->splitter      = make_stream_splitter(this->subflows, this->sndtracker, this->sndqueue);
@@ -397,20 +433,24 @@ gst_mprtpscheduler_init (GstMprtpscheduler * this)
       (ListenerFunc) stream_splitter_on_subflow_state_changed,
       this->splitter);
 
+  sndsubflows_add_on_path_active_changed_cb(this->subflows,
+      (ListenerFunc) stream_splitter_on_subflow_path_active_changed,
+      this->splitter);
+
   sndsubflows_add_on_subflow_state_stat_changed_cb(this->subflows,
       (ListenerFunc) stream_splitter_on_subflow_state_stat_changed,
       this->splitter);
 
   sndtracker_add_on_packet_sent(this->sndtracker,
-      (ListenerFunc) stream_splitter_on_packet_sent,
+      stream_splitter_on_packet_sent,
       this->splitter);
 
   sndqueue_add_on_packet_queued(this->sndqueue,
-      (ListenerFunc) stream_splitter_on_packet_queued,
+      stream_splitter_on_packet_queued,
       this->splitter);
 
   sndtracker_add_on_packet_obsolated(this->sndtracker,
-      (ListenerFunc) stream_splitter_on_packet_obsolated,
+      stream_splitter_on_packet_obsolated,
       this->splitter);
 
   sndsubflows_add_on_subflow_joined_cb(this->subflows,
@@ -451,7 +491,6 @@ gst_mprtpscheduler_init (GstMprtpscheduler * this)
 
   this->abs_time_ext_header_id   = ABS_TIME_DEFAULT_EXTENSION_HEADER_ID;
   this->cc_ts_generator             = g_object_ref(sndtracker_get_ts_generator(this->sndtracker));
-
 }
 
 
@@ -479,15 +518,26 @@ gst_mprtpscheduler_finalize (GObject * object)
   gst_object_unref (this->thread);
 
   g_async_queue_unref(this->sendq);
+  spscring_clear(this->incoming_buffers, (void (*)(gpointer)) gst_buffer_unref);
+  spscring_dtor(this->incoming_buffers);
 
   g_object_unref (this->sysclock);
+  g_object_unref (this->controller);
   g_object_unref (this->subflows);
-  g_object_unref (this->sndpackets);
   g_object_unref (this->splitter);
+  g_object_unref (this->sndtracker);
   g_object_unref (this->fec_encoder);
   g_object_unref (this->sndqueue);
   g_object_unref (this->cc_ts_generator);
   g_object_unref(this->emit_msger);
+  //the packets are carved from the slabs of sndpackets,
+  //so it goes after everything can hold a packet
+  g_object_unref (this->sndpackets);
+
+  latencyhist_dtor(this->rtp_chain_latency);
+  latencyhist_dtor(this->mprtcp_chain_latency);
+  latencyhist_dtor(this->send_packet_latency);
+  latencyhist_dtor(this->pad_push_latency);
 
   G_OBJECT_CLASS (gst_mprtpscheduler_parent_class)->finalize (object);
 }
@@ -547,6 +597,14 @@ gst_mprtpscheduler_set_property (GObject * object, guint property_id,
     case PROP_ALLOWED_SSRC:
       this->allowed_ssrc = g_value_get_uint (value);
       break;
+    case PROP_FEC_RS_PAYLOAD_TYPE:
+      this->fec_rs_payload_type = (guint8) g_value_get_uint (value);
+      fecencoder_set_reed_solomon(this->fec_encoder, this->fec_rs_payload_type, this->fec_repair_num);
+      break;
+    case PROP_FEC_REPAIR_PACKETS:
+      this->fec_repair_num = (guint8) g_value_get_uint (value);
+      fecencoder_set_reed_solomon(this->fec_encoder, this->fec_rs_payload_type, this->fec_repair_num);
+      break;
     case PROP_SET_SENDING_TARGET:
       guint_value = g_value_get_uint (value);
       sndsubflows_set_target_bitrate(this->subflows, subflow_prop->id, subflow_prop->value);
@@ -601,6 +659,22 @@ gst_mprtpscheduler_get_property (GObject * object, guint property_id,
     case PROP_ALLOWED_SSRC:
       g_value_set_uint (value, (guint) this->allowed_ssrc);
       break;
+    case PROP_FEC_RS_PAYLOAD_TYPE:
+      g_value_set_uint (value, (guint) this->fec_rs_payload_type);
+      break;
+    case PROP_FEC_REPAIR_PACKETS:
+      g_value_set_uint (value, (guint) this->fec_repair_num);
+      break;
+    case PROP_LATENCY_STATS:
+      {
+        GstStructure* stats = gst_structure_new_empty("mprtpscheduler-latency-stats");
+        latencyhist_append_to_structure(this->rtp_chain_latency, stats);
+        latencyhist_append_to_structure(this->mprtcp_chain_latency, stats);
+        latencyhist_append_to_structure(this->send_packet_latency, stats);
+        latencyhist_append_to_structure(this->pad_push_latency, stats);
+        g_value_take_boxed (value, stats);
+      }
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -627,6 +701,7 @@ gst_mprtpscheduler_change_state (GstElement * element,
     case GST_STATE_CHANGE_READY_TO_PAUSED:
       break;
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
+       g_atomic_int_set(&this->approval_running, TRUE);
        gst_pad_start_task(this->mprtp_srcpad, (GstTaskFunction)mprtpscheduler_approval_process,
          this, NULL);
        gst_task_set_lock (this->thread, &this->thread_mutex);
@@ -643,8 +718,10 @@ gst_mprtpscheduler_change_state (GstElement * element,
    switch (transition) {
      case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
        gst_task_stop (this->thread);
+       messenger_wake_up(this->emit_msger);
        break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      _stop_approval(this);
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
       break;
@@ -700,11 +777,11 @@ gst_mprtpscheduler_rtp_sink_chain (GstPad * pad, GstObject * parent,
   GstFlowReturn result;
   guint8 first_byte;
   guint8 second_byte;
-  SndPacket* packet = NULL;
-  SndSubflow* subflow = NULL;
   guint32 third_word;
+  guint64 start;
 
   this = GST_MPRTPSCHEDULER (parent);
+  LATENCYHIST_BEGIN(start);
 
   if (GST_PAD_IS_FLUSHING(pad)) {
     result = GST_FLOW_FLUSHING;
@@ -750,38 +827,46 @@ gst_mprtpscheduler_rtp_sink_chain (GstPad * pad, GstObject * parent,
   //here we don't at the creation.
   //fecencoder_add_rtpbuffer(this->fec_encoder, gst_buffer_ref(buffer));
 
-  THIS_LOCK(this);
-PROFILING("gst_mprtpscheduler_rtp_sink_chain",
-  if(!sndsubflows_get_subflows_num(this->subflows)){
-    result = gst_pad_push(this->mprtp_srcpad, buffer);
-    goto unlock_and_done;
-  }
-  {
-//    GstBuffer* newbuf = NULL;
-//    gst_buffer_pool_acquire_buffer(this->mprtp_buffer_pool, &newbuf, NULL);
-//    g_print("%p %d %d, %p->%p", newbuf, buffer->mini_object.refcount, gst_buffer_is_all_memory_writable(buffer),
-//        buffer, gst_buffer_make_writable(buffer));
-//    gst_buffer_copy_into(newbuf, buffer, GST_BUFFER_COPY_ALL, 0, -1);
-//    gst_buffer_unref(buffer);
-//    packet = sndpackets_make_packet(this->sndpackets, newbuf);
-//    exit(0);
+  //The buffer is handed over to the approval thread, which does the splitting,
+  //so the upstream thread never waits for the network side.
+  //If the ring is full the thread blocks until the approval thread makes space,
+  //if the approval task does not run the buffer is processed here as it used to be.
+  while(!g_atomic_int_get(&this->approval_running) || !spscring_push(this->incoming_buffers, buffer)){
+    THIS_LOCK(this);
+    if (GST_PAD_IS_FLUSHING(pad)) {
+      THIS_UNLOCK(this);
+      gst_buffer_unref(buffer);
+      result = GST_FLOW_FLUSHING;
+      goto done;
+    }
+    if (!g_atomic_int_get(&this->approval_running)) {
+      //buffers handed over before the task stopped go first
+      _process_incoming_buffers(this);
+      _process_buffer(this, buffer);
+      THIS_UNLOCK(this);
+      goto done;
+    }
+    g_atomic_int_set(&this->producer_waiting, TRUE);
+    if (this->incoming_buffers->mask < spscring_readcapacity(this->incoming_buffers)) {
+      g_cond_signal(&this->receiving_signal);
+      //the timeout only lets the flushing flag be seen
+      g_cond_wait_until(&this->ring_space_signal, &this->mutex, g_get_monotonic_time() + 20 * G_TIME_SPAN_MILLISECOND);
+    }
+    g_atomic_int_set(&this->producer_waiting, FALSE);
+    THIS_UNLOCK(this);
   }
-
-//  packet = sndpackets_make_packet(this->sndpackets, gst_buffer_ref(buffer));
-  packet = sndpackets_make_packet(this->sndpackets, buffer);
-
-  subflow = stream_splitter_select_subflow(this->splitter, packet);
-  if(subflow){
-    sndpacket_setup_mprtp(packet, subflow->id, sndsubflow_get_next_subflow_seq(subflow));
-    fecencoder_add_rtpbuffer(this->fec_encoder, gst_buffer_ref(packet->buffer));
-    sndqueue_push_packet(this->sndqueue, packet);
-    g_cond_signal(&this->receiving_signal);
+  //the task may have stopped since the flag was read above,
+  //then nobody else would take the buffer out of the ring
+  if (!g_atomic_int_get(&this->approval_running)) {
+    THIS_LOCK(this);
+    _process_incoming_buffers(this);
+    THIS_UNLOCK(this);
+    goto done;
   }
-);
-unlock_and_done:
-  THIS_UNLOCK(this);
+  _wake_up_approval(this);
 
 done:
+  LATENCYHIST_END(this->rtp_chain_latency, start);
   return result;
 }
 
@@ -795,7 +880,6 @@ gst_mprtpscheduler_rtp_sink_chainlist (GstPad * pad, GstObject * parent,
   GstFlowReturn result;
 
   result = GST_FLOW_OK;
-PROFILING2("gst_mprtpscheduler_rtp_sink_chainlist",
   /* chain each buffer in list individually */
   len = gst_buffer_list_length (list);
 
@@ -809,7 +893,6 @@ PROFILING2("gst_mprtpscheduler_rtp_sink_chainlist",
     if (result != GST_FLOW_OK)
       break;
   }
-);
 done:
   return result;
 }
@@ -833,7 +916,7 @@ gst_mprtpscheduler_mprtcp_rr_sink_chain (GstPad *pad, GstObject *parent, GstBuff
     THIS_LOCK(this);
   //);
 
-  PROFILING("sndctrler_receive_mprtcp",
+  LATENCYHIST_RECORD(this->mprtcp_chain_latency,
     sndctrler_receive_mprtcp(this->controller, buf);
     result = GST_FLOW_OK;
   );
@@ -950,7 +1033,7 @@ PROFILING("_on_monitoring_response",
 );
 //  THIS_LOCK(this);
 //  sndtracker_add_fec_response(this->sndtracker, response);
-//  gst_pad_push(this->mprtp_srcpad, response->fecbuffer);
+//  gst_pad_push(this->mprtp_srcpad, response->fecbuffers[0]);
 //  fecencoder_unref_response(response);
 //  THIS_UNLOCK(this);
 }
@@ -959,7 +1042,7 @@ void
 _mprtpscheduler_send_packet (GstMprtpscheduler * this, SndPacket *packet)
 {
   GstBuffer *buffer;
-PROFILING("_mprtpscheduler_send_packet",
+LATENCYHIST_RECORD(this->send_packet_latency,
   sndtracker_packet_sent(this->sndtracker, packet);
   buffer = sndpacket_retrieve(packet);
 );
@@ -973,7 +1056,7 @@ PROFILING("_mprtpscheduler_send_packet",
 //  }else{
 //    gst_pad_push(this->mprtp_srcpad, buffer);
 //  }
-  PROFILING("gst_pad_push",
+  LATENCYHIST_RECORD(this->pad_push_latency,
   gst_pad_push(this->mprtp_srcpad, buffer);
   //TODO: should goes to a sent process, but we stop adding the abs_time_ext_header
   packet->sent_ts = timestamp_generator_get_ts(this->cc_ts_generator);
@@ -981,13 +1064,16 @@ PROFILING("_mprtpscheduler_send_packet",
   );
   if(this->fec_requested){
     FECEncoderResponse* response;
+    gint32 i;
     response = messenger_try_pop_block(this->fec_responses);
     if(response){
       sndtracker_add_fec_response(this->sndtracker, response);
       //PROFILING("fec_requested",
-      gst_pad_push(this->mprtp_srcpad, response->fecbuffer);
+      for(i = 0; i < response->fecbuffers_num; ++i){
+        gst_pad_push(this->mprtp_srcpad, response->fecbuffers[i]);
+      }
       //);
-//        g_async_queue_push(this->sendq, response->fecbuffer);
+//        g_async_queue_push(this->sendq, response->fecbuffers[0]);
       fecencoder_unref_response(response);
       this->fec_requested = FALSE;
     }
@@ -1000,6 +1086,70 @@ PROFILING("_mprtpscheduler_send_packet",
   return;
 }
 
+void
+_wake_up_approval(GstMprtpscheduler * this)
+{
+  if(!g_atomic_int_get(&this->approval_waiting)){
+    return;
+  }
+  THIS_LOCK(this);
+  g_cond_signal(&this->receiving_signal);
+  THIS_UNLOCK(this);
+}
+
+//Called with the lock held, either by the approval thread, by _stop_approval
+//or by the chain thread when the approval task does not run
+void
+_process_incoming_buffers(GstMprtpscheduler * this)
+{
+  GstBuffer* buffer;
+  gboolean popped = FALSE;
+
+  while((buffer = spscring_pop(this->incoming_buffers)) != NULL){
+    popped = TRUE;
+    _process_buffer(this, buffer);
+  }
+  if(popped && g_atomic_int_get(&this->producer_waiting)){
+    g_cond_signal(&this->ring_space_signal);
+  }
+}
+
+void
+_process_buffer(GstMprtpscheduler * this, GstBuffer* buffer)
+{
+  SndPacket* packet;
+  SndSubflow* subflow;
+
+  if(!sndsubflows_get_subflows_num(this->subflows)){
+    gst_pad_push(this->mprtp_srcpad, buffer);
+    return;
+  }
+
+  packet = sndpackets_make_packet(this->sndpackets, buffer);
+  subflow = stream_splitter_select_subflow(this->splitter, packet);
+  if(!subflow){
+    return;
+  }
+  sndpacket_setup_mprtp(packet, subflow->id, sndsubflow_get_next_subflow_seq(subflow));
+  fecencoder_add_rtpbuffer(this->fec_encoder, gst_buffer_ref(packet->buffer));
+  sndqueue_push_packet(this->sndqueue, packet);
+}
+
+//The chain thread processes the buffers itself from now on,
+//a thread waiting for space in the ring is woken up to do so.
+//The flag is set before the ring is drained, so a buffer pushed by a chain thread
+//that still saw the task running is either taken here or seen by that thread.
+void
+_stop_approval(GstMprtpscheduler * this)
+{
+  THIS_LOCK(this);
+  g_atomic_int_set(&this->approval_running, FALSE);
+  _process_incoming_buffers(this);
+  g_cond_broadcast(&this->ring_space_signal);
+  g_cond_signal(&this->receiving_signal);
+  THIS_UNLOCK(this);
+}
+
 static void
 mprtpscheduler_approval_process (GstMprtpscheduler *this)
 {
@@ -1011,17 +1161,27 @@ mprtpscheduler_approval_process (GstMprtpscheduler *this)
   THIS_LOCK(this);
 //);
 
+  //the components called from here take the time sampled once per iteration
+  clocktick_begin(this->sysclock);
+  _process_incoming_buffers(this);
   if(sndqueue_is_empty(this->sndqueue)){
-    g_cond_wait(&this->receiving_signal, &this->mutex);
+    //the flag is raised before the ring is checked again, so the producer
+    //either sees it and signals or its buffer is already visible here
+    g_atomic_int_set(&this->approval_waiting, TRUE);
+    if(spscring_isempty(this->incoming_buffers)){
+      g_cond_wait(&this->receiving_signal, &this->mutex);
+    }
+    g_atomic_int_set(&this->approval_waiting, FALSE);
+    clocktick_refresh(this->sysclock);
+    _process_incoming_buffers(this);
   }
 
   sndtracker_refresh(this->sndtracker);
   sndctrler_time_update(this->controller);
 //  rtpqstat = sndtracker_get_rtpqstat(this->sndtracker);
 
-  now = _now(this);
+  now = clocktick_now(this->sysclock);
   next_time = now;
-  // TODO: Pacing is turned off now, by commenting out the important code snippet in sending queue.
   packet = sndqueue_pop_packet(this->sndqueue, &next_time);
   if (now < next_time) {
     // It is really important to place a cond wait here.
@@ -1029,9 +1189,14 @@ mprtpscheduler_approval_process (GstMprtpscheduler *this)
     // two active thread trying to compete. Once spinning and the other is waiting at the lock
     // to push a packet into the sndqueue.
     // It results spurious peaks on sending rate
-    while(g_cond_wait_until(&this->receiving_signal, &this->mutex, GST_TIME_AS_USECONDS(next_time - now))) {
-      now = _now(this);
+    // The wait lasts until the earliest paced subflow can send again
+    // or a new buffer arrives, which may belong to a subflow not paced.
+    g_atomic_int_set(&this->approval_waiting, TRUE);
+    if(spscring_isempty(this->incoming_buffers)){
+      g_cond_wait_until(&this->receiving_signal, &this->mutex,
+          g_get_monotonic_time() + GST_TIME_AS_USECONDS(next_time - now));
     }
+    g_atomic_int_set(&this->approval_waiting, FALSE);
     goto done;
   }
   if (!packet) {
@@ -1058,6 +1223,7 @@ mprtpscheduler_approval_process (GstMprtpscheduler *this)
   //);
 
 done:
+  clocktick_end();
   THIS_UNLOCK(this);
   return;
 }
@@ -1075,7 +1241,7 @@ mprtpscheduler_emitter_process (gpointer udata)
 
   messenger_lock(this->emit_msger);
 
-  msg = messenger_pop_block_with_timeout_unlocked(this->emit_msger, 10000);
+  msg = messenger_pop_block_or_wake_up_unlocked(this->emit_msger);
 
   if(!msg){
     goto done;
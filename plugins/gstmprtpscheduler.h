@@ -29,6 +29,8 @@
 #include "mediator.h"
 #include "sndqueue.h"
 #include "timestampgenerator.h"
+#include "lib_spscring.h"
+#include "lib_latencyhist.h"
 
 G_BEGIN_DECLS
 #define GST_TYPE_MPRTPSCHEDULER   (gst_mprtpscheduler_get_type())
@@ -50,6 +52,7 @@ struct _GstMprtpscheduler
   GMutex                        mutex;
   GCond                         waiting_signal;
   GCond                         receiving_signal;
+  GCond                         ring_space_signal;
   GstPad*                       rtp_sinkpad;
   GstPad*                       mprtp_srcpad;
   GstPad*                       mprtcp_rr_sinkpad;
@@ -57,6 +60,10 @@ struct _GstMprtpscheduler
 
 
   GAsyncQueue*                  sendq;
+  spscring_t*                   incoming_buffers;
+  volatile gint                 approval_waiting;
+  volatile gint                 approval_running;   ///< the approval task drains incoming_buffers
+  volatile gint                 producer_waiting;   ///< the chain thread waits for space in incoming_buffers
   TimestampGenerator*           cc_ts_generator;
   gboolean                      preroll;
 
@@ -70,6 +77,8 @@ struct _GstMprtpscheduler
   GstClockTime                  position_out;
 
   guint8                        fec_payload_type;
+  guint8                        fec_rs_payload_type;
+  guint8                        fec_repair_num;
   GstClockTime                  obsolation_treshold;
   GstClock*                     sysclock;
 
@@ -92,6 +101,11 @@ struct _GstMprtpscheduler
   gboolean                      fec_requested;
   Notifier*                     on_rtcp_ready;
 
+  latencyhist_t*                rtp_chain_latency;
+  latencyhist_t*                mprtcp_chain_latency;
+  latencyhist_t*                send_packet_latency;
+  latencyhist_t*                pad_push_latency;
+
   GstMprtpschedulerPrivate*     priv;
 
   guint8 abs_time_ext_header_id;
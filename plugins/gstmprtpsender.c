@@ -53,6 +53,13 @@ GST_DEBUG_CATEGORY_STATIC (gst_mprtpsender_debug_category);
 #define PACKET_IS_RTCP(b) (b > 192 && b < 223)
 
 #define _now(this) (gst_clock_get_time(this->sysclock))
+#define _get_subflows(this) ((SubflowsTable*) g_atomic_pointer_get(&this->subflows))
+//Readers are counted before they load the table, so a writer seeing no reader
+//after it published a new table knows the retired ones are not used anymore
+#define _enter_subflows(this) (g_atomic_int_inc(&this->readers))
+
+//A subflow has a sync and an async outpad, and there is a pivot outpad
+#define MPRTPSENDER_OUTPADS_MAX_NUM (2 * 256 + 1)
 
 static void gst_mprtpsender_set_property (GObject * object,
     guint property_id, const GValue * value, GParamSpec * pspec);
@@ -77,6 +84,8 @@ gst_mprtpsender_src_query (GstPad * sinkpad, GstObject * parent,
     GstQuery * query);
 static GstFlowReturn gst_mprtpsender_mprtp_sink_chain (GstPad * pad,
     GstObject * parent, GstBuffer * buffer);
+static GstFlowReturn gst_mprtpsender_mprtp_sink_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 
 static GstFlowReturn
 gst_mprtpsender_mprtcp_sink_chain (GstPad * pad, GstObject * parent,
@@ -99,6 +108,17 @@ typedef struct
 //  GstClock  *sysclock;
 } Subflow;
 
+//Subflows are read by the chain functions without lock. A writer makes a new
+//table under the write lock and publishes it. The replaced tables and the
+//removed subflows are retired, as a streaming thread may still use them,
+//and freed once no reader is inside (see _leave_subflows).
+typedef struct
+{
+  Subflow   *lookup[256];
+  Subflow   *items[256];
+  gint       items_num;
+} SubflowsTable;
+
 
 static Subflow *_get_subflow_from_blocks (GstMprtpsender * this,
     GstBuffer * blocks);
@@ -106,6 +126,7 @@ static Subflow *
 _get_subflow_from_report (GstMprtpsender * this, GstBuffer * blocks);
 static gboolean _select_subflow (GstMprtpsender * this, guint8 id,
     Subflow ** result);
+static void _leave_subflows (GstMprtpsender * this);
 
 enum
 {
@@ -114,6 +135,8 @@ enum
   PROP_FEC_PAYLOAD_TYPE,
   PROP_ASYNC_FEC,
   PROP_PIVOT_OUTPAD,
+  PROP_FEC_RS_PAYLOAD_TYPE,
+  PROP_LATENCY_STATS,
 };
 
 /* pad templates */
@@ -175,12 +198,58 @@ struct _GstMprtpsenderPrivate
 
 static void _iterate_subflows(GstMprtpsender *this, void (*process)(Subflow*,gpointer),gpointer data)
 {
-  GList *it;
-  Subflow *subflow;
-  for(it = this->subflows; it; it = it->next)
+  SubflowsTable *subflows;
+  gint i;
+  _enter_subflows(this);
+  subflows = _get_subflows(this);
+  for(i = 0; i < subflows->items_num; ++i)
   {
-    subflow = it->data;
-    process(subflow, data);
+    process(subflows->items[i], data);
+  }
+  _leave_subflows(this);
+}
+
+//Must be called under the write lock
+static SubflowsTable* _copy_subflows(GstMprtpsender *this)
+{
+  SubflowsTable *result = g_new (SubflowsTable, 1);
+  memcpy(result, _get_subflows(this), sizeof(SubflowsTable));
+  return result;
+}
+
+//Must be called under the write lock
+static void _retire(GstMprtpsender *this, gpointer item)
+{
+  g_atomic_pointer_set(&this->retired, g_slist_prepend(this->retired, item));
+}
+
+//Must be called under the write lock
+static void _reclaim_retired(GstMprtpsender *this)
+{
+  if(!this->retired || 0 < g_atomic_int_get(&this->readers)){
+    return;
+  }
+  g_slist_free_full(this->retired, g_free);
+  g_atomic_pointer_set(&this->retired, NULL);
+}
+
+//Must be called under the write lock
+static void _publish_subflows(GstMprtpsender *this, SubflowsTable *subflows)
+{
+  _retire(this, _get_subflows(this));
+  g_atomic_pointer_set(&this->subflows, subflows);
+  _reclaim_retired(this);
+}
+
+//The last reader leaving frees what the writers could not, unless a writer is just working
+static void _leave_subflows(GstMprtpsender *this)
+{
+  if(!g_atomic_int_dec_and_test(&this->readers) || !g_atomic_pointer_get(&this->retired)){
+    return;
+  }
+  if(g_rw_lock_writer_trylock(&this->rwmutex)){
+    _reclaim_retired(this);
+    THIS_WRITEUNLOCK(this);
   }
 }
 
@@ -286,12 +355,24 @@ gst_mprtpsender_class_init (GstMprtpsenderClass * klass)
           "Set or get the payload type of fec packets. The default is 126",
           0, 127, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_FEC_RS_PAYLOAD_TYPE,
+      g_param_spec_uint ("fec-rs-payload-type",
+          "Set or get the payload type of Reed-Solomon fec packets",
+          "Set or get the payload type of Reed-Solomon fec packets. The default is 125",
+          0, 127, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_property (gobject_class, PROP_ASYNC_FEC,
       g_param_spec_boolean ("async-fec",
           "Indicate weather the FEC packet is sent on async outpad if that linked.",
           "Indicate weather the FEC packet is sent on async outpad if that linked.",
           TRUE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_LATENCY_STATS,
+      g_param_spec_boxed ("latency-stats",
+          "Latency statistics of the hot path",
+          "Count, p50, p90, p99, p999 and max in nanoseconds of mprtp-chain and mprtcp-chain",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
 }
 
 
@@ -324,6 +405,8 @@ gst_mprtpsender_init (GstMprtpsender * mprtpsender)
       "mprtp_sink");
   gst_pad_set_chain_function (mprtpsender->mprtp_sinkpad,
       GST_DEBUG_FUNCPTR (gst_mprtpsender_mprtp_sink_chain));
+  gst_pad_set_chain_list_function (mprtpsender->mprtp_sinkpad,
+      GST_DEBUG_FUNCPTR (gst_mprtpsender_mprtp_sink_chain_list));
   gst_pad_set_event_function (mprtpsender->mprtp_sinkpad,
       GST_DEBUG_FUNCPTR (gst_mprtpsender_mprtp_sink_event_handler));
   gst_pad_set_query_function (mprtpsender->mprtp_sinkpad,
@@ -331,6 +414,8 @@ gst_mprtpsender_init (GstMprtpsender * mprtpsender)
   //GST_OBJECT_FLAG_SET (mprtpsender->mprtp_sinkpad, GST_PAD_FLAG_PROXY_CAPS);
 
   mprtpsender->sysclock = gst_system_clock_obtain();
+  mprtpsender->mprtp_chain_latency  = latencyhist_ctor("mprtp-chain");
+  mprtpsender->mprtcp_chain_latency = latencyhist_ctor("mprtcp-chain");
 
   gst_element_add_pad (GST_ELEMENT (mprtpsender), mprtpsender->mprtp_sinkpad);
 
@@ -344,7 +429,9 @@ gst_mprtpsender_init (GstMprtpsender * mprtpsender)
   mprtpsender->event_caps          = NULL;
   mprtpsender->event_stream_start  = NULL;
   mprtpsender->fec_payload_type    = FEC_PAYLOAD_DEFAULT_ID;
+  mprtpsender->fec_rs_payload_type = FEC_RS_PAYLOAD_DEFAULT_ID;
   mprtpsender->async_fec           = FALSE;
+  mprtpsender->subflows            = g_new0 (SubflowsTable, 1);
 
   //mprtpsender->events = g_queue_new();
   g_rw_lock_init (&mprtpsender->rwmutex);
@@ -376,6 +463,9 @@ gst_mprtpsender_set_property (GObject * object, guint property_id,
     case PROP_FEC_PAYLOAD_TYPE:
       this->fec_payload_type = (guint8) g_value_get_uint (value);
       break;
+    case PROP_FEC_RS_PAYLOAD_TYPE:
+      this->fec_rs_payload_type = (guint8) g_value_get_uint (value);
+      break;
     case PROP_ASYNC_FEC:
       this->async_fec = g_value_get_boolean (value);
       break;
@@ -402,9 +492,20 @@ gst_mprtpsender_get_property (GObject * object, guint property_id,
     case PROP_FEC_PAYLOAD_TYPE:
      g_value_set_uint (value, (guint) this->fec_payload_type);
      break;
+    case PROP_FEC_RS_PAYLOAD_TYPE:
+     g_value_set_uint (value, (guint) this->fec_rs_payload_type);
+     break;
     case PROP_ASYNC_FEC:
       g_value_set_boolean (value, this->async_fec);
       break;
+    case PROP_LATENCY_STATS:
+      {
+        GstStructure* stats = gst_structure_new_empty("mprtpsender-latency-stats");
+        latencyhist_append_to_structure(this->mprtp_chain_latency, stats);
+        latencyhist_append_to_structure(this->mprtcp_chain_latency, stats);
+        g_value_take_boxed (value, stats);
+      }
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -428,10 +529,19 @@ void
 gst_mprtpsender_finalize (GObject * object)
 {
   GstMprtpsender *mprtpsender = GST_MPRTPSENDER (object);
+  SubflowsTable *subflows = _get_subflows(mprtpsender);
+  gint i;
 
   GST_DEBUG_OBJECT (mprtpsender, "finalize");
 
+  for(i = 0; i < subflows->items_num; ++i){
+    g_free(subflows->items[i]);
+  }
+  g_free(subflows);
+  g_slist_free_full(mprtpsender->retired, g_free);
   g_object_unref(mprtpsender->sysclock);
+  latencyhist_dtor(mprtpsender->mprtp_chain_latency);
+  latencyhist_dtor(mprtpsender->mprtcp_chain_latency);
   /* clean up object here */
   G_OBJECT_CLASS (gst_mprtpsender_parent_class)->finalize (object);
 }
@@ -494,7 +604,7 @@ gst_mprtpsender_request_new_pad (GstElement * element, GstPadTemplate * templ,
   guint8 subflow_id;
   Subflow *subflow = NULL;
   gboolean async = FALSE;
-  GList *it;
+  SubflowsTable *subflows = NULL;
 
   this = GST_MPRTPSENDER (element);
   GST_DEBUG_OBJECT (this, "requesting pad");
@@ -507,18 +617,14 @@ gst_mprtpsender_request_new_pad (GstElement * element, GstPadTemplate * templ,
   }
   THIS_WRITELOCK (this);
 
-  for(it = this->subflows; it; it = it->next){
-    subflow = it->data;
-    if(subflow->id == subflow_id) break;
-    subflow = NULL;
-  }
-
+  subflow = _get_subflows(this)->lookup[subflow_id];
   if(!subflow) {
       subflow = (Subflow *) g_malloc0 (sizeof (Subflow));
       subflow->id           = subflow_id;
       subflow->mprtcp_outpad = subflow->outpad = NULL;
-      this->subflows        = g_list_prepend (this->subflows, subflow);
-      this->subflows_lookup[subflow_id] = subflow;
+      subflows              = _copy_subflows(this);
+      subflows->lookup[subflow_id] = subflow;
+      subflows->items[subflows->items_num++] = subflow;
   }
 
   srcpad = gst_pad_new_from_template (templ, name);
@@ -540,6 +646,10 @@ gst_mprtpsender_request_new_pad (GstElement * element, GstPadTemplate * templ,
   }else{
     subflow->mprtcp_outpad = srcpad;
   }
+  //a new subflow is published with its pad already set
+  if(subflows){
+    _publish_subflows(this, subflows);
+  }
   THIS_WRITEUNLOCK (this);
   GST_OBJECT_FLAG_SET (srcpad, GST_PAD_FLAG_PROXY_CAPS);
 
@@ -586,6 +696,13 @@ gst_mprtpsender_change_state (GstElement * element, GstStateChange transition)
     case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      {
+        //streaming is stopped, nothing left behind can be in use
+        GstMprtpsender *this = GST_MPRTPSENDER (element);
+        THIS_WRITELOCK (this);
+        _reclaim_retired (this);
+        THIS_WRITEUNLOCK (this);
+      }
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
       break;
@@ -653,16 +770,18 @@ static GstPadLinkReturn
 gst_mprtpsender_src_link (GstPad * pad, GstObject * parent, GstPad * peer)
 {
   GstMprtpsender *this;
-  GList *it;
+  SubflowsTable *subflows;
   Subflow *subflow;
   GstPadLinkReturn result = GST_PAD_LINK_OK;
+  gint i;
 
   this = GST_MPRTPSENDER (parent);
   GST_DEBUG_OBJECT (this, "link");
   THIS_READLOCK (this);
 
-  for (subflow = NULL, it = this->subflows; it != NULL; it = it->next) {
-    subflow = it->data;
+  subflows = _get_subflows(this);
+  for (subflow = NULL, i = 0; i < subflows->items_num; ++i) {
+    subflow = subflows->items[i];
     if (subflow->outpad == pad) {
       break;
     }
@@ -691,15 +810,17 @@ static void
 gst_mprtpsender_src_unlink (GstPad * pad, GstObject * parent)
 {
   GstMprtpsender *mprtpsender;
-  GList *it;
+  SubflowsTable *subflows;
   Subflow *subflow;
+  gint i;
 
   mprtpsender = GST_MPRTPSENDER (parent);
   GST_DEBUG_OBJECT (mprtpsender, "unlink");
   THIS_WRITELOCK (mprtpsender);
 
-  for (subflow = NULL, it = mprtpsender->subflows; it != NULL; it = it->next) {
-    subflow = it->data;
+  subflows = _get_subflows(mprtpsender);
+  for (subflow = NULL, i = 0; i < subflows->items_num; ++i) {
+    subflow = subflows->items[i];
     if (subflow->outpad == pad) {
       break;
     }
@@ -709,9 +830,11 @@ gst_mprtpsender_src_unlink (GstPad * pad, GstObject * parent)
     goto done;
   }
 
-  mprtpsender->subflows_lookup[subflow->id] = NULL;
-  mprtpsender->subflows = g_list_remove (mprtpsender->subflows, subflow);
-  g_free(subflow);
+  subflows = _copy_subflows(mprtpsender);
+  subflows->lookup[subflow->id] = NULL;
+  subflows->items[i] = subflows->items[--subflows->items_num];
+  _retire(mprtpsender, subflow);
+  _publish_subflows(mprtpsender, subflows);
 
 done:
   THIS_WRITEUNLOCK (mprtpsender);
@@ -725,73 +848,49 @@ typedef enum
   PACKET_IS_NOT_MP,
 } PacketTypes;
 
+//Peeks into the beginning of the packet instead of mapping it
 static PacketTypes
 _get_packet_mptype (GstMprtpsender * this,
-    GstBuffer * buf, GstMapInfo * info, guint8 * subflow_id)
+    GstBuffer * buf, guint8 * subflow_id)
 {
-
-  guint8 first_byte, second_byte;
+  guint8 data[MPRTP_PEEK_HEADER_LENGTH];
+  const guint8 *mprtp_ext;
+  guint8 payload_type;
+  gsize size;
   PacketTypes result = PACKET_IS_NOT_MP;
-  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
-  MPRTPSubflowHeaderExtension *subflow_infos = NULL;
-  guint size;
-  gpointer pointer;
 
-  if (gst_buffer_extract (buf, 0, &first_byte, 1) != 1 ||
-      gst_buffer_extract (buf, 1, &second_byte, 1) != 1) {
+  size = gst_buffer_extract (buf, 0, data, sizeof (data));
+  if (size < 2) {
     GST_WARNING_OBJECT (this, "could not extract first byte from buffer");
     goto done;
   }
-  if (PACKET_IS_DTLS (first_byte)) {
+  if (PACKET_IS_DTLS (data[0]) || !PACKET_IS_RTP_OR_RTCP (data[0])) {
     goto done;
   }
 
-  if (PACKET_IS_RTP_OR_RTCP (first_byte)) {
-    if (PACKET_IS_RTCP (second_byte)) {
-      if (second_byte != MPRTCP_PACKET_TYPE_IDENTIFIER) {
-        goto done;
-      }
-      if (subflow_id) {
-        *subflow_id = (guint8)
-            g_ntohs (*((guint16 *) (info->data + 8 /*RTCP Header */  +
-                    6 /*first block info until subflow id */ )));
-      }
-      result = PACKET_IS_MPRTCP;
-      goto done;
-    }
-
-    if (G_UNLIKELY (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp))) {
-      GST_WARNING_OBJECT (this, "The RTP packet is not readable");
+  if (PACKET_IS_RTCP (data[1])) {
+    if (data[1] != MPRTCP_PACKET_TYPE_IDENTIFIER || size < 16) {
       goto done;
     }
-
-    if (!gst_rtp_buffer_get_extension (&rtp)) {
-      gst_rtp_buffer_unmap (&rtp);
-      goto done;
-    }
-    if (!gst_rtp_buffer_get_extension_onebyte_header (&rtp,
-            this->mprtp_ext_header_id, 0, &pointer, &size)) {
-      gst_rtp_buffer_unmap (&rtp);
-      goto done;
-    }
-
-    if (subflow_id) {
-      subflow_infos = (MPRTPSubflowHeaderExtension *) pointer;
-      *subflow_id = subflow_infos->id;
-
-      //SRTP validation - it must be fail
-//      gst_rtp_buffer_add_extension_onebyte_header (&rtp, 2,
-//            (gpointer) subflow_infos, sizeof (*subflow_infos));
-    }
-    if(gst_rtp_buffer_get_payload_type(&rtp) == this->fec_payload_type){
-      result = PACKET_IS_MPRTP_FEC;
-    }else{
-      result = PACKET_IS_MPRTP_SYNC;
-    }
-    gst_rtp_buffer_unmap (&rtp);
+    *subflow_id = (guint8) GST_READ_UINT16_BE (data + 8 /*RTCP Header */  +
+        6 /*first block info until subflow id */ );
+    result = PACKET_IS_MPRTCP;
     goto done;
   }
 
+  mprtp_ext = mprtp_peek_onebyte_extension (data, size, this->mprtp_ext_header_id);
+  if (!mprtp_ext) {
+    goto done;
+  }
+  //the subflow id is the first field of MPRTPSubflowHeaderExtension
+  *subflow_id = mprtp_ext[0];
+  payload_type = data[1] & 0x7f;
+  if(payload_type == this->fec_payload_type ||
+     payload_type == this->fec_rs_payload_type){
+    result = PACKET_IS_MPRTP_FEC;
+  }else{
+    result = PACKET_IS_MPRTP_SYNC;
+  }
 
 done:
   return result;
@@ -799,13 +898,14 @@ done:
 
 static void _init_all_subflows(GstMprtpsender *this, GstBuffer *buf)
 {
-  GList *it;
+  SubflowsTable *subflows = _get_subflows(this);
   Subflow *subflow;
-  for(it = this->subflows; it; it = it->next)
+  gint i;
+  for(i = 0; i < subflows->items_num; ++i)
   {
     GstSegment *seg;
     GstEvent *ev;
-    subflow = it->data;
+    subflow = subflows->items[i];
     if(subflow->initialized) continue;
     subflow->initialized = TRUE;
     seg = &this->segment;
@@ -847,68 +947,41 @@ static void _init_all_subflows(GstMprtpsender *this, GstBuffer *buf)
   return;
 }
 
-static GstFlowReturn
-gst_mprtpsender_mprtp_sink_chain (GstPad * pad, GstObject * parent,
-    GstBuffer * buf)
+static GstPad *
+_select_outpad (GstMprtpsender * this, SubflowsTable * subflows, GstBuffer * buf)
 {
-  GstMprtpsender *this;
-  GstFlowReturn result;
-  GstMapInfo map;
   PacketTypes packet_type;
   guint8 subflow_id;
-  Subflow *subflow;
-  gint n, r;
-  GstPad *outpad;
-  GstClockTime position, duration;
-
-  this = GST_MPRTPSENDER (parent);
-//PROFILING("gst_mprtpsender_mprtp_sink_chain",
-  GST_DEBUG_OBJECT (this, "RTP/MPRTP/OTHER sink");
-  if (!gst_buffer_map (buf, &map, GST_MAP_READ)) {
-    GST_ERROR_OBJECT (this, "Buffer is not readable");
-    result = GST_FLOW_CUSTOM_ERROR;
-    goto exit;
-  }
-PROFILING("gst_mprtpsender_mprtp_sink_chain",
-  THIS_READLOCK (this);
-  if(this->dirty) {
-    if(0) _init_all_subflows(this, buf);
-    this->dirty = FALSE;
-  }
+  Subflow *subflow = NULL;
+  GstPad *pivot_outpad = this->pivot_outpad;
 
-  n = g_list_length (this->subflows);
-  if (n < 1) {
-    GST_ERROR_OBJECT (this, "No appropiate subflow");
-    gst_buffer_unmap (buf, &map);
-    result = GST_FLOW_CUSTOM_ERROR;
-    goto done;
+  packet_type = _get_packet_mptype (this, buf, &subflow_id);
+  if (packet_type != PACKET_IS_NOT_MP) {
+    subflow = subflows->lookup[subflow_id];
   }
-  packet_type = _get_packet_mptype (this, buf, &map, &subflow_id);
 
-  if (packet_type != PACKET_IS_NOT_MP && _select_subflow (this, subflow_id, &subflow) != FALSE) {
+  if (subflow) {
     if(packet_type == PACKET_IS_MPRTCP){
-      outpad = subflow->mprtcp_outpad ? subflow->mprtcp_outpad : subflow->outpad;
+      return subflow->mprtcp_outpad ? subflow->mprtcp_outpad : subflow->outpad;
     }else if(packet_type == PACKET_IS_MPRTP_FEC){
-      outpad = this->async_fec && subflow->mprtcp_outpad ? subflow->mprtcp_outpad : subflow->outpad;
-    }else{
-      outpad = subflow->outpad;
-    }
-  } else if (this->pivot_outpad != NULL &&
-      gst_pad_is_active (this->pivot_outpad) &&
-      gst_pad_is_linked (this->pivot_outpad)) {
-    outpad = this->pivot_outpad;
-  } else {
-    if (n > 1) {
-      r = g_random_int_range (0, n);
-      subflow = g_list_nth (this->subflows, r)->data;
-      outpad = subflow->outpad;
-    } else {
-      subflow = this->subflows->data;
-      outpad = subflow->outpad;
+      return this->async_fec && subflow->mprtcp_outpad ? subflow->mprtcp_outpad : subflow->outpad;
     }
+    return subflow->outpad;
+  }
+  if (pivot_outpad != NULL &&
+      gst_pad_is_active (pivot_outpad) &&
+      gst_pad_is_linked (pivot_outpad)) {
+    return pivot_outpad;
   }
-  gst_buffer_unmap (buf, &map);
+  //Other packets are spread over the subflows in turn
+  subflow = subflows->items[(guint) g_atomic_int_add (&this->fallback_counter, 1) % subflows->items_num];
+  return subflow->outpad;
+}
 
+static void
+_refresh_position (GstMprtpsender * this, GstBuffer * buf)
+{
+  GstClockTime position, duration;
   /* Keep track of last stop and use it in SEGMENT start after
      switching to a new src pad */
   position = GST_BUFFER_TIMESTAMP (buf);
@@ -921,6 +994,37 @@ PROFILING("gst_mprtpsender_mprtp_sink_chain",
         GST_TIME_ARGS (position));
     this->segment.position = position;
   }
+}
+
+static GstFlowReturn
+gst_mprtpsender_mprtp_sink_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buf)
+{
+  GstMprtpsender *this;
+  GstFlowReturn result;
+  SubflowsTable *subflows;
+  GstPad *outpad;
+  guint64 start;
+
+  this = GST_MPRTPSENDER (parent);
+//PROFILING("gst_mprtpsender_mprtp_sink_chain",
+  GST_DEBUG_OBJECT (this, "RTP/MPRTP/OTHER sink");
+  _enter_subflows(this);
+  LATENCYHIST_BEGIN(start);
+  subflows = _get_subflows(this);
+  if(this->dirty) {
+    if(0) _init_all_subflows(this, buf);
+    this->dirty = FALSE;
+  }
+
+  if (subflows->items_num < 1) {
+    GST_ERROR_OBJECT (this, "No appropiate subflow");
+    gst_buffer_unref (buf);
+    result = GST_FLOW_CUSTOM_ERROR;
+    goto done;
+  }
+  outpad = _select_outpad (this, subflows, buf);
+  _refresh_position (this, buf);
 
 //  g_print("refcount: %d\n", buf->mini_object.refcount);
 //  gst_buffer_ref(buf);
@@ -928,13 +1032,77 @@ PROFILING("gst_mprtpsender_mprtp_sink_chain",
 
 
 done:
-  THIS_READUNLOCK (this);
-);
-exit:
+  LATENCYHIST_END(this->mprtp_chain_latency, start);
+  _leave_subflows(this);
   return result;
 
 }
 
+typedef struct
+{
+  GstPad        *outpad;
+  GstBufferList *buffers;
+} OutpadBuffers;
+
+//Splits the list by the outpads the buffers are routed to
+//and pushes the sublists, buffers keep their order on every outpad.
+static GstFlowReturn
+gst_mprtpsender_mprtp_sink_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstMprtpsender *this;
+  GstFlowReturn result = GST_FLOW_OK, flow;
+  SubflowsTable *subflows;
+  OutpadBuffers groups[MPRTPSENDER_OUTPADS_MAX_NUM];
+  GstBuffer *buf;
+  GstPad *outpad;
+  guint i, j, length, groups_num = 0;
+  guint64 start;
+
+  this = GST_MPRTPSENDER (parent);
+  GST_DEBUG_OBJECT (this, "RTP/MPRTP/OTHER sink list");
+  _enter_subflows(this);
+  LATENCYHIST_BEGIN(start);
+  subflows = _get_subflows(this);
+  if (subflows->items_num < 1) {
+    GST_ERROR_OBJECT (this, "No appropiate subflow");
+    gst_buffer_list_unref (list);
+    result = GST_FLOW_CUSTOM_ERROR;
+    goto done;
+  }
+
+  length = gst_buffer_list_length (list);
+  for (i = 0; i < length; ++i) {
+    buf = gst_buffer_list_get (list, i);
+    outpad = _select_outpad (this, subflows, buf);
+    _refresh_position (this, buf);
+    for (j = 0; j < groups_num; ++j) {
+      if (groups[j].outpad == outpad) {
+        break;
+      }
+    }
+    if (j == groups_num) {
+      groups[j].outpad  = outpad;
+      groups[j].buffers = gst_buffer_list_new_sized (length - i);
+      ++groups_num;
+    }
+    gst_buffer_list_add (groups[j].buffers, gst_buffer_ref (buf));
+  }
+  gst_buffer_list_unref (list);
+
+  for (j = 0; j < groups_num; ++j) {
+    flow = gst_pad_push_list (groups[j].outpad, groups[j].buffers);
+    if (result == GST_FLOW_OK) {
+      result = flow;
+    }
+  }
+
+done:
+  LATENCYHIST_END(this->mprtp_chain_latency, start);
+  _leave_subflows(this);
+  return result;
+}
+
 
 static GstFlowReturn
 gst_mprtpsender_mprtcp_sink_chain (GstPad * pad, GstObject * parent,
@@ -943,9 +1111,10 @@ gst_mprtpsender_mprtcp_sink_chain (GstPad * pad, GstObject * parent,
   GstMprtpsender *this;
   GstFlowReturn result = GST_FLOW_OK;
   Subflow *subflow = NULL;
+  guint64 start;
   this = GST_MPRTPSENDER (parent);
-PROFILING("gst_mprtpsender_mprtcp_sink_chain",
-  THIS_READLOCK (this);
+  _enter_subflows(this);
+  LATENCYHIST_BEGIN(start);
   DISABLE_LINE subflow = _get_subflow_from_blocks (this, buf);
   subflow = _get_subflow_from_report(this, buf);
   if (!subflow) {
@@ -965,8 +1134,8 @@ PROFILING("gst_mprtpsender_mprtcp_sink_chain",
   }
 
 done:
-  THIS_READUNLOCK (this);
-);
+  LATENCYHIST_END(this->mprtcp_chain_latency, start);
+  _leave_subflows(this);
   return result;
 }
 
@@ -1021,10 +1190,11 @@ _select_subflow (GstMprtpsender * this, guint8 id, Subflow ** result)
 {
 //  GList *it;
 //  Subflow *subflow;
-  if(this->subflows_lookup[id] == NULL){
+  Subflow *subflow = _get_subflows(this)->lookup[id];
+  if(subflow == NULL){
     return FALSE;
   }
-  *result = this->subflows_lookup[id];
+  *result = subflow;
   return TRUE;
 
 //  for (it = this->subflows; it != NULL; it = it->next) {
@@ -21,6 +21,7 @@
 #define _GST_MPRTPSENDER_H_
 
 #include <gst/gst.h>
+#include "lib_latencyhist.h"
 
 G_BEGIN_DECLS
 #define GST_TYPE_MPRTPSENDER   (gst_mprtpsender_get_type())
@@ -40,9 +41,14 @@ struct _GstMprtpsender
   GRWLock       rwmutex;
   guint8        mprtp_ext_header_id;
   guint8        fec_payload_type;
+  guint8        fec_rs_payload_type;
   gboolean      async_fec;
-  GList*        subflows;
-  gpointer      subflows_lookup[256];
+  //the subflows are in a table replaced as a whole when a pad is requested or unlinked,
+  //so the chain functions read it without lock
+  gpointer      subflows;
+  GSList*       retired;      ///< replaced tables and removed subflows a reader may still use
+  volatile gint readers;      ///< chain functions inside a lock-free read of the subflows
+  volatile gint fallback_counter;
   gboolean      dirty;
   GstSegment    segment;
   GstPad*       mprtcp_rr_sinkpad;
@@ -54,6 +60,8 @@ struct _GstMprtpsender
   GstEvent*     event_segment;
   GstEvent*     event_caps;
 
+  latencyhist_t* mprtp_chain_latency;
+  latencyhist_t* mprtcp_chain_latency;
 
   GstMprtpsenderPrivate *priv;
 };
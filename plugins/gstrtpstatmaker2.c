@@ -50,6 +50,8 @@ enum
 
 #define DEFAULT_DUMP                    FALSE
 #define DEFAULT_SYNC                    FALSE
+//Items the shared memory ring holds, ~2MB of packets
+#define DEFAULT_SHM_RING_LENGTH         65536
 
 enum
 {
@@ -57,7 +59,10 @@ enum
   PROP_SYNC,
   PROP_MPRTP_EXT_HEADER_ID,
   PROP_FEC_PAYLOAD_TYPE,
-  PROP_DEFAULT_MKFIFO_LOCATION
+  PROP_FEC_RS_PAYLOAD_TYPE,
+  PROP_DEFAULT_MKFIFO_LOCATION,
+  PROP_SHM_LOCATION,
+  PROP_SHM_DROPPED,
 };
 
 
@@ -106,6 +111,7 @@ gst_rtpstatmaker2_finalize (GObject * object)
   if (this->fifofd) {
     close(this->fifofd);
   }
+  shmring_dtor(this->statring);
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -157,6 +163,21 @@ gst_rtpstatmaker2_class_init (GstRTPStatMaker2Class * klass)
             "NULL", G_PARAM_WRITABLE | G_PARAM_STATIC_STRINGS)
   );
 
+  g_object_class_install_property (gobject_class, PROP_SHM_LOCATION,
+      g_param_spec_string ("shm-location",
+            "Name of the shared memory ring the packets are pushed into",
+            "Name of the shared memory object (/dev/shm/<name>) the packet statistics are pushed into instead of the mkfifo. "
+            "Packets are dropped if the reader does not keep up, the media path is never blocked.",
+            "NULL", G_PARAM_WRITABLE | GST_PARAM_MUTABLE_READY | G_PARAM_STATIC_STRINGS)
+  );
+
+  g_object_class_install_property (gobject_class, PROP_SHM_DROPPED,
+      g_param_spec_uint64 ("shm-dropped",
+            "Number of packets dropped on the shared memory ring",
+            "Number of packets could not be pushed into the shared memory ring because it was full",
+            0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)
+  );
+
   g_object_class_install_property (gobject_class, PROP_MPRTP_EXT_HEADER_ID,
       g_param_spec_uint ("mprtp-ext-header-id",
                "Setup the mprtp extension header id",
@@ -171,6 +192,13 @@ gst_rtpstatmaker2_class_init (GstRTPStatMaker2Class * klass)
                 0, 128, 0, G_PARAM_WRITABLE | G_PARAM_STATIC_STRINGS)
   );
 
+  g_object_class_install_property (gobject_class, PROP_FEC_RS_PAYLOAD_TYPE,
+      g_param_spec_uint ("fec-rs-payload-type",
+               "Setup the Reed-Solomon fec payload type",
+               "Setup the Reed-Solomon fec payload type",
+                0, 128, 0, G_PARAM_WRITABLE | G_PARAM_STATIC_STRINGS)
+  );
+
 }
 
 static void
@@ -194,6 +222,7 @@ gst_rtpstatmaker2_init (GstRTPStatMaker2 * this)
   this->packets4process = g_queue_new();
   this->packets4recycle = g_queue_new();
   this->fec_payload_type = FEC_PAYLOAD_DEFAULT_ID;
+  this->fec_rs_payload_type = FEC_RS_PAYLOAD_DEFAULT_ID;
 }
 
 
@@ -203,6 +232,7 @@ gst_rtpstatmaker2_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
 {
   GstRTPStatMaker2 *this;
+  GstState state;
 
   this = GST_RTPSTATMAKER2 (object);
 
@@ -216,6 +246,9 @@ gst_rtpstatmaker2_set_property (GObject * object, guint prop_id,
     case PROP_FEC_PAYLOAD_TYPE:
       this->fec_payload_type = g_value_get_uint(value);
       break;
+    case PROP_FEC_RS_PAYLOAD_TYPE:
+      this->fec_rs_payload_type = g_value_get_uint(value);
+      break;
     case PROP_DEFAULT_MKFIFO_LOCATION:
       strcpy(this->path, g_value_get_string(value));
 //      g_print("mkfifo location:%s\n", this->path);
@@ -224,6 +257,22 @@ gst_rtpstatmaker2_set_property (GObject * object, guint prop_id,
       }
       this->fifofd = open(this->path, O_WRONLY);
       break;
+    case PROP_SHM_LOCATION:
+      //the streaming thread pushes into the ring without locking
+      GST_OBJECT_LOCK (this);
+      state = GST_STATE (this);
+      GST_OBJECT_UNLOCK (this);
+      if (state > GST_STATE_READY) {
+        GST_WARNING_OBJECT(this, "shm-location can only be changed in NULL or READY state");
+        break;
+      }
+      shmring_dtor(this->statring);
+      this->statring = NULL;
+      //NULL switches the ring off
+      if (g_value_get_string(value)) {
+        this->statring = shmring_ctor(g_value_get_string(value), sizeof(RTPStatPacket), DEFAULT_SHM_RING_LENGTH);
+      }
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -244,6 +293,9 @@ gst_rtpstatmaker2_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_SYNC:
       g_value_set_boolean (value, rtpstatmaker2->sync);
       break;
+    case PROP_SHM_DROPPED:
+      g_value_set_uint64 (value, rtpstatmaker2->statring ? shmring_get_dropped(rtpstatmaker2->statring) : 0);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -329,7 +381,8 @@ static void _init_packet(GstRTPStatMaker2 *this, RTPStatPacket* packet, GstBuffe
     gst_rtp_buffer_get_mprtp_extension(&rtp, this->mprtp_ext_header_id, &packet->subflow_id, &packet->subflow_seq);
   }
 
-  if(0 < this->fec_payload_type && packet->payload_type == this->fec_payload_type){
+  if((0 < this->fec_payload_type && packet->payload_type == this->fec_payload_type) ||
+     (0 < this->fec_rs_payload_type && packet->payload_type == this->fec_rs_payload_type)){
     GstRTPFECHeader fec_header;
     memcpy(&fec_header, gst_rtp_buffer_get_payload(&rtp), sizeof(GstRTPFECHeader));
     packet->protect_begin = g_ntohs(fec_header.sn_base);
@@ -380,7 +433,9 @@ _monitor_rtp_packet (GstRTPStatMaker2 *this, GstBuffer * buffer)
 
   PROFILING("gstrtpstatmaker",
   _init_packet(this, &packet, buffer);
-  if (write(this->fifofd, &packet, sizeof(RTPStatPacket)) < 0) {
+  if (this->statring) {
+    shmring_push(this->statring, &packet);
+  } else if (write(this->fifofd, &packet, sizeof(RTPStatPacket)) < 0) {
 
   } else {
 
@@ -30,6 +30,7 @@
 #include "mprtputils.h"
 #include "messenger.h"
 #include "rtpfecbuffer.h"
+#include "lib_shmring.h"
 
 G_BEGIN_DECLS
 
@@ -71,9 +72,11 @@ struct _GstRTPStatMaker2 {
   Messenger*                    packets;
   guint8                        mprtp_ext_header_id;
   guint8                        fec_payload_type;
+  guint8                        fec_rs_payload_type;
 
   gchar                         path[256];
   gint                          fifofd;
+  shmring_t*                    statring;
 
   guint64                       offset;
   GstClockTime                  upstream_latency;
@@ -37,19 +37,7 @@ GST_DEBUG_CATEGORY_STATIC (jitterbuffer_debug_category);
 
 G_DEFINE_TYPE (JitterBuffer, jitterbuffer, G_TYPE_OBJECT);
 
-typedef struct{
-  guint32      timestamp;
-  guint32      created_in_ts;
-  GSList*      packets;
-}Frame;
-
-typedef struct {
-  gint64 value;
-  guint8 subflow_id;
-}Skew;
-
-DEFINE_RECYCLE_TYPE(static, frame, Frame);
-DEFINE_RECYCLE_TYPE(static, skew, Skew);
+TYPEDSW_DEFINE(static, skew, Skew);
 
 static gint
 _cmp_ts (guint32 x, guint32 y)
@@ -85,28 +73,6 @@ static gint _cmp_skew(Skew* a, Skew* b) {
   return a->value < b->value ? -1 : b->value < a->value ? 1 : 0;
 }
 
-static gint _packets_cmp(RcvPacket* first, RcvPacket* second)
-{
-  //It should return 0 if the elements are equal,
-  //a negative value if the first element comes
-  //before the second, and a positive value
-  //if the second element comes before the first.
-
-  return _cmp_seq(first->abs_seq, second->abs_seq);
-}
-
-static gint _frames_data_cmp(Frame* first, Frame* second, gpointer udata)
-{
-  if (first->packets != NULL && second->packets != NULL) {
-    return _packets_cmp(first->packets->data, second->packets->data);
-  }
-  return _cmp_ts(first->timestamp, second->timestamp);
-}
-
-static void _skew_shaper(Skew* to, Skew* from) {
-  to->subflow_id = from->subflow_id;
-  to->value = from->value;
-}
 
 //----------------------------------------------------------------------
 //-------- Private functions belongs to JitterBuffer object ----------
@@ -116,9 +82,8 @@ static void
 jitterbuffer_finalize (
     GObject * object);
 
-static Frame* _make_frame(JitterBuffer* this, RcvPacket* packet);
-static void _dispose_frame(JitterBuffer* this, Frame* frame);
 static void _refresh_playout_delay(JitterBuffer* this);
+static GstClockTime _get_sending_interval(JitterBuffer* this, RcvFrame* frame);
 
 //----------------------------------------------------------------------
 //--------- Private functions implementations to JitterBuffer object --------
@@ -146,6 +111,8 @@ jitterbuffer_finalize (GObject * object)
     rcvpacket_unref(packet);
   }
   g_queue_free(this->playoutq);
+  g_object_unref(this->frames);
+  typedsw_skew_dtor(this->skews);
   g_object_unref(this->sysclock);
 
 }
@@ -162,15 +129,13 @@ make_jitterbuffer(TimestampGenerator* rtp_ts_generator)
 {
   JitterBuffer *result;
   result = (JitterBuffer *) g_object_new (JITTERBUFFER_TYPE, NULL);
-  result->frames = NULL;
-  result->frames_recycle = make_recycle_frame(50, NULL);
+  result->frames = make_rcvframes();
   result->rtp_ts_generator = g_object_ref(rtp_ts_generator);
 //  result->playout_history = make_slidingwindow_double(200, 2 * GST_SECOND);
   result->playoutq   = g_queue_new();
   result->discardedq = g_queue_new();
   result->initial_buffer_time = 500 * GST_MSECOND; // The default buffer time for the jitterbuffer
-  result->skews_recycle = make_recycle_skew(50, (RecycleItemShaper)_skew_shaper);
-  result->skews = make_slidingwindow_with_data_recycle(500, 2 * GST_SECOND, result->skews_recycle);
+  result->skews = typedsw_skew_ctor(500, 2 * GST_SECOND);
   result->subflows = g_malloc(sizeof(JitterBufferSubflow) * MPRTP_PLUGIN_MAX_SUBFLOW_NUM);
   memset(result->subflows, 0, sizeof(JitterBufferSubflow) * MPRTP_PLUGIN_MAX_SUBFLOW_NUM);
 
@@ -229,13 +194,13 @@ void jitterbuffer_on_subflow_joined(JitterBuffer* this, RcvSubflow* subflow) {
       &subflow->id
   );
 
-  slidingwindow_add_plugin(this->skews, jitter_buffer_subflow->percentile_tracker);
+  typedsw_add_plugin(TYPEDSW(this->skews), jitter_buffer_subflow->percentile_tracker);
 //  g_print("I joined subflow %d for jitterbuffer\n", subflow->id);
 }
 
 void jitterbuffer_on_subflow_detached(JitterBuffer* this, RcvSubflow* subflow) {
   JitterBufferSubflow* jitter_buffer_subflow = this->subflows + subflow->id;
-  slidingwindow_rem_plugin(this->skews, jitter_buffer_subflow->percentile_tracker);
+  typedsw_rem_plugin(TYPEDSW(this->skews), jitter_buffer_subflow->percentile_tracker);
   jitter_buffer_subflow->active = FALSE;
 //  g_print("I detached subflow %d from jitterbuffer\n", subflow->id);
 }
@@ -261,8 +226,6 @@ RcvPacket* jitterbuffer_pop_discarded_packet(JitterBuffer* this) {
 
 void jitterbuffer_push_packet(JitterBuffer *this, RcvPacket* packet)
 {
-  Frame* frame = NULL;
-  GList* it;
   if (!packet) {
     return;
   }
@@ -296,22 +259,8 @@ void jitterbuffer_push_packet(JitterBuffer *this, RcvPacket* packet)
 
   }
 
-  // because it seems g_list_find_custom does not work?????
-  for (it = this->frames; it; it = it->next) {
-    Frame* actual = it->data;
-    if (actual->timestamp == packet->snd_rtp_ts) {
-      frame = actual;
-      break;
-    }
-  }
-
   packet = rcvpacket_ref(packet);
-  if(!frame) {
-    frame = _make_frame(this, packet);
-    this->frames = g_list_insert_sorted_with_data(this->frames, frame, (GCompareDataFunc) _frames_data_cmp, NULL);
-  } else {
-    frame->packets = g_slist_insert_sorted(frame->packets, packet, (GCompareFunc) _packets_cmp);
-  }
+  rcvframes_add_packet(this->frames, packet);
 
   // refresh skews
   {
@@ -327,7 +276,7 @@ void jitterbuffer_push_packet(JitterBuffer *this, RcvPacket* packet)
           skew.value = dReceiving - dSending;
           skew.subflow_id = packet->subflow_id;
 //          g_print("Skew %ld|%d is added\n", skew.value, skew.subflow_id);
-          slidingwindow_add_data(this->skews, &skew);
+          typedsw_skew_add(this->skews, skew);
         }
       }
       subflow->last_rcv_ts = packet->rcv_rtp_ts;
@@ -338,12 +287,12 @@ void jitterbuffer_push_packet(JitterBuffer *this, RcvPacket* packet)
   }
 
   // print
-//  for (it = this->frames; it; it = it->next) {
-//    Frame* actual = it->data;
-//    GSList* jt;
+//  for (it = this->frames->frames->head; it; it = it->next) {
+//    RcvFrame* actual = it->data;
+//    gint32 j;
 //    g_print("Frame %u, packets: ", actual->timestamp);
-//    for (jt = actual->packets; jt; jt = jt->next) {
-//      RcvPacket* p = jt->data;
+//    for (j = 0; j < actual->packets_num; ++j) {
+//      RcvPacket* p = actual->packets[j];
 //      g_print("%p->%hu|%d # ", p, p->abs_seq, p->marker);
 //    }
 //    g_print("\n");
@@ -366,21 +315,41 @@ gboolean jitterbuffer_has_repair_request(JitterBuffer* this, guint16 *gap_seq)
   return TRUE;
 }
 
+GstClockTime jitterbuffer_get_next_playout_time(JitterBuffer *this)
+{
+  RcvFrame* frame;
+  if(!g_queue_is_empty(this->playoutq)){
+    return _now(this);
+  }
+  frame = rcvframes_peek_first(this->frames);
+  if (frame == NULL) {
+    return GST_CLOCK_TIME_NONE;
+  }
+  if (this->first_frame_played == FALSE) {
+    // the initial waiting starts at the first pop attempt
+    if (!this->initial_time_initialized) {
+      return _now(this);
+    }
+    return this->first_waiting_started + this->initial_buffer_time;
+  }
+  return this->last_played_out_time + _get_sending_interval(this, frame) + this->playout_delay;
+}
+
 RcvPacket* jitterbuffer_pop_packet(JitterBuffer *this)
 {
   RcvPacket* packet = NULL;
-  Frame* frame;
+  RcvFrame* frame;
   GstClockTime now = _now(this);
-  GSList* it;
+  gint32 i;
 
   if(!g_queue_is_empty(this->playoutq)){
     goto playout_from_queue;
   }
 
-  if (this->frames == NULL) { // We have no frame to playout
+  frame = rcvframes_peek_first(this->frames);
+  if (frame == NULL) { // We have no frame to playout
     return NULL;
   }
-  frame = g_list_first(this->frames)->data;
 
   // We have frame to playout
   if (this->first_frame_played == FALSE) { // is this the first frame to playout?
@@ -398,15 +367,9 @@ RcvPacket* jitterbuffer_pop_packet(JitterBuffer *this)
   }
   else
   { // We played out frame before
-    guint32 dSn_in_ts;
     GstClockTime dSending;
 //    this->playout_delay = 0.;
-    if (_cmp_ts(frame->timestamp, this->last_played_sent_ts) < 0) {
-       dSending = 40 * GST_MSECOND;
-    } else {
-      dSn_in_ts = _delta_ts(this->last_played_sent_ts, frame->timestamp);
-      dSending = timestamp_generator_get_time(this->rtp_ts_generator, dSn_in_ts);
-    }
+    dSending = _get_sending_interval(this, frame);
 //    dSending = 40 * GST_MSECOND;
 //    g_print("dSending: %lu\n", GST_TIME_AS_MSECONDS(dSending));
     if (now < this->last_played_out_time + dSending + this->playout_delay) {
@@ -424,7 +387,7 @@ RcvPacket* jitterbuffer_pop_packet(JitterBuffer *this)
     if (this->last_played_out_time < now - this->initial_buffer_time * 2) {
       // If the last played out time is lower than a initial buffer time with a long shot,
       // then we either set an initial waiting if the buffer is empty or set the playout now.
-      if (g_list_length(this->frames) < 2) {
+      if (rcvframes_length(this->frames) < 2) {
 //        g_print("We need to reset the jitterbuffer to the initial waiting\n");
         this->first_frame_played = FALSE;
       } else {
@@ -436,8 +399,8 @@ RcvPacket* jitterbuffer_pop_packet(JitterBuffer *this)
     _refresh_playout_delay(this);
   }
 
-  for (it = frame->packets; it; it = it->next) {
-    packet = it->data;
+  for (i = 0; i < frame->packets_num; ++i) {
+    packet = frame->packets[i];
     // TODO: Discards here!
     g_queue_push_tail(this->playoutq, packet);
   }
@@ -445,10 +408,8 @@ RcvPacket* jitterbuffer_pop_packet(JitterBuffer *this)
   this->last_played_out_ts = timestamp_generator_get_ts(this->rtp_ts_generator);
 //  this->last_played_out_time = now;
 
-  g_slist_free(frame->packets);
-  frame->packets = NULL;
-  this->frames = g_list_remove(this->frames, frame);
-  _dispose_frame(this, frame);
+  rcvframes_pop_first(this->frames);
+  rcvframes_throw_frame(this->frames, frame);
 
 playout_from_queue:
   packet = g_queue_pop_head(this->playoutq);
@@ -464,6 +425,14 @@ playout_from_queue:
   return packet;
 }
 
+GstClockTime _get_sending_interval(JitterBuffer* this, RcvFrame* frame) {
+  if (_cmp_ts(frame->timestamp, this->last_played_sent_ts) < 0) {
+    return 40 * GST_MSECOND;
+  }
+  return timestamp_generator_get_time(this->rtp_ts_generator,
+      _delta_ts(this->last_played_sent_ts, frame->timestamp));
+}
+
 void _refresh_playout_delay(JitterBuffer* this) {
   if (this->max_skew_initialized == FALSE) {
     this->playout_delay = 0;
@@ -481,23 +450,3 @@ done:
   return;
 }
 
-
-Frame* _make_frame(JitterBuffer* this, RcvPacket* packet)
-{
-  Frame* result = recycle_retrieve(this->frames_recycle);
-  result->timestamp = packet->snd_rtp_ts;
-  result->created_in_ts = packet->rcv_rtp_ts;
-  result->packets = g_slist_prepend(NULL, packet);
-  return result;
-}
-
-void _dispose_frame(JitterBuffer* this, Frame* frame)
-{
-  if (frame->packets) {
-    g_slist_free(frame->packets);
-  }
-//  frame->packets = NULL;
-  memset(frame, 0, sizeof(Frame));
-  recycle_add(this->frames_recycle, frame);
-}
-
@@ -10,7 +10,9 @@
 
 #include <gst/gst.h>
 #include "lib_swplugins.h"
+#include "lib_typedsw.h"
 #include "rcvtracker.h"
+#include "rcvframes.h"
 #include "mediator.h"
 
 typedef struct _JitterBuffer JitterBuffer;
@@ -29,6 +31,13 @@ typedef struct _JitterBufferClass JitterBufferClass;
 //typedef struct _FrameNode FrameNode;
 //typedef struct _Frame Frame;
 
+typedef struct {
+  gint64 value;
+  guint8 subflow_id;
+}Skew;
+
+TYPEDSW_TYPE(skew, Skew)
+
 typedef struct {
   guint8 subflow_id;
   SlidingWindowPlugin* percentile_tracker;
@@ -61,11 +70,9 @@ struct _JitterBuffer
 //  gint32               clock_rate;
   GQueue*              playoutq;
   GQueue*              discardedq;
-  GList*               frames;
-  Recycle*             frames_recycle;
-  Recycle*             skews_recycle;
+  RcvFrames*           frames;
   TimestampGenerator*  rtp_ts_generator;
-  SlidingWindow*       skews;
+  typedsw_skew_t*      skews;
   JitterBufferSubflow* subflows;
 
   gint32               gap_seq;
@@ -120,6 +127,12 @@ jitterbuffer_has_repair_request(
     JitterBuffer *this,
     guint16 *gap_seq);
 
+//Returns the time the next packet can be popped at,
+//or GST_CLOCK_TIME_NONE if there is nothing to playout
+GstClockTime
+jitterbuffer_get_next_playout_time(
+    JitterBuffer *this);
+
 RcvPacket*
 jitterbuffer_pop_packet(
     JitterBuffer *this);
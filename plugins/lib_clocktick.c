@@ -0,0 +1,45 @@
+#include "lib_clocktick.h"
+
+static __thread clocktick_t _tick = {0, 0, 0};
+
+//------------------------------------------------------------------------------
+
+static GstClockTime _read(GstClock* clock)
+{
+        ++_tick.reads;
+        return gst_clock_get_time(clock);
+}
+
+void clocktick_begin(GstClock* clock)
+{
+        if(_tick.depth++ == 0){
+                _tick.now = _read(clock);
+        }
+}//# clocktick_begin end
+
+void clocktick_refresh(GstClock* clock)
+{
+        if(0 < _tick.depth){
+                _tick.now = _read(clock);
+        }
+}//# clocktick_refresh end
+
+void clocktick_end(void)
+{
+        if(0 < _tick.depth){
+                --_tick.depth;
+        }
+}//# clocktick_end end
+
+GstClockTime clocktick_now(GstClock* clock)
+{
+        if(0 < _tick.depth){
+                return _tick.now;
+        }
+        return _read(clock);
+}//# clocktick_now end
+
+guint64 clocktick_get_reads(void)
+{
+        return _tick.reads;
+}//# clocktick_get_reads end
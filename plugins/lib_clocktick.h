@@ -0,0 +1,34 @@
+#ifndef INCGUARD_NTRT_LIBRARY_CLOCKTICK_H_
+#define INCGUARD_NTRT_LIBRARY_CLOCKTICK_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/gst.h>
+
+/*
+ * Per thread cache of the clock time.
+ * A processing loop samples the clock once by clocktick_begin and
+ * every component asking the time on the same thread through clocktick_now
+ * gets the sampled value until clocktick_end, instead of reading the clock again.
+ * Outside of a tick clocktick_now reads the given clock as before.
+ * Ticks can be nested, only the outermost one samples the clock.
+ */
+typedef struct clocktick_struct_t
+{
+        GstClockTime             now;      ///< the time sampled at the beginning of the tick
+        gint32                   depth;    ///< number of not yet ended clocktick_begin calls
+        guint64                  reads;    ///< clock reads made by clocktick_now on the thread
+} clocktick_t;
+
+void clocktick_begin(GstClock* clock);
+//Samples the clock again inside a tick, after the thread has been blocked for a while
+void clocktick_refresh(GstClock* clock);
+void clocktick_end(void);
+GstClockTime clocktick_now(GstClock* clock);
+//Number of clock reads clocktick_now made on the calling thread
+guint64 clocktick_get_reads(void);
+
+
+#endif /* INCGUARD_NTRT_LIBRARY_CLOCKTICK_H_ */
@@ -0,0 +1,193 @@
+#include "lib_gf256.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GF256_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+#define GF256_POLYNOMIAL 0x11D
+
+typedef void (*GF256MulAddFunc)(guint8* to, const guint8* from, guint8 coef, gint32 length);
+
+typedef struct{
+  guint8 exp[512];
+  guint8 log[256];
+  guint8 mul[256][256];
+  guint8 mul_lo[256][16];
+  guint8 mul_hi[256][16];
+  GF256MulAddFunc muladd;
+}GF256Tables;
+
+static GF256Tables _tables;
+
+static void _gf256_muladd_scalar(guint8* to, const guint8* from, guint8 coef, gint32 length) {
+  const guint8* row = _tables.mul[coef];
+  gint32 i;
+  for(i = 0; i < length; ++i){
+    to[i] ^= row[from[i]];
+  }
+}
+
+#ifdef GF256_X86_DISPATCH
+__attribute__((target("ssse3")))
+static void _gf256_muladd_ssse3(guint8* to, const guint8* from, guint8 coef, gint32 length) {
+  __m128i lo   = _mm_loadu_si128((const __m128i*)_tables.mul_lo[coef]);
+  __m128i hi   = _mm_loadu_si128((const __m128i*)_tables.mul_hi[coef]);
+  __m128i mask = _mm_set1_epi8(0x0F);
+  __m128i src, product;
+  gint32 i;
+  for(i = 0; i + 16 <= length; i += 16){
+    src = _mm_loadu_si128((const __m128i*)(from + i));
+    product = _mm_xor_si128(
+        _mm_shuffle_epi8(lo, _mm_and_si128(src, mask)),
+        _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(src, 4), mask)));
+    _mm_storeu_si128((__m128i*)(to + i), _mm_xor_si128(_mm_loadu_si128((const __m128i*)(to + i)), product));
+  }
+  _gf256_muladd_scalar(to + i, from + i, coef, length - i);
+}
+#endif
+
+static GF256MulAddFunc _select_muladd_impl(void) {
+#ifdef GF256_X86_DISPATCH
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("ssse3")){
+    return _gf256_muladd_ssse3;
+  }
+#endif
+  return _gf256_muladd_scalar;
+}
+
+static void _setup_tables(void) {
+  gint32 i, j, x = 1;
+  for(i = 0; i < 255; ++i){
+    _tables.exp[i] = x;
+    _tables.log[x] = i;
+    x <<= 1;
+    if(x & 0x100){
+      x ^= GF256_POLYNOMIAL;
+    }
+  }
+  //doubling the exp table saves the modulo at multiplication
+  for(i = 255; i < 512; ++i){
+    _tables.exp[i] = _tables.exp[i - 255];
+  }
+  for(i = 1; i < 256; ++i){
+    for(j = 1; j < 256; ++j){
+      _tables.mul[i][j] = _tables.exp[_tables.log[i] + _tables.log[j]];
+    }
+  }
+  for(i = 0; i < 256; ++i){
+    for(j = 0; j < 16; ++j){
+      _tables.mul_lo[i][j] = _tables.mul[i][j];
+      _tables.mul_hi[i][j] = _tables.mul[i][j << 4];
+    }
+  }
+  _tables.muladd = _select_muladd_impl();
+}
+
+static inline void _init(void) {
+  static gsize initialized = 0;
+  if(g_once_init_enter(&initialized)){
+    _setup_tables();
+    g_once_init_leave(&initialized, 1);
+  }
+}
+
+guint8 gf256_mul(guint8 a, guint8 b)
+{
+  _init();
+  return _tables.mul[a][b];
+}
+
+guint8 gf256_div(guint8 a, guint8 b)
+{
+  _init();
+  if(a == 0 || b == 0){
+    return 0;
+  }
+  return _tables.exp[_tables.log[a] + 255 - _tables.log[b]];
+}
+
+guint8 gf256_inv(guint8 a)
+{
+  return gf256_div(1, a);
+}
+
+void gf256_muladd_region(guint8* to, const guint8* from, guint8 coef, gint32 length)
+{
+  gint32 i;
+  _init();
+  if(coef == 0){
+    return;
+  }
+  if(coef == 1){
+    for(i = 0; i < length; ++i){
+      to[i] ^= from[i];
+    }
+    return;
+  }
+  _tables.muladd(to, from, coef, length);
+}
+
+void gf256_mul_region(guint8* region, guint8 coef, gint32 length)
+{
+  const guint8* row;
+  gint32 i;
+  _init();
+  if(coef == 1){
+    return;
+  }
+  row = _tables.mul[coef];
+  for(i = 0; i < length; ++i){
+    region[i] = row[region[i]];
+  }
+}
+
+guint8 gf256_cauchy_coef(gint32 repair_index, gint32 source_index)
+{
+  //x_j = j and y_i = 128 + i are disjoint sets, so x_j ^ y_i is never 0
+  return gf256_inv((guint8)(repair_index ^ (128 + source_index)));
+}
+
+gboolean gf256_invert_matrix(guint8* matrix, gint32 n)
+{
+  guint8 work[32 * 64];
+  gint32 width = 2 * n;
+  gint32 row, col, pivot, i;
+  guint8 factor;
+  guint8* rowp;
+  if(n < 1 || 32 < n){
+    return FALSE;
+  }
+  _init();
+  memset(work, 0, sizeof(work));
+  for(row = 0; row < n; ++row){
+    memcpy(work + row * width, matrix + row * n, n);
+    work[row * width + n + row] = 1;
+  }
+  for(col = 0; col < n; ++col){
+    for(pivot = col; pivot < n && work[pivot * width + col] == 0; ++pivot);
+    if(pivot == n){
+      return FALSE;
+    }
+    if(pivot != col){
+      guint8 tmp[64];
+      memcpy(tmp, work + pivot * width, width);
+      memcpy(work + pivot * width, work + col * width, width);
+      memcpy(work + col * width, tmp, width);
+    }
+    rowp = work + col * width;
+    gf256_mul_region(rowp, gf256_inv(rowp[col]), width);
+    for(i = 0; i < n; ++i){
+      factor = work[i * width + col];
+      if(i == col || factor == 0){
+        continue;
+      }
+      _gf256_muladd_scalar(work + i * width, rowp, factor, width);
+    }
+  }
+  for(row = 0; row < n; ++row){
+    memcpy(matrix + row * n, work + row * width + n, n);
+  }
+  return TRUE;
+}
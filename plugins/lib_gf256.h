@@ -0,0 +1,35 @@
+#ifndef INCGUARD_NTRT_LIBRARY_GF256_H_
+#define INCGUARD_NTRT_LIBRARY_GF256_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/gst.h>
+
+/*
+ * Arithmetic over GF(2^8) with the 0x11D polynomial.
+ * Addition is xor, multiplication goes through log/exp tables, and
+ * the region operations multiply a whole packet by a constant with
+ * a full multiplication table row or with SSSE3 nibble lookups if
+ * the cpu supports it.
+ */
+
+guint8 gf256_mul(guint8 a, guint8 b);
+guint8 gf256_div(guint8 a, guint8 b);
+guint8 gf256_inv(guint8 a);
+
+//to[i] ^= coef * from[i]
+void gf256_muladd_region(guint8* to, const guint8* from, guint8 coef, gint32 length);
+//region[i] = coef * region[i]
+void gf256_mul_region(guint8* region, guint8 coef, gint32 length);
+
+//Element of the Cauchy matrix used by the systematic erasure code.
+//Any square submatrix of it is invertible, so any repair_index < 128
+//and source_index < 128 pairs can be combined for decoding.
+guint8 gf256_cauchy_coef(gint32 repair_index, gint32 source_index);
+
+//Inverts the n x n row-major matrix in place, returns FALSE if it is singular.
+gboolean gf256_invert_matrix(guint8* matrix, gint32 n);
+
+#endif /* INCGUARD_NTRT_LIBRARY_GF256_H_ */
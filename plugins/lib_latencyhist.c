@@ -0,0 +1,138 @@
+#include "lib_latencyhist.h"
+
+#define _load(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+
+//------------------------------------------------------------------------------
+
+static gint32 _get_bucket(guint64 value)
+{
+        gint32 msb, shift;
+        if(value < (2 << LATENCYHIST_SUB_BUCKET_BITS)){
+                return (gint32) value;
+        }
+        if((G_GUINT64_CONSTANT(1) << LATENCYHIST_MAX_VALUE_BITS) <= value){
+                return LATENCYHIST_BUCKETS_NUM - 1;
+        }
+        msb = 63 - __builtin_clzll(value);
+        shift = msb - LATENCYHIST_SUB_BUCKET_BITS;
+        return shift * LATENCYHIST_SUB_BUCKETS_NUM + (gint32)(value >> shift);
+}
+
+static guint64 _get_highest_value(gint32 bucket)
+{
+        gint32 shift;
+        guint64 lowest;
+        if(bucket < (2 << LATENCYHIST_SUB_BUCKET_BITS)){
+                return bucket;
+        }
+        shift = bucket / LATENCYHIST_SUB_BUCKETS_NUM - 1;
+        lowest = (guint64)(bucket - shift * LATENCYHIST_SUB_BUCKETS_NUM) << shift;
+        return lowest + (G_GUINT64_CONSTANT(1) << shift) - 1;
+}
+
+static guint64 _snapshot(latencyhist_t *hist, guint64* counts)
+{
+        guint64 total = 0;
+        gint32 i;
+        for(i = 0; i < LATENCYHIST_BUCKETS_NUM; ++i){
+                counts[i] = _load(&hist->counts[i]);
+                total += counts[i];
+        }
+        return total;
+}
+
+static guint64 _get_percentile(guint64* counts, guint64 total, gdouble percentile)
+{
+        guint64 target, cumulated = 0;
+        gint32 i;
+        if(total == 0){
+                return 0;
+        }
+        target = (guint64)(total * CLAMP(percentile, 0., 100.) / 100. + .5);
+        target = MAX(target, 1);
+        for(i = 0; i < LATENCYHIST_BUCKETS_NUM; ++i){
+                cumulated += counts[i];
+                if(target <= cumulated){
+                        return _get_highest_value(i);
+                }
+        }
+        return _get_highest_value(LATENCYHIST_BUCKETS_NUM - 1);
+}
+
+latencyhist_t* latencyhist_ctor(const gchar* name)
+{
+        latencyhist_t* result;
+        result = (latencyhist_t*) g_malloc0(sizeof(latencyhist_t));
+        result->name = name;
+        return result;
+}//# latencyhist_ctor end
+
+
+void latencyhist_dtor(latencyhist_t* hist)
+{
+        if(hist == NULL){
+                return;
+        }
+        g_free(hist);
+}//# latencyhist_dtor end
+
+void latencyhist_record(latencyhist_t *hist, guint64 elapsed)
+{
+        guint64 max = _load(&hist->max);
+        __atomic_fetch_add(&hist->counts[_get_bucket(elapsed)], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&hist->total, 1, __ATOMIC_RELAXED);
+        while(max < elapsed){
+                if(__atomic_compare_exchange_n(&hist->max, &max, elapsed, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                        break;
+                }
+        }
+}//# latencyhist_record end
+
+guint64 latencyhist_get_total(latencyhist_t *hist)
+{
+        return _load(&hist->total);
+}
+
+guint64 latencyhist_get_max(latencyhist_t *hist)
+{
+        return _load(&hist->max);
+}
+
+guint64 latencyhist_get_percentile(latencyhist_t *hist, gdouble percentile)
+{
+        guint64 counts[LATENCYHIST_BUCKETS_NUM];
+        guint64 total = _snapshot(hist, counts);
+        return _get_percentile(counts, total, percentile);
+}
+
+void latencyhist_reset(latencyhist_t *hist)
+{
+        gint32 i;
+        for(i = 0; i < LATENCYHIST_BUCKETS_NUM; ++i){
+                __atomic_store_n(&hist->counts[i], 0, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&hist->total, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&hist->max, 0, __ATOMIC_RELAXED);
+}
+
+void latencyhist_append_to_structure(latencyhist_t *hist, GstStructure* structure)
+{
+        static const struct{ const gchar* suffix; gdouble percentile; } percentiles[] = {
+                {"p50", 50.}, {"p90", 90.}, {"p99", 99.}, {"p999", 99.9},
+        };
+        guint64 counts[LATENCYHIST_BUCKETS_NUM];
+        guint64 total;
+        gchar field[255];
+        guint i;
+
+        total = _snapshot(hist, counts);
+        g_snprintf(field, sizeof(field), "%s-count", hist->name);
+        gst_structure_set(structure, field, G_TYPE_UINT64, total, NULL);
+        for(i = 0; i < G_N_ELEMENTS(percentiles); ++i){
+                g_snprintf(field, sizeof(field), "%s-%s", hist->name, percentiles[i].suffix);
+                gst_structure_set(structure, field, G_TYPE_UINT64,
+                                _get_percentile(counts, total, percentiles[i].percentile), NULL);
+        }
+        g_snprintf(field, sizeof(field), "%s-max", hist->name);
+        gst_structure_set(structure, field, G_TYPE_UINT64, latencyhist_get_max(hist), NULL);
+}
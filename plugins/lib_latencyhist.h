@@ -0,0 +1,67 @@
+#ifndef INCGUARD_NTRT_LIBRARY_LATENCYHIST_H_
+#define INCGUARD_NTRT_LIBRARY_LATENCYHIST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <gst/gst.h>
+
+//Every power of two range is split into this many linear buckets,
+//so a recorded value is off by less than 1/64 of it.
+#define LATENCYHIST_SUB_BUCKET_BITS 6
+#define LATENCYHIST_SUB_BUCKETS_NUM (1 << LATENCYHIST_SUB_BUCKET_BITS)
+//Values above 2^40ns (~18 minutes) are recorded into the last bucket
+#define LATENCYHIST_MAX_VALUE_BITS 40
+#define LATENCYHIST_BUCKETS_NUM ((LATENCYHIST_MAX_VALUE_BITS - LATENCYHIST_SUB_BUCKET_BITS + 1) * LATENCYHIST_SUB_BUCKETS_NUM)
+
+/*
+ * HDR style histogram of elapsed times in nanoseconds.
+ * Buckets are linear inside a power of two range and the ranges grow exponentially,
+ * so small and large latencies are kept with the same relative precision.
+ * Recording is a relaxed atomic increment, any number of threads can record
+ * while another one reads the percentiles.
+ */
+typedef struct latencyhist_struct_t
+{
+        const gchar*             name;                             ///< name of the measured site
+        guint64                  counts[LATENCYHIST_BUCKETS_NUM];
+        guint64                  total;
+        guint64                  max;
+} latencyhist_t;
+
+latencyhist_t* latencyhist_ctor(const gchar* name);
+void latencyhist_dtor(latencyhist_t *hist);
+void latencyhist_record(latencyhist_t *hist, guint64 elapsed);
+guint64 latencyhist_get_total(latencyhist_t *hist);
+guint64 latencyhist_get_max(latencyhist_t *hist);
+//percentile is between 0 and 100, returns the highest value equivalent to the bucket it falls into
+guint64 latencyhist_get_percentile(latencyhist_t *hist, gdouble percentile);
+void latencyhist_reset(latencyhist_t *hist);
+//Adds <name>-count, <name>-p50, <name>-p90, <name>-p99, <name>-p999 and <name>-max fields in ns
+void latencyhist_append_to_structure(latencyhist_t *hist, GstStructure* structure);
+
+static inline guint64 latencyhist_now(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (guint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//Records the time the given statements take into hist,
+//they must not jump out of the block or nothing is recorded
+#define LATENCYHIST_RECORD(hist, func) \
+{  \
+  guint64 _latencyhist_start = latencyhist_now(); \
+  func; \
+  latencyhist_record(hist, latencyhist_now() - _latencyhist_start); \
+} \
+
+//Records the time passed from LATENCYHIST_BEGIN to LATENCYHIST_END into hist,
+//for statements leaving at a label the end goes after the label
+#define LATENCYHIST_BEGIN(start) (start) = latencyhist_now()
+#define LATENCYHIST_END(hist, start) latencyhist_record(hist, latencyhist_now() - (start))
+
+
+#endif /* INCGUARD_NTRT_LIBRARY_LATENCYHIST_H_ */
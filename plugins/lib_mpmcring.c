@@ -0,0 +1,109 @@
+#include "lib_mpmcring.h"
+
+#define _load(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define _acquire(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define _release(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+#define _claim(ptr, expected, value) \
+        __atomic_compare_exchange_n(ptr, expected, value, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+
+//------------------------------------------------------------------------------
+
+mpmcring_t* mpmcring_ctor(gint32 size)
+{
+        mpmcring_t* result;
+        gsize length = 1, i;
+        while(length < (gsize) size){
+                length <<= 1;
+        }
+        result = (mpmcring_t*) g_malloc0(sizeof(mpmcring_t));
+        result->cells = (mpmcringcell_t*) g_malloc0(sizeof(mpmcringcell_t) * length);
+        for(i = 0; i < length; ++i){
+                result->cells[i].seq = i;
+        }
+        result->mask = length - 1;
+        return result;
+}//# mpmcring_ctor end
+
+
+void mpmcring_dtor(mpmcring_t* ring)
+{
+        if(ring == NULL){
+                return;
+        }
+        g_free(ring->cells);
+        g_free(ring);
+}//# mpmcring_dtor end
+
+gboolean mpmcring_push(mpmcring_t* ring, gpointer item)
+{
+        mpmcringcell_t* cell;
+        gsize pos = _load(&ring->head);
+        gssize diff;
+        for(;;){
+                cell = ring->cells + (pos & ring->mask);
+                diff = (gssize) _acquire(&cell->seq) - (gssize) pos;
+                if(diff == 0){
+                        if(_claim(&ring->head, &pos, pos + 1)){
+                                break;
+                        }
+                }else if(diff < 0){
+                        //the cell still holds the item written one round before
+                        return FALSE;
+                }else{
+                        pos = _load(&ring->head);
+                }
+        }
+        cell->item = item;
+        //publishes the item written above to the consumers
+        _release(&cell->seq, pos + 1);
+        return TRUE;
+}//# mpmcring_push end
+
+gpointer mpmcring_pop(mpmcring_t* ring)
+{
+        mpmcringcell_t* cell;
+        gpointer result;
+        gsize pos = _load(&ring->tail);
+        gssize diff;
+        for(;;){
+                cell = ring->cells + (pos & ring->mask);
+                diff = (gssize) _acquire(&cell->seq) - (gssize)(pos + 1);
+                if(diff == 0){
+                        if(_claim(&ring->tail, &pos, pos + 1)){
+                                break;
+                        }
+                }else if(diff < 0){
+                        return NULL;
+                }else{
+                        pos = _load(&ring->tail);
+                }
+        }
+        result = cell->item;
+        cell->item = NULL;
+        //hands the cell back to the producers for the next round
+        _release(&cell->seq, pos + ring->mask + 1);
+        return result;
+}//# mpmcring_pop end
+
+gint32 mpmcring_readcapacity(mpmcring_t *ring)
+{
+        gsize tail = _acquire(&ring->tail);
+        gsize head = _acquire(&ring->head);
+        return head < tail ? 0 : (gint32)(head - tail);
+}
+
+gboolean mpmcring_isempty(mpmcring_t *ring)
+{
+        return mpmcring_readcapacity(ring) == 0;
+}
+
+void mpmcring_clear(mpmcring_t *ring, void (*dtor)(gpointer))
+{
+        gpointer item;
+        while((item = mpmcring_pop(ring)) != NULL){
+                if(dtor == NULL){
+                        continue;
+                }
+                dtor(item);
+        }
+}
@@ -0,0 +1,48 @@
+#ifndef INCGUARD_NTRT_LIBRARY_MPMCRING_H_
+#define INCGUARD_NTRT_LIBRARY_MPMCRING_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <string.h>
+#include <assert.h>
+
+#include <gst/gst.h>
+
+#define MPMCRING_CACHELINE_SIZE 64
+
+typedef struct mpmcringcell_struct_t
+{
+        volatile gsize           seq;      ///< position the cell is ready to be written or read at
+        gpointer                 item;
+} mpmcringcell_t;
+
+/*
+ * Bounded multi producer multi consumer ring of pointers.
+ * Every cell carries the position it can be written at, and the next one after it is read.
+ * A producer claims a position by a CAS on the head and publishes the item
+ * by storing the next sequence into the cell; consumers do the same on the tail.
+ * The sequence numbers make the ring free of the ABA problem and no side takes a lock.
+ */
+typedef struct mpmcring_struct_t
+{
+        volatile gsize           head;     ///< next position producers claim
+        gchar                    head_pad[MPMCRING_CACHELINE_SIZE - sizeof(gsize)];
+        volatile gsize           tail;     ///< next position consumers claim
+        gchar                    tail_pad[MPMCRING_CACHELINE_SIZE - sizeof(gsize)];
+        mpmcringcell_t          *cells;    ///< length is a power of two
+        gsize                    mask;     ///< length - 1
+} mpmcring_t;
+
+mpmcring_t* mpmcring_ctor(gint32 items_num);
+void mpmcring_dtor(mpmcring_t *ring);
+//Returns FALSE if the ring is full
+gboolean mpmcring_push(mpmcring_t *ring, gpointer item);
+//Returns NULL if the ring is empty or the next item is not published yet
+gpointer mpmcring_pop(mpmcring_t *ring);
+gint32 mpmcring_readcapacity(mpmcring_t *ring);
+gboolean mpmcring_isempty(mpmcring_t *ring);
+void mpmcring_clear(mpmcring_t *ring, void (*dtor)(gpointer));
+
+
+#endif /* INCGUARD_NTRT_LIBRARY_MPMCRING_H_ */
@@ -0,0 +1,213 @@
+#include "lib_ostree.h"
+
+#define _size(node) ((node) ? (node)->size : 0)
+#define _height(node) ((node) ? (node)->height : 0)
+
+//------------------------------------------------------------------------------
+
+static ostreenode_t* _make_node(ostree_t* tree, gpointer data)
+{
+        ostreenode_t* result;
+        gint32 i;
+        if(!tree->free_nodes){
+                ostreenode_t* chunk = g_malloc0(sizeof(ostreenode_t) * OSTREE_NODES_CHUNK_LENGTH);
+                for(i = 0; i < OSTREE_NODES_CHUNK_LENGTH; ++i){
+                        chunk[i].right = tree->free_nodes;
+                        tree->free_nodes = &chunk[i];
+                }
+                tree->chunks = g_slist_prepend(tree->chunks, chunk);
+        }
+        result = tree->free_nodes;
+        tree->free_nodes = result->right;
+        result->data   = data;
+        result->left   = result->right = NULL;
+        result->size   = 1;
+        result->height = 1;
+        return result;
+}
+
+static void _throw_node(ostree_t* tree, ostreenode_t* node)
+{
+        node->data  = NULL;
+        node->left  = NULL;
+        node->right = tree->free_nodes;
+        tree->free_nodes = node;
+}
+
+static gint32 _cmp(ostree_t* tree, gpointer a, gpointer b)
+{
+        gint32 result = tree->cmp(a, b);
+        if(result != 0){
+                return result;
+        }
+        return a < b ? -1 : b < a ? 1 : 0;
+}
+
+static void _update(ostreenode_t* node)
+{
+        node->size   = _size(node->left) + _size(node->right) + 1;
+        node->height = MAX(_height(node->left), _height(node->right)) + 1;
+}
+
+static ostreenode_t* _rotate_right(ostreenode_t* node)
+{
+        ostreenode_t* pivot = node->left;
+        node->left = pivot->right;
+        pivot->right = node;
+        _update(node);
+        _update(pivot);
+        return pivot;
+}
+
+static ostreenode_t* _rotate_left(ostreenode_t* node)
+{
+        ostreenode_t* pivot = node->right;
+        node->right = pivot->left;
+        pivot->left = node;
+        _update(node);
+        _update(pivot);
+        return pivot;
+}
+
+static ostreenode_t* _balance(ostreenode_t* node)
+{
+        gint32 factor;
+        _update(node);
+        factor = _height(node->left) - _height(node->right);
+        if(1 < factor){
+                if(_height(node->left->left) < _height(node->left->right)){
+                        node->left = _rotate_left(node->left);
+                }
+                return _rotate_right(node);
+        }
+        if(factor < -1){
+                if(_height(node->right->right) < _height(node->right->left)){
+                        node->right = _rotate_right(node->right);
+                }
+                return _rotate_left(node);
+        }
+        return node;
+}
+
+static ostreenode_t* _insert(ostree_t* tree, ostreenode_t* node, gpointer data)
+{
+        if(!node){
+                return _make_node(tree, data);
+        }
+        if(_cmp(tree, data, node->data) < 0){
+                node->left = _insert(tree, node->left, data);
+        }else{
+                node->right = _insert(tree, node->right, data);
+        }
+        return _balance(node);
+}
+
+static ostreenode_t* _remove_min(ostreenode_t* node, ostreenode_t** min)
+{
+        if(!node->left){
+                *min = node;
+                return node->right;
+        }
+        node->left = _remove_min(node->left, min);
+        return _balance(node);
+}
+
+static ostreenode_t* _remove(ostree_t* tree, ostreenode_t* node, gpointer data, gboolean* removed)
+{
+        gint32 cmp;
+        ostreenode_t* successor;
+        if(!node){
+                return NULL;
+        }
+        cmp = _cmp(tree, data, node->data);
+        if(cmp < 0){
+                node->left = _remove(tree, node->left, data, removed);
+        }else if(0 < cmp){
+                node->right = _remove(tree, node->right, data, removed);
+        }else{
+                *removed = TRUE;
+                if(!node->left || !node->right){
+                        successor = node->left ? node->left : node->right;
+                        _throw_node(tree, node);
+                        return successor;
+                }
+                node->right = _remove_min(node->right, &successor);
+                successor->left  = node->left;
+                successor->right = node->right;
+                _throw_node(tree, node);
+                node = successor;
+        }
+        return _balance(node);
+}
+
+static void _clear(ostree_t* tree, ostreenode_t* node)
+{
+        if(!node){
+                return;
+        }
+        _clear(tree, node->left);
+        _clear(tree, node->right);
+        _throw_node(tree, node);
+}
+
+ostree_t* ostree_ctor(OSTreeCmp cmp)
+{
+        ostree_t* result;
+        result = (ostree_t*) g_malloc0(sizeof(ostree_t));
+        result->cmp = cmp;
+        return result;
+}//# ostree_ctor end
+
+
+void ostree_dtor(ostree_t* tree)
+{
+        if(tree == NULL){
+                return;
+        }
+        g_slist_free_full(tree->chunks, g_free);
+        g_free(tree);
+}//# ostree_dtor end
+
+void ostree_insert(ostree_t *tree, gpointer data)
+{
+        tree->root = _insert(tree, tree->root, data);
+}//# ostree_insert end
+
+gboolean ostree_remove(ostree_t *tree, gpointer data)
+{
+        gboolean removed = FALSE;
+        tree->root = _remove(tree, tree->root, data, &removed);
+        return removed;
+}//# ostree_remove end
+
+gpointer ostree_get_at(ostree_t *tree, gint32 rank)
+{
+        ostreenode_t* node = tree->root;
+        gint32 left_size;
+        if(rank < 0 || _size(node) <= rank){
+                return NULL;
+        }
+        while(node){
+                left_size = _size(node->left);
+                if(rank < left_size){
+                        node = node->left;
+                }else if(left_size < rank){
+                        rank -= left_size + 1;
+                        node = node->right;
+                }else{
+                        return node->data;
+                }
+        }
+        return NULL;
+}//# ostree_get_at end
+
+gint32 ostree_length(ostree_t *tree)
+{
+        return _size(tree->root);
+}
+
+void ostree_clear(ostree_t *tree)
+{
+        _clear(tree, tree->root);
+        tree->root = NULL;
+}
@@ -0,0 +1,51 @@
+#ifndef INCGUARD_NTRT_LIBRARY_OSTREE_H_
+#define INCGUARD_NTRT_LIBRARY_OSTREE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/gst.h>
+
+//Number of nodes allocated at once by the node pool of a tree
+#define OSTREE_NODES_CHUNK_LENGTH 64
+
+typedef gint32 (*OSTreeCmp)(gpointer, gpointer);
+
+typedef struct ostreenode_struct_t
+{
+        gpointer                     data;
+        struct ostreenode_struct_t  *left;
+        struct ostreenode_struct_t  *right;
+        gint32                       size;     ///< number of nodes in the subtree rooted here
+        gint32                       height;
+} ostreenode_t;
+
+/*
+ * Order statistic AVL tree of pointers.
+ * Items are ordered by cmp and equal items by their address, so the
+ * same item can be found and removed in O(log n) among many equal ones.
+ * Every node knows the size of its subtree, so the item at any rank
+ * is also found in O(log n), whatever order the items are added in.
+ * Nodes are taken from a pool of the tree, which grows in chunks and
+ * is only given back to the system when the tree is destroyed.
+ */
+typedef struct ostree_struct_t
+{
+        ostreenode_t            *root;
+        OSTreeCmp                cmp;
+        ostreenode_t            *free_nodes;  ///< linked through the right pointers
+        GSList                  *chunks;
+} ostree_t;
+
+ostree_t* ostree_ctor(OSTreeCmp cmp);
+void ostree_dtor(ostree_t *tree);
+void ostree_insert(ostree_t *tree, gpointer data);
+gboolean ostree_remove(ostree_t *tree, gpointer data);
+//rank 0 is the smallest item, returns NULL if rank is out of the range
+gpointer ostree_get_at(ostree_t *tree, gint32 rank);
+gint32 ostree_length(ostree_t *tree);
+void ostree_clear(ostree_t *tree);
+
+
+#endif /* INCGUARD_NTRT_LIBRARY_OSTREE_H_ */
@@ -0,0 +1,180 @@
+#include "lib_shmring.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define _next(index) ((gint)((guint)(index) + 1))
+#define _count(head, tail) ((gint32)((guint)(head) - (guint)(tail)))
+#define _item(ring, index) ((ring)->items + ((guint)(index) & (ring)->header->mask) * (ring)->header->item_size)
+
+//------------------------------------------------------------------------------
+
+//shm_open wants a single leading slash
+static void _set_name(shmring_t* ring, const gchar* name)
+{
+        while(*name == '/'){
+                ++name;
+        }
+        g_snprintf(ring->name, sizeof(ring->name), "/%s", name);
+}
+
+static gboolean _map(shmring_t* ring, gint fd, gsize size)
+{
+        gpointer mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(mapped == MAP_FAILED){
+                return FALSE;
+        }
+        ring->header = (shmringheader_t*) mapped;
+        ring->items = (guint8*) mapped + sizeof(shmringheader_t);
+        ring->mapped_size = size;
+        return TRUE;
+}
+
+//The header is written by another process, the items it describes must be in the mapping.
+//Computed in 64 bits, so a mask of G_MAXUINT32 does not wrap the length to 0.
+static gboolean _header_fits(shmringheader_t* header, gsize mapped_size)
+{
+        guint64 length = (guint64) header->mask + 1;
+        if(header->item_size == 0 || G_MAXINT32 < header->mask || (length & (length - 1)) != 0){
+                return FALSE;
+        }
+        return (guint64) header->item_size * length <= (guint64)(mapped_size - sizeof(shmringheader_t));
+}
+
+shmring_t* shmring_ctor(const gchar* name, gint32 item_size, gint32 items_num)
+{
+        shmring_t* result;
+        gint32 length = 1;
+        gint fd;
+        gsize size;
+        if(name == NULL){
+                g_warning("shmring: no name is given for the ring");
+                return NULL;
+        }
+        while(length < items_num){
+                length <<= 1;
+        }
+        size = sizeof(shmringheader_t) + (gsize) item_size * length;
+        result = (shmring_t*) g_malloc0(sizeof(shmring_t));
+        _set_name(result, name);
+        result->writer = TRUE;
+        //a reader still attached to a previous ring keeps its own mapping
+        shm_unlink(result->name);
+        fd = shm_open(result->name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if(fd < 0){
+                g_warning("shm_open %s: %s", result->name, g_strerror(errno));
+                g_free(result);
+                return NULL;
+        }
+        if(ftruncate(fd, size) < 0 || !_map(result, fd, size)){
+                g_warning("shmring %s: %s", result->name, g_strerror(errno));
+                close(fd);
+                shm_unlink(result->name);
+                g_free(result);
+                return NULL;
+        }
+        close(fd);
+        result->header->item_size = item_size;
+        result->header->mask = length - 1;
+        result->header->writer_pid = (gint32) getpid();
+        //publishes the fields above to a reader
+        g_atomic_int_set(&result->header->magic, SHMRING_MAGIC);
+        return result;
+}//# shmring_ctor end
+
+shmring_t* shmring_open(const gchar* name)
+{
+        shmring_t* result;
+        struct stat st;
+        gint fd;
+        if(name == NULL){
+                return NULL;
+        }
+        result = (shmring_t*) g_malloc0(sizeof(shmring_t));
+        _set_name(result, name);
+        fd = shm_open(result->name, O_RDWR, 0600);
+        if(fd < 0){
+                goto failed;
+        }
+        if(fstat(fd, &st) < 0 || (gsize) st.st_size < sizeof(shmringheader_t) || !_map(result, fd, (gsize) st.st_size)){
+                close(fd);
+                goto failed;
+        }
+        close(fd);
+        if(g_atomic_int_get(&result->header->magic) != SHMRING_MAGIC || !_header_fits(result->header, result->mapped_size)){
+                munmap(result->header, result->mapped_size);
+                goto failed;
+        }
+        return result;
+failed:
+        g_free(result);
+        return NULL;
+}//# shmring_open end
+
+void shmring_dtor(shmring_t* ring)
+{
+        if(ring == NULL){
+                return;
+        }
+        if(ring->writer){
+                g_atomic_int_set(&ring->header->closed, 1);
+                shm_unlink(ring->name);
+        }
+        munmap(ring->header, ring->mapped_size);
+        g_free(ring);
+}//# shmring_dtor end
+
+gboolean shmring_push(shmring_t* ring, gconstpointer item)
+{
+        gint head = ring->header->head;
+        gint tail = g_atomic_int_get(&ring->header->tail);
+        if((gint32) ring->header->mask < _count(head, tail)){
+                __atomic_store_n(&ring->header->dropped, ring->header->dropped + 1, __ATOMIC_RELAXED);
+                return FALSE;
+        }
+        memcpy(_item(ring, head), item, ring->header->item_size);
+        //publishes the item written above to the reader
+        g_atomic_int_set(&ring->header->head, _next(head));
+        return TRUE;
+}//# shmring_push end
+
+gboolean shmring_pop(shmring_t* ring, gpointer item)
+{
+        gint tail = ring->header->tail;
+        gint head = g_atomic_int_get(&ring->header->head);
+        if(head == tail){
+                return FALSE;
+        }
+        memcpy(item, _item(ring, tail), ring->header->item_size);
+        //hands the slot back to the writer
+        g_atomic_int_set(&ring->header->tail, _next(tail));
+        return TRUE;
+}//# shmring_pop end
+
+gint32 shmring_readcapacity(shmring_t *ring)
+{
+        return _count(g_atomic_int_get(&ring->header->head), g_atomic_int_get(&ring->header->tail));
+}//# shmring_readcapacity end
+
+gint32 shmring_get_item_size(shmring_t *ring)
+{
+        return ring->header->item_size;
+}//# shmring_get_item_size end
+
+guint64 shmring_get_dropped(shmring_t *ring)
+{
+        return __atomic_load_n(&ring->header->dropped, __ATOMIC_RELAXED);
+}//# shmring_get_dropped end
+
+gboolean shmring_is_closed(shmring_t *ring)
+{
+        if(g_atomic_int_get(&ring->header->closed) != 0){
+                return TRUE;
+        }
+        //a crashed writer never sets closed. A process of an other user
+        //gives EPERM, only a missing one is taken as gone.
+        return kill((pid_t) ring->header->writer_pid, 0) < 0 && errno == ESRCH;
+}//# shmring_is_closed end
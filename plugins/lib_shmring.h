@@ -0,0 +1,69 @@
+#ifndef INCGUARD_NTRT_LIBRARY_SHMRING_H_
+#define INCGUARD_NTRT_LIBRARY_SHMRING_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/gst.h>
+
+#define SHMRING_CACHELINE_SIZE 64
+#define SHMRING_MAGIC 0x4d505352  //"MPSR"
+
+/*
+ * Header at the beginning of the shared memory object, items follow it.
+ * Every field has a fixed width, so processes built separately agree on the layout.
+ * head and tail are free running sequence numbers of items,
+ * the writer only writes head and dropped, the reader only writes tail.
+ */
+typedef struct shmringheader_struct_t
+{
+        volatile gint            magic;      ///< set last by the writer, the ring is usable after it appears
+        guint32                  item_size;
+        guint32                  mask;       ///< length - 1, length is a power of two
+        volatile gint            closed;     ///< set by the writer before it goes away
+        gint32                   writer_pid; ///< a reader takes the ring closed if this process is gone
+        gchar                    meta_pad[SHMRING_CACHELINE_SIZE - 5 * sizeof(guint32)];
+        volatile gint            head;       ///< sequence of the next item the writer writes
+        gchar                    head_pad[SHMRING_CACHELINE_SIZE - sizeof(gint)];
+        volatile gint            tail;       ///< sequence of the next item the reader reads
+        gchar                    tail_pad[SHMRING_CACHELINE_SIZE - sizeof(gint)];
+        guint64                  dropped;    ///< items the writer could not push, because the ring was full
+        gchar                    dropped_pad[SHMRING_CACHELINE_SIZE - sizeof(guint64)];
+} shmringheader_t;
+
+/*
+ * Single producer single consumer ring of fixed size items in a POSIX
+ * shared memory object (/dev/shm/<name>), so another process can read what
+ * the producer pushes without a syscall per item.
+ * The producer never waits for the consumer: if the ring is full the item
+ * is dropped and counted in the header, where the consumer can see it too.
+ * The object is readable and writable by the owner user only.
+ */
+typedef struct shmring_struct_t
+{
+        shmringheader_t         *header;
+        guint8                  *items;
+        gsize                    mapped_size;
+        gchar                    name[256];
+        gboolean                 writer;     ///< the writer created the object and unlinks it at dtor
+} shmring_t;
+
+//Creates (or recreates) the shared memory object as the writer of the ring, returns NULL if the name is NULL
+shmring_t* shmring_ctor(const gchar* name, gint32 item_size, gint32 items_num);
+//Attaches to a ring created by a writer, returns NULL if there is no ready ring under the name yet
+shmring_t* shmring_open(const gchar* name);
+void shmring_dtor(shmring_t *ring);
+//Copies item_size bytes from item, returns FALSE and counts the item as dropped if the ring is full
+gboolean shmring_push(shmring_t *ring, gconstpointer item);
+//Copies the next item_size bytes into item, returns FALSE if the ring is empty
+gboolean shmring_pop(shmring_t *ring, gpointer item);
+gint32 shmring_readcapacity(shmring_t *ring);
+gint32 shmring_get_item_size(shmring_t *ring);
+guint64 shmring_get_dropped(shmring_t *ring);
+//TRUE if the writer has gone away or died without closing the ring,
+//the reader should drain the ring and open a new one
+gboolean shmring_is_closed(shmring_t *ring);
+
+
+#endif /* INCGUARD_NTRT_LIBRARY_SHMRING_H_ */
@@ -0,0 +1,80 @@
+#include "lib_spscring.h"
+
+#define _next(index) ((gint)((guint)(index) + 1))
+#define _count(head, tail) ((gint32)((guint)(head) - (guint)(tail)))
+
+//------------------------------------------------------------------------------
+
+spscring_t* spscring_ctor(gint32 items_num)
+{
+        spscring_t* result;
+        gint32 length = 1;
+        while(length < items_num){
+                length <<= 1;
+        }
+        result = (spscring_t*) g_malloc0(sizeof(spscring_t));
+        result->items = (gpointer*) g_malloc0(sizeof(gpointer) * length);
+        result->mask = length - 1;
+        result->head = 0;
+        result->tail = 0;
+        return result;
+}//# spscring_ctor end
+
+
+void spscring_dtor(spscring_t* ring)
+{
+        if(ring == NULL){
+                return;
+        }
+        g_free(ring->items);
+        g_free(ring);
+}//# spscring_dtor end
+
+gboolean spscring_push(spscring_t* ring, gpointer item)
+{
+        gint head = ring->head;
+        gint tail = g_atomic_int_get(&ring->tail);
+        if(ring->mask < _count(head, tail)){
+                return FALSE;
+        }
+        ring->items[head & ring->mask] = item;
+        //publishes the item written above to the consumer
+        g_atomic_int_set(&ring->head, _next(head));
+        return TRUE;
+}//# spscring_push end
+
+gpointer spscring_pop(spscring_t* ring)
+{
+        gpointer result;
+        gint tail = ring->tail;
+        gint head = g_atomic_int_get(&ring->head);
+        if(head == tail){
+                return NULL;
+        }
+        result = ring->items[tail & ring->mask];
+        ring->items[tail & ring->mask] = NULL;
+        //hands the slot back to the producer
+        g_atomic_int_set(&ring->tail, _next(tail));
+        return result;
+}//# spscring_pop end
+
+gint32 spscring_readcapacity(spscring_t *ring)
+{
+        return _count(g_atomic_int_get(&ring->head), g_atomic_int_get(&ring->tail));
+}
+
+gboolean spscring_isempty(spscring_t *ring)
+{
+        return g_atomic_int_get(&ring->head) == g_atomic_int_get(&ring->tail);
+}
+
+void spscring_clear(spscring_t *ring, void (*dtor)(gpointer))
+{
+        gpointer item;
+        while((item = spscring_pop(ring)) != NULL){
+                if(dtor == NULL){
+                        continue;
+                }
+                dtor(item);
+        }
+}
@@ -0,0 +1,39 @@
+#ifndef INCGUARD_NTRT_LIBRARY_SPSCRING_H_
+#define INCGUARD_NTRT_LIBRARY_SPSCRING_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <string.h>
+#include <assert.h>
+
+#include <gst/gst.h>
+
+#define SPSCRING_CACHELINE_SIZE 64
+
+/*
+ * Bounded single producer single consumer ring of pointers.
+ * The producer only writes the head and the consumer only writes the tail,
+ * so neither side takes a lock. The two indexes are kept on separate
+ * cache lines to avoid false sharing between the threads.
+ */
+typedef struct spscring_struct_t
+{
+        volatile gint            head;     ///< index of the next slot the producer writes
+        gchar                    head_pad[SPSCRING_CACHELINE_SIZE - sizeof(gint)];
+        volatile gint            tail;     ///< index of the next slot the consumer reads
+        gchar                    tail_pad[SPSCRING_CACHELINE_SIZE - sizeof(gint)];
+        gpointer                *items;    ///< slots, length is a power of two
+        gint32                   mask;     ///< length - 1
+} spscring_t;
+
+spscring_t* spscring_ctor(gint32 items_num);
+void spscring_dtor(spscring_t *ring);
+gboolean spscring_push(spscring_t *ring, gpointer item);
+gpointer spscring_pop(spscring_t *ring);
+gint32 spscring_readcapacity(spscring_t *ring);
+gboolean spscring_isempty(spscring_t *ring);
+void spscring_clear(spscring_t *ring, void (*dtor)(gpointer));
+
+
+#endif /* INCGUARD_NTRT_LIBRARY_SPSCRING_H_ */
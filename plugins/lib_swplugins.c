@@ -1,6 +1,7 @@
 #include "lib_swplugins.h"
 #include <math.h>
 #include "bintree.h"
+#include "lib_ostree.h"
 
 #define now (gst_clock_get_time (sysclock))
 static GstClock* sysclock;
@@ -871,19 +872,22 @@ void swcorr_set_tau(SlidingWindowPlugin* plugin, GstClockTime tau)
 
 typedef struct _swpercentile{
   SlidingWindowPlugin*      base;
-  bintree3_t*               mintree;
-  bintree3_t*               maxtree;
+  ostree_t*                 tree;
   gint32                    percentile;
   double                    ratio;
   gint32                    required;
   bintree3cmp               cmp;
   swpercentilecandidates_t  candidates;
-  gint32                    Mxc,Mnc;
-  gboolean                  sprinted;
   ListenerFilterFunc        filter;
   gpointer                  filter_udata;
 }swpercentile_t;
 
+//Number of items at or below the percentile, the rest are above it
+static gint32 _get_lower_items_num(gint32 total, gint32 percentile)
+{
+  return (total * percentile + 99) / 100;
+}
+
 static void _swpercentile_set_percentile(swpercentile_t* this, gint32 percentile)
 {
   this->percentile      = CONSTRAIN(10,90,percentile);
@@ -905,25 +909,16 @@ static void _swpercentile_set_filter(swpercentile_t* this, ListenerFilterFunc fi
 static swpercentile_t* _swpercentilepriv_ctor(SlidingWindowPlugin* base, gint32 percentile, bintree3cmp cmp)
 {
   swpercentile_t* this;
-  Recycle* bintreenode_recycle = NULL;
-  bintreenode_recycle = make_recycle_for_bintreenode(16);
 
   this = malloc(sizeof(swpercentile_t));
   memset(this, 0, sizeof(swpercentile_t));
   this->base            = base;
   this->cmp             = cmp;
-
-  this->mintree         = make_bintree3_with_recycle(cmp, bintreenode_recycle);
-  this->maxtree         = make_bintree3_with_recycle(cmp, bintreenode_recycle);
-//  this->maxtree         = make_bintree3(cmp);
-//  this->mintree         = make_bintree3(cmp);
-  this->Mxc = this->Mnc = 0;
+  this->tree            = ostree_ctor(cmp);
   this->filter = this->filter_udata = NULL;
 
   _swpercentile_set_percentile(this, percentile);
 
-  g_object_unref(bintreenode_recycle);
-
   return this;
 }
 
@@ -934,7 +929,7 @@ static void _swpercentilepriv_disposer(gpointer target)
     return;
   }
 
-  bintree3_dtor(this->mintree);
+  ostree_dtor(this->tree);
   free(this);
 }
 
@@ -954,76 +949,38 @@ static void _swpercentile_disposer(gpointer target)
 static void _swpercentile_calculate(swpercentile_t *this)
 {
   double ratio;
-  if(this->Mnc + this->Mxc < this->required){
+  gint32 total = ostree_length(this->tree);
+  gint32 Mxc, Mnc;
+  if(total < this->required){
     this->candidates.processed  = FALSE;
     this->candidates.right = this->candidates.left = NULL;
     goto done;
   }
   this->candidates.processed  = TRUE;
-  ratio = (double) this->Mxc / (double) this->Mnc;
+  Mxc = _get_lower_items_num(total, this->percentile);
+  Mnc = total - Mxc;
+  ratio = (double) Mxc / (double) Mnc;
 
   if(this->ratio < ratio){
-    this->candidates.left  = bintree3_get_top_data(this->maxtree);
+    this->candidates.left  = ostree_get_at(this->tree, Mxc - 1);
     this->candidates.right = NULL;
   }else if(ratio < this->ratio){
     this->candidates.left  = NULL;
-    this->candidates.right = bintree3_get_bottom_data(this->mintree);
+    this->candidates.right = ostree_get_at(this->tree, Mxc);
   }else{
-    this->candidates.left  = bintree3_get_top_data(this->maxtree);
-    this->candidates.right = bintree3_get_bottom_data(this->mintree);
+    this->candidates.left  = ostree_get_at(this->tree, Mxc - 1);
+    this->candidates.right = ostree_get_at(this->tree, Mxc);
   }
 
 done:
-  if(0 < bintree3_get_nodenum(this->maxtree)){
-    this->candidates.min = bintree3_get_bottom_data(this->maxtree);
-  }
-  if(0 < bintree3_get_nodenum(this->mintree)){
-    this->candidates.max = bintree3_get_top_data(this->mintree);
+  if(0 < total){
+    this->candidates.min = ostree_get_at(this->tree, 0);
+    this->candidates.max = ostree_get_at(this->tree, total - 1);
   }
 
   swplugin_notify(this->base, &this->candidates);
 }
 
-
-static void _swpercentile_balancer(swpercentile_t *this)
-{
-  double ratio;
-
-  if(this->Mxc + this->Mnc  < this->required){
-    goto done;
-  }
-
-  if(!this->Mnc){
-    goto reduce_maxtree;
-  }
-  if(!this->Mxc){
-    goto reduce_mintree;
-  }
-
-  ratio = (double) this->Mxc / (double) this->Mnc;
-  if(this->ratio < ratio)
-    goto reduce_maxtree;
-  else
-    goto reduce_mintree;
-
-reduce_mintree:
-  ratio = (double) (this->Mxc + 1) / (double) (this->Mnc - 1);
-  if(this->ratio < ratio || this->Mnc < 1) goto done;
-  bintree3_insert_data(this->maxtree, bintree3_delete_bottom_data(this->mintree));
-  --this->Mnc; ++this->Mxc;
-  goto reduce_mintree;
-
-reduce_maxtree:
-  ratio = (double) (this->Mxc - 1) / (double) (this->Mnc + 1);
-  if(ratio < this->ratio || this->Mxc < 1) goto done;
-  bintree3_insert_data(this->mintree, bintree3_delete_top_data(this->maxtree));
-  --this->Mxc; ++this->Mnc;
-  goto reduce_maxtree;
-
-done:
-  return;
-}
-
 static void _swpercentile_on_add(gpointer dataptr, gpointer itemptr)
 {
   swpercentile_t* this;
@@ -1035,21 +992,7 @@ static void _swpercentile_on_add(gpointer dataptr, gpointer itemptr)
     }
   }
 
-  if(!this->Mxc){
-    bintree3_insert_data(this->maxtree, itemptr);
-    ++this->Mxc;
-    goto done;
-  }
-
-  if(this->cmp(itemptr, bintree3_get_top_data(this->maxtree)) <= 0){
-    bintree3_insert_data(this->maxtree, itemptr);
-    ++this->Mxc;
-  }else{
-    bintree3_insert_data(this->mintree, itemptr);
-    ++this->Mnc;
-  }
-done:
-  _swpercentile_balancer(this);
+  ostree_insert(this->tree, itemptr);
   _swpercentile_calculate(this);
 }
 
@@ -1063,15 +1006,10 @@ static void _swpercentile_on_rem(gpointer dataptr, gpointer itemptr)
     }
   }
 
-  if(bintree3_delete_value(this->maxtree, itemptr)){
-    --this->Mxc;
-  }else if(bintree3_delete_value(this->mintree, itemptr)){
-    --this->Mnc;
-  }else{
+  if(!ostree_remove(this->tree, itemptr)){
     GST_WARNING("No data with ptr%p registered by percentiletracker", itemptr);
   }
 
-  _swpercentile_balancer(this);
   _swpercentile_calculate(this);
 
 }
@@ -1116,8 +1054,7 @@ SlidingWindowPlugin* make_swpercentile(
 
 typedef struct _swpercentile2{
   SlidingWindowPlugin* base;
-  Bintree* mintree;
-  Bintree* maxtree;
+  ostree_t* tree;
   gint32 percentile;
   GCompareFunc cmp;
   SWExtractorFunc extractor;
@@ -1136,8 +1073,7 @@ static swpercentile2_t* _swpercentile2priv_ctor(SlidingWindowPlugin* base, gint3
   memset(this, 0, sizeof(swpercentile2_t));
   this->base = base;
   this->cmp = cmp;
-  this->mintree = make_bintree(cmp);
-  this->maxtree = make_bintree(cmp);
+  this->tree = ostree_ctor((OSTreeCmp) cmp);
   this->percentile = percentile;
   this->extractor = extractor;
   this->mean_calcer = mean_calcer;
@@ -1160,8 +1096,7 @@ static void _swpercentile2priv_disposer(gpointer target)
     return;
   }
 
-  g_object_unref(this->maxtree);
-  g_object_unref(this->mintree);
+  ostree_dtor(this->tree);
   free(this);
 }
 
@@ -1177,124 +1112,28 @@ static void _swpercentile2_disposer(gpointer target)
   free(this);
 }
 
-static void _swpercentile2_get_thresholds(swpercentile2_t* this, gint32* maxtreeThreshold, gint32* mintreeThreshold) {
-  gint32 mincounter = bintree_get_size(this->mintree);
-  gint32 maxcounter = bintree_get_size(this->maxtree);
-
-  if (1. < this->ratio) {
-    *maxtreeThreshold = ceil((gdouble) mincounter * this->ratio);
-    *mintreeThreshold = floor((gdouble) maxcounter / this->ratio) + 1;
-  } else if (this->ratio < 1.) {
-    *maxtreeThreshold = floor((gdouble) mincounter * this->ratio) + 1;
-    *mintreeThreshold = ceil((gdouble) maxcounter / this->ratio);
-  } else {
-    *maxtreeThreshold = mincounter + 1;
-    *mintreeThreshold = maxcounter + 1;
-  }
-}
-
-static void _swpercentile2_balancing(swpercentile2_t* this) {
-  Bintree* mintree = this->mintree;
-  Bintree* maxtree = this->maxtree;
-  gint32 mincounter = bintree_get_size(mintree);
-  gint32 maxcounter = bintree_get_size(maxtree);
-  gint32 total = mincounter + maxcounter;
-
-  if (total < this->required) {
-    return;
-  }
-
-  if (mincounter < 1) {
-    bintree_insert_node_at_bottom(mintree, bintree_pop_top_node(maxtree));
-    return;
-  }
-
-  if (maxcounter < 1) {
-    bintree_insert_node_at_top(maxtree, bintree_pop_bottom_node(mintree));
-    return;
-  }
-
-  do{
-    gint32 mintreeNodeLength, maxtreeNodeLength;
-    gint32 maxtreeThreshold, mintreeThreshold;
-    gboolean popFromMinAllowed = 1 < bintree_get_node_counter(mintree);
-    gboolean popFromMaxAllowed = 1 < bintree_get_node_counter(maxtree);
-//    if (this->debug) g_print("%d | %d\n", bintree_get_node_counter(maxtree), bintree_get_node_counter(mintree));
-//    if (!popFromMaxAllowed && !popFromMaxAllowed) {
-//      break;
-//    }
-    mintreeNodeLength = bintree_get_bottom_node(mintree)->values_length;
-    maxtreeNodeLength = bintree_get_top_node(maxtree)->values_length;
-    _swpercentile2_get_thresholds(this, &maxtreeThreshold, &mintreeThreshold);
-    popFromMaxAllowed &= mincounter + maxtreeNodeLength <= mintreeThreshold;
-    popFromMinAllowed &= maxcounter + mintreeNodeLength <= maxtreeThreshold;
-    mincounter = bintree_get_size(mintree);
-    maxcounter = bintree_get_size(maxtree);
-    if (this->debug) {
-      g_print("mintreeNodeLength: %d | popFromMinAllowed: %d | mincounter: %d | %d | %d\n",
-              mintreeNodeLength, popFromMinAllowed, mincounter, mintree->duplicate_counter, mintree->node_counter);
-      g_print("maxtreeNodeLength: %d | popFromMaxAllowed: %d | maxcounter: %d | %d | %d\n",
-          maxtreeNodeLength, popFromMaxAllowed, maxcounter, maxtree->duplicate_counter, maxtree->node_counter);
-    }
-
-    if (maxtreeThreshold < maxcounter && popFromMaxAllowed) {
-      bintree_insert_node_at_bottom(mintree, bintree_pop_top_node(maxtree));
-//      g_print("bintree_insert_node_at_bottom\n");
-      continue;
-    }
-    if (mintreeThreshold < mincounter && popFromMinAllowed) {
-      bintree_insert_node_at_top(maxtree, bintree_pop_bottom_node(mintree));
-//      g_print("bintree_insert_node_at_top\n");
-      continue;
-    }
-    break;
-  }while(1);
-}
-
 static void _swpercentile2_calculate(swpercentile2_t* this) {
     gpointer selected = NULL;
-    Bintree* mintree = this->mintree;
-    Bintree* maxtree = this->maxtree;
-    gint32 mincounter = bintree_get_size(mintree);
-    gint32 maxcounter = bintree_get_size(maxtree);
-    gint32 total = mincounter + maxcounter;
-    BintreeNode* left;
-    BintreeNode* right;
+    gint32 total = ostree_length(this->tree);
+    gint32 maxcounter, mincounter;
+    gpointer left;
+    gpointer right;
     gdouble position;
     gboolean useOneIndex;
 
-    if (total < 1) {
+    if (total < this->required) {
       return;
     }
-    if (total < this->required || mincounter < 1 || maxcounter < 1) {
-      if (!this->estimator || (mincounter < 1 && maxcounter < 1)) {
-        return;
-      }
-      if (mincounter < 1) {
-        left = bintree_get_bottom_node(maxtree);
-        right = bintree_get_top_node(maxtree);
-      } else if (maxcounter < 1){
-        left = bintree_get_bottom_node(mintree);
-        right = bintree_get_top_node(mintree);
-      } else {
-        left = bintree_get_top_node(maxtree);
-        right = bintree_get_bottom_node(mintree);
-      }
-      selected = this->estimator(left->values->data, right->values->data);
-//      swplugin_notify(this->base, this->extractor(selected));
+    maxcounter = _get_lower_items_num(total, this->percentile);
+    mincounter = total - maxcounter;
+    if (mincounter < 1 || maxcounter < 1) {
       return;
     }
 
-    left = bintree_get_top_node(maxtree);
-    right = bintree_get_bottom_node(mintree);
-    if(!left && !right) {
-      return;
-    } else if(!left) {
-      swplugin_notify(this->base, this->extractor(right));
-      return;
-    } else if(!right) {
-      swplugin_notify(this->base, this->extractor(left));
-      return;
+    left = ostree_get_at(this->tree, maxcounter - 1);
+    right = ostree_get_at(this->tree, maxcounter);
+    if (this->debug) {
+      g_print("total: %d | below: %d | above: %d\n", total, maxcounter, mincounter);
     }
 
     position = (gdouble)total * (this->percentile / 100.0);
@@ -1306,28 +1145,28 @@ static void _swpercentile2_calculate(swpercentile2_t* this) {
     if (useOneIndex) {
       gdouble ratio = (gdouble)maxcounter / (gdouble)mincounter;
       if (this->ratio < ratio) {
-        selected = left->values->data;
+        selected = left;
       } else if (ratio < this->ratio) {
-        selected = right->values->data;
+        selected = right;
       } else if (this->ratio < 1) {
-        selected = right->values->data;
+        selected = right;
       } else {
-        selected = left->values->data;
+        selected = left;
       }
     } else {
       // let position = total * (this.percentile / 100.0);
       gint32 index1 = floor(position);
       gint32 index2 = ceil(position + 1.0);
       if (index2 <= maxcounter) {
-        selected = left->values->data;
+        selected = left;
       } else if (index1 <= maxcounter) {
         if(this->mean_calcer) {
-          selected = this->mean_calcer(left->values->data, right->values->data);
+          selected = this->mean_calcer(left, right);
         } else {
-          selected = left->values->data;
+          selected = left;
         }
       } else {
-        selected = right->values->data;
+        selected = right;
       }
     }
 
@@ -1342,61 +1181,15 @@ static void _swpercentile2_on_add(gpointer dataptr, gpointer value)
 {
   swpercentile2_t* this;
   this = dataptr;
-  if (bintree_get_node_counter(this->maxtree) < 1 && bintree_get_node_counter(this->mintree) < 1) {
-    bintree_insert_value(this->maxtree, value);
-    return;
-  }
-
-  if (bintree_get_node_counter(this->maxtree) < 1) {
-    if (this->cmp(value, bintree_get_bottom_value(this->mintree)) < 0) {
-      bintree_insert_value(this->maxtree, value);
-    } else {
-      bintree_insert_value(this->mintree, value);
-    }
-    return;
-  }
-
-  if (bintree_get_node_counter(this->mintree) < 1) {
-    if (this->cmp(bintree_get_top_value(this->maxtree), value) < 0) {
-      bintree_insert_value(this->mintree, value);
-    } else {
-      bintree_insert_value(this->maxtree, value);
-    }
-    return;
-  }
-
-  if (this->cmp(value, bintree_get_top_value(this->maxtree)) <= 0) {
-    bintree_insert_value(this->maxtree, value);
-  } else {
-    bintree_insert_value(this->mintree, value);
-  }
-  PROFILING2("swpercentile2",
-  _swpercentile2_balancing(this);
+  ostree_insert(this->tree, value);
   _swpercentile2_calculate(this);
-  );
-  if (this->debug) {
-    bintree_print(this->maxtree);
-    g_print("-----------------\n");
-    bintree_print(this->mintree);
-    g_print("==================\n");
-  }
 }
 
 static void _swpercentile2_on_rem(gpointer dataptr, gpointer value)
 {
   swpercentile2_t* this;
   this = dataptr;
-  if (bintree_get_size(this->maxtree) < 1) {
-    bintree_delete_value(this->mintree, value);
-    goto done;
-  }
-
-  if (this->cmp(value, bintree_get_top_value(this->maxtree)) <= 0) {
-    bintree_delete_value(this->maxtree, value);
-  } else {
-    bintree_delete_value(this->mintree, value);
-  }
-done:
+  ostree_remove(this->tree, value);
   _swpercentile2_calculate(this);
 }
 
@@ -0,0 +1,234 @@
+#include "lib_timerwheel.h"
+
+#define _mask(level) ((G_GUINT64_CONSTANT(1) << (TIMERWHEEL_SLOT_BITS * (level))) - 1)
+#define _index(tick, level) (((tick) >> (TIMERWHEEL_SLOT_BITS * (level))) & (TIMERWHEEL_SLOTS_NUM - 1))
+//Position of the slot in the slots array, level * TIMERWHEEL_SLOTS_NUM + index
+#define _position(wheel, slot) ((guint)((slot) - &(wheel)->slots[0][0]))
+
+//the occupied slots of a level are kept in a guint64
+G_STATIC_ASSERT(TIMERWHEEL_SLOTS_NUM == 64);
+
+//------------------------------------------------------------------------------
+
+static void _link(timerwheel_t* wheel, timerwheeltimer_t** slot, timerwheeltimer_t* timer)
+{
+        guint position = _position(wheel, slot);
+        wheel->occupied[position >> TIMERWHEEL_SLOT_BITS] |= G_GUINT64_CONSTANT(1) << (position & (TIMERWHEEL_SLOTS_NUM - 1));
+        timer->slot = slot;
+        timer->prev = NULL;
+        timer->next = *slot;
+        if(*slot){
+                (*slot)->prev = timer;
+        }
+        *slot = timer;
+}
+
+static void _unlink(timerwheel_t* wheel, timerwheeltimer_t* timer)
+{
+        guint position;
+        if(timer->prev){
+                timer->prev->next = timer->next;
+        }else{
+                *timer->slot = timer->next;
+        }
+        if(timer->next){
+                timer->next->prev = timer->prev;
+        }
+        if(*timer->slot == NULL){
+                position = _position(wheel, timer->slot);
+                wheel->occupied[position >> TIMERWHEEL_SLOT_BITS] &= ~(G_GUINT64_CONSTANT(1) << (position & (TIMERWHEEL_SLOTS_NUM - 1)));
+        }
+        timer->slot = NULL;
+        timer->prev = timer->next = NULL;
+}
+
+static void _place(timerwheel_t* wheel, timerwheeltimer_t* timer)
+{
+        guint64 tick = timer->expires / wheel->resolution;
+        guint64 diff;
+        gint32 level;
+        if(tick <= wheel->current){
+                _link(wheel, &wheel->slots[0][_index(wheel->current, 0)], timer);
+                return;
+        }
+        diff = tick - wheel->current;
+        for(level = 0; level < TIMERWHEEL_LEVELS_NUM - 1; ++level){
+                if(diff <= _mask(level + 1)){
+                        break;
+                }
+        }
+        if(_mask(level + 1) < diff){
+                //beyond the range of the wheel, it is placed back until it gets in range
+                tick = wheel->current + _mask(level + 1);
+        }
+        _link(wheel, &wheel->slots[level][_index(tick, level)], timer);
+}
+
+//Moves the timers of the higher level slots the wheel turned into one level down
+static void _cascade(timerwheel_t* wheel)
+{
+        timerwheeltimer_t *timer, *next;
+        gint32 level;
+        guint64 index;
+        for(level = 1; level < TIMERWHEEL_LEVELS_NUM; ++level){
+                if((wheel->current & _mask(level)) != 0){
+                        break;
+                }
+                index = _index(wheel->current, level);
+                timer = wheel->slots[level][index];
+                wheel->slots[level][index] = NULL;
+                wheel->occupied[level] &= ~(G_GUINT64_CONSTANT(1) << index);
+                for(; timer; timer = next){
+                        next = timer->next;
+                        timer->slot = NULL;
+                        _place(wheel, timer);
+                }
+        }
+}
+
+//Returns how many slots after the one at index the first occupied slot of the level is
+//(0 if it is that one), or -1 if the level is empty
+static gint32 _first_occupied(timerwheel_t* wheel, gint32 level, guint64 index)
+{
+        guint64 bits = wheel->occupied[level];
+        if(!bits){
+                return -1;
+        }
+        if(index){
+                bits = (bits >> index) | (bits << (TIMERWHEEL_SLOTS_NUM - index));
+        }
+        return __builtin_ctzll(bits);
+}
+
+//Returns the first tick after the current one the wheel has anything to do at:
+//a level 0 slot with timers or a higher level slot with timers to cascade.
+//The slots of level 0 are ticks and the slots of a higher level are turned into
+//at the start of the period they cover, in the order following the current index.
+static guint64 _next_stop(timerwheel_t* wheel)
+{
+        guint64 result = G_MAXUINT64, tick;
+        gint32 level, distance;
+        for(level = 0; level < TIMERWHEEL_LEVELS_NUM; ++level){
+                distance = _first_occupied(wheel, level, (_index(wheel->current, level) + 1) & (TIMERWHEEL_SLOTS_NUM - 1));
+                if(distance < 0){
+                        continue;
+                }
+                tick = ((wheel->current >> (TIMERWHEEL_SLOT_BITS * level)) + 1 + distance) << (TIMERWHEEL_SLOT_BITS * level);
+                result = MIN(result, tick);
+        }
+        return result;
+}
+
+timerwheel_t* timerwheel_ctor(GstClockTime resolution, GstClockTime now)
+{
+        timerwheel_t* result;
+        result = (timerwheel_t*) g_malloc0(sizeof(timerwheel_t));
+        result->resolution = MAX(resolution, 1);
+        result->current = now / result->resolution;
+        return result;
+}//# timerwheel_ctor end
+
+
+void timerwheel_dtor(timerwheel_t* wheel)
+{
+        if(wheel == NULL){
+                return;
+        }
+        g_free(wheel);
+}//# timerwheel_dtor end
+
+void timerwheel_add(timerwheel_t *wheel, timerwheeltimer_t *timer, GstClockTime expires)
+{
+        if(timerwheel_timer_is_pending(timer)){
+                _unlink(wheel, timer);
+        }else{
+                ++wheel->timers_num;
+        }
+        timer->expires = expires;
+        _place(wheel, timer);
+}//# timerwheel_add end
+
+void timerwheel_remove(timerwheel_t *wheel, timerwheeltimer_t *timer)
+{
+        if(!timerwheel_timer_is_pending(timer)){
+                return;
+        }
+        _unlink(wheel, timer);
+        --wheel->timers_num;
+}//# timerwheel_remove end
+
+void timerwheel_advance(timerwheel_t *wheel, GstClockTime now, TimerWheelExpired expired, gpointer udata)
+{
+        guint64 target = now / wheel->resolution, stop;
+        timerwheeltimer_t *timer, *next;
+        if(wheel->timers_num == 0){
+                wheel->current = MAX(wheel->current, target);
+                return;
+        }
+        for(;;){
+                timer = wheel->slots[0][_index(wheel->current, 0)];
+                for(; timer; timer = next){
+                        next = timer->next;
+                        //the current tick may hold timers expire later in the same tick
+                        if(now < timer->expires){
+                                continue;
+                        }
+                        _unlink(wheel, timer);
+                        --wheel->timers_num;
+                        if(expired){
+                                expired(udata, timer);
+                        }
+                }
+                if(target <= wheel->current){
+                        break;
+                }
+                //the slots and cascades between are empty, they are jumped over
+                stop = _next_stop(wheel);
+                if(target < stop){
+                        wheel->current = target;
+                        break;
+                }
+                wheel->current = stop;
+                _cascade(wheel);
+        }
+}//# timerwheel_advance end
+
+GstClockTime timerwheel_get_next_expiry(timerwheel_t *wheel)
+{
+        GstClockTime result = GST_CLOCK_TIME_NONE;
+        timerwheeltimer_t *timer;
+        gint32 level, distance;
+        guint64 start, tick;
+        if(wheel->timers_num == 0){
+                return result;
+        }
+        //the slots of a level cover consecutive periods in the order following the current index,
+        //and no timer expires before the period of its slot starts. The current slot of
+        //level 0 holds the timers due at the current tick, a higher level one is a full turn ahead.
+        //The slots are looked into until one starts after the earliest expiry found, which is
+        //right after the first one, except for the timers placed back from beyond the range.
+        for(level = 0; level < TIMERWHEEL_LEVELS_NUM; ++level){
+                start = _index(wheel->current, level);
+                if(0 < level){
+                        start = (start + 1) & (TIMERWHEEL_SLOTS_NUM - 1);
+                }
+                distance = _first_occupied(wheel, level, start);
+                for(; 0 <= distance && distance < TIMERWHEEL_SLOTS_NUM;
+                      distance += 1 + _first_occupied(wheel, level, (start + distance + 1) & (TIMERWHEEL_SLOTS_NUM - 1))){
+                        if(level == 0){
+                                tick = wheel->current + distance;
+                        }else{
+                                tick = ((wheel->current >> (TIMERWHEEL_SLOT_BITS * level)) + 1 + distance) << (TIMERWHEEL_SLOT_BITS * level);
+                        }
+                        if(GST_CLOCK_TIME_IS_VALID(result) && result <= tick * wheel->resolution){
+                                break;
+                        }
+                        for(timer = wheel->slots[level][(start + distance) & (TIMERWHEEL_SLOTS_NUM - 1)]; timer; timer = timer->next){
+                                if(!GST_CLOCK_TIME_IS_VALID(result) || timer->expires < result){
+                                        result = timer->expires;
+                                }
+                        }
+                }
+        }
+        return result;
+}//# timerwheel_get_next_expiry end
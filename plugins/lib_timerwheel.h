@@ -0,0 +1,63 @@
+#ifndef INCGUARD_NTRT_LIBRARY_TIMERWHEEL_H_
+#define INCGUARD_NTRT_LIBRARY_TIMERWHEEL_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/gst.h>
+
+#define TIMERWHEEL_SLOT_BITS 6
+#define TIMERWHEEL_SLOTS_NUM (1 << TIMERWHEEL_SLOT_BITS)
+#define TIMERWHEEL_LEVELS_NUM 4
+
+typedef struct timerwheeltimer_struct_t
+{
+        struct timerwheeltimer_struct_t  *prev;
+        struct timerwheeltimer_struct_t  *next;
+        struct timerwheeltimer_struct_t **slot;     ///< head of the slot list the timer is in, NULL if not pending
+        GstClockTime                      expires;
+        gpointer                          udata;
+} timerwheeltimer_t;
+
+typedef void (*TimerWheelExpired)(gpointer udata, timerwheeltimer_t *timer);
+
+/*
+ * Hierarchical timer wheel.
+ * Level 0 has a slot for every tick of the resolution, and every further level
+ * covers TIMERWHEEL_SLOTS_NUM times longer period per slot than the one below.
+ * A timer is added into the lowest level its expiration time fits into
+ * and moved down a level whenever the wheel turns into its slot,
+ * so adding and removing a timer is O(1). Every level has a bitmap of its
+ * occupied slots, advancing jumps from one occupied slot to the next instead
+ * of walking the ticks between, so it is O(levels) per occupied slot it passes
+ * and O(1) per expired timer. Timers are embedded into the objects they belong to.
+ */
+typedef struct timerwheel_struct_t
+{
+        GstClockTime             resolution;     ///< time covered by a level 0 slot
+        guint64                  current;        ///< tick the wheel is advanced to
+        gint32                   timers_num;
+        timerwheeltimer_t       *slots[TIMERWHEEL_LEVELS_NUM][TIMERWHEEL_SLOTS_NUM];
+        guint64                  occupied[TIMERWHEEL_LEVELS_NUM];   ///< bit i is set if slot i of the level has a timer
+} timerwheel_t;
+
+timerwheel_t* timerwheel_ctor(GstClockTime resolution, GstClockTime now);
+void timerwheel_dtor(timerwheel_t *wheel);
+//Adds or moves the timer to expire at the given time
+void timerwheel_add(timerwheel_t *wheel, timerwheeltimer_t *timer, GstClockTime expires);
+void timerwheel_remove(timerwheel_t *wheel, timerwheeltimer_t *timer);
+//Expires the timers due at now, expired can be NULL
+void timerwheel_advance(timerwheel_t *wheel, GstClockTime now, TimerWheelExpired expired, gpointer udata);
+//Returns the earliest expiration time or GST_CLOCK_TIME_NONE if there is no pending timer.
+//Only the first occupied slot of every level is looked into, unless timers
+//placed back from beyond the range of the wheel are ahead of it.
+GstClockTime timerwheel_get_next_expiry(timerwheel_t *wheel);
+
+static inline gboolean timerwheel_timer_is_pending(timerwheeltimer_t *timer)
+{
+        return timer->slot != NULL;
+}
+
+
+#endif /* INCGUARD_NTRT_LIBRARY_TIMERWHEEL_H_ */
@@ -0,0 +1,100 @@
+#include "lib_typedsw.h"
+#include <stdarg.h>
+
+//------------------------------------------------------------------------------
+
+void typedsw_init(typedsw_t* base, gint32 num_limit, GstClockTime threshold)
+{
+        if(num_limit < 1){
+                g_warning("Num limit can not be zero");
+                num_limit = 32;
+        }
+        memset(base, 0, sizeof(typedsw_t));
+        base->sysclock  = gst_system_clock_obtain();
+        base->threshold = threshold;
+        base->length    = num_limit;
+        base->act_limit = num_limit;
+}//# typedsw_init end
+
+void typedsw_deinit(typedsw_t* base)
+{
+        g_list_free_full(base->plugins, swplugin_dtor);
+        base->plugins = NULL;
+        g_object_unref(base->sysclock);
+}//# typedsw_deinit end
+
+void typedsw_add_plugin(typedsw_t* base, SlidingWindowPlugin* plugin)
+{
+        base->plugins = g_list_append(base->plugins, plugin);
+}
+
+void typedsw_rem_plugin(typedsw_t* base, SlidingWindowPlugin* plugin)
+{
+        base->plugins = g_list_remove(base->plugins, plugin);
+}
+
+void typedsw_add_plugins(typedsw_t* base, ...)
+{
+        va_list arguments;
+        SlidingWindowPlugin* plugin;
+        va_start(arguments, base);
+        for(plugin = va_arg(arguments, SlidingWindowPlugin*); plugin; plugin = va_arg(arguments, SlidingWindowPlugin*)){
+                typedsw_add_plugin(base, plugin);
+        }
+        va_end(arguments);
+}
+
+void typedsw_set_threshold(typedsw_t* base, GstClockTime threshold)
+{
+        base->threshold = threshold;
+}
+
+void typedsw_set_act_limit(typedsw_t* base, gint32 act_limit)
+{
+        base->act_limit = MIN(act_limit, base->length);
+}
+
+void typedsw_set_min_itemnum(typedsw_t* base, gint32 min_itemnum)
+{
+        base->min_itemnum = min_itemnum;
+}
+
+gint32 typedsw_get_counter(typedsw_t* base)
+{
+        return base->count;
+}
+
+gboolean typedsw_is_empty(typedsw_t* base)
+{
+        return base->count < 1;
+}
+
+void typedsw_pipe_add(typedsw_t* base, gpointer value)
+{
+        GList* it;
+        SlidingWindowPlugin* plugin;
+        for(it = base->plugins; it; it = it->next){
+                plugin = it->data;
+                if(plugin->add_pipe){
+                        plugin->add_pipe(plugin->add_data, value);
+                }
+        }
+}
+
+void typedsw_pipe_rem(typedsw_t* base, gpointer value)
+{
+        GList* it;
+        SlidingWindowPlugin* plugin;
+        for(it = base->plugins; it; it = it->next){
+                plugin = it->data;
+                if(plugin->rem_pipe){
+                        plugin->rem_pipe(plugin->rem_data, value);
+                }
+        }
+}
+
+TYPEDSW_DEFINE(, int32, gint32)
+TYPEDSW_DEFINE(, int64, gint64)
+TYPEDSW_DEFINE(, uint32, guint32)
+TYPEDSW_DEFINE(, uint64, guint64)
+TYPEDSW_DEFINE(, double, gdouble)
@@ -0,0 +1,173 @@
+#ifndef INCGUARD_NTRT_LIBRARY_TYPEDSW_H_
+#define INCGUARD_NTRT_LIBRARY_TYPEDSW_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/gst.h>
+#include "slidingwindow.h"
+
+/*
+ * Sliding window of samples stored by value.
+ * Items are {value, added} pairs in one contiguous ring, so adding a sample
+ * does not allocate and the samples are not boxed as SlidingWindow does.
+ * The same SlidingWindowPlugins (sum, avg, std, percentile, minmax, ...) can be attached,
+ * they get a pointer to the value in the ring, which stays valid until the rem pipe
+ * of the plugin is called for it.
+ * The typed part is generated by TYPEDSW_DEFINE, the rest is shared through typedsw_t.
+ */
+typedef struct typedsw_struct_t
+{
+        GstClock*                sysclock;
+        GstClockTime             threshold;  ///< items older than this are obsolated, 0 if there is no time limit
+        GstClockTime             refreshed;  ///< time of the last obsolation
+        gint32                   length;     ///< number of items the ring can hold
+        gint32                   act_limit;
+        gint32                   min_itemnum;
+        gint32                   start;      ///< index of the oldest item
+        gint32                   count;
+        GList*                   plugins;
+} typedsw_t;
+
+#define TYPEDSW(sw) (&(sw)->base)
+
+void typedsw_init(typedsw_t* base, gint32 num_limit, GstClockTime threshold);
+void typedsw_deinit(typedsw_t* base);
+void typedsw_add_plugin(typedsw_t* base, SlidingWindowPlugin* plugin);
+void typedsw_rem_plugin(typedsw_t* base, SlidingWindowPlugin* plugin);
+void typedsw_add_plugins(typedsw_t* base, ...);
+void typedsw_set_threshold(typedsw_t* base, GstClockTime threshold);
+void typedsw_set_act_limit(typedsw_t* base, gint32 act_limit);
+void typedsw_set_min_itemnum(typedsw_t* base, gint32 min_itemnum);
+gint32 typedsw_get_counter(typedsw_t* base);
+gboolean typedsw_is_empty(typedsw_t* base);
+//Calls the add or rem pipes of the plugins with the value
+void typedsw_pipe_add(typedsw_t* base, gpointer value);
+void typedsw_pipe_rem(typedsw_t* base, gpointer value);
+
+#define TYPEDSW_TYPE(name, type)                                        \
+typedef struct typedsw_##name##_item_struct_t                           \
+{                                                                       \
+        type                     value;                                 \
+        GstClockTime             added;                                 \
+} typedsw_##name##_item_t;                                              \
+                                                                        \
+typedef struct typedsw_##name##_struct_t                                \
+{                                                                       \
+        typedsw_t                base;                                  \
+        typedsw_##name##_item_t* items;                                 \
+} typedsw_##name##_t;
+
+#define TYPEDSW_DECLARE(name, type)                                     \
+TYPEDSW_TYPE(name, type)                                                \
+typedsw_##name##_t* typedsw_##name##_ctor(gint32 num_limit, GstClockTime threshold); \
+void typedsw_##name##_dtor(typedsw_##name##_t* this);                   \
+void typedsw_##name##_add(typedsw_##name##_t* this, type value);        \
+void typedsw_##name##_refresh(typedsw_##name##_t* this);                \
+void typedsw_##name##_clear(typedsw_##name##_t* this);                  \
+type* typedsw_##name##_peek_oldest(typedsw_##name##_t* this);           \
+type* typedsw_##name##_peek_newest(typedsw_##name##_t* this);
+
+//Generates the typed functions, the type must be declared before by TYPEDSW_TYPE or TYPEDSW_DECLARE
+#define TYPEDSW_DEFINE(scope, name, type)                               \
+scope G_GNUC_UNUSED typedsw_##name##_t* typedsw_##name##_ctor(gint32 num_limit, GstClockTime threshold) \
+{                                                                       \
+        typedsw_##name##_t* result = g_malloc0(sizeof(typedsw_##name##_t)); \
+        typedsw_init(&result->base, num_limit, threshold);              \
+        result->items = g_malloc0(sizeof(typedsw_##name##_item_t) * result->base.length); \
+        return result;                                                  \
+}                                                                       \
+                                                                        \
+static void _typedsw_##name##_rem(typedsw_##name##_t* this)             \
+{                                                                       \
+        typedsw_##name##_item_t* item = this->items + this->base.start; \
+        typedsw_pipe_rem(&this->base, &item->value);                    \
+        if(++this->base.start == this->base.length){                    \
+                this->base.start = 0;                                   \
+        }                                                               \
+        --this->base.count;                                             \
+}                                                                       \
+                                                                        \
+scope G_GNUC_UNUSED void typedsw_##name##_clear(typedsw_##name##_t* this) \
+{                                                                       \
+        while(0 < this->base.count){                                    \
+                _typedsw_##name##_rem(this);                            \
+        }                                                               \
+}                                                                       \
+                                                                        \
+scope G_GNUC_UNUSED void typedsw_##name##_dtor(typedsw_##name##_t* this) \
+{                                                                       \
+        if(this == NULL){                                               \
+                return;                                                 \
+        }                                                               \
+        typedsw_deinit(&this->base);                                    \
+        g_free(this->items);                                            \
+        g_free(this);                                                   \
+}                                                                       \
+                                                                        \
+static void _typedsw_##name##_obsolate(typedsw_##name##_t* this)        \
+{                                                                       \
+        while(this->base.length <= this->base.count || this->base.act_limit < this->base.count){ \
+                _typedsw_##name##_rem(this);                            \
+        }                                                               \
+        if(!this->base.threshold || this->base.refreshed < this->base.threshold){ \
+                return;                                                 \
+        }                                                               \
+        while(this->base.min_itemnum < this->base.count &&              \
+              this->items[this->base.start].added < this->base.refreshed - this->base.threshold){ \
+                _typedsw_##name##_rem(this);                            \
+        }                                                               \
+}                                                                       \
+                                                                        \
+scope G_GNUC_UNUSED void typedsw_##name##_refresh(typedsw_##name##_t* this) \
+{                                                                       \
+        this->base.refreshed = clocktick_now(this->base.sysclock);      \
+        _typedsw_##name##_obsolate(this);                               \
+}                                                                       \
+                                                                        \
+scope G_GNUC_UNUSED void typedsw_##name##_add(typedsw_##name##_t* this, type value) \
+{                                                                       \
+        typedsw_##name##_item_t* item;                                  \
+        gint32 index;                                                   \
+        typedsw_##name##_refresh(this);                                 \
+        index = this->base.start + this->base.count;                    \
+        if(this->base.length <= index){                                 \
+                index -= this->base.length;                             \
+        }                                                               \
+        item = this->items + index;                                     \
+        item->value = value;                                            \
+        item->added = this->base.refreshed;                             \
+        ++this->base.count;                                             \
+        typedsw_pipe_add(&this->base, &item->value);                    \
+}                                                                       \
+                                                                        \
+scope G_GNUC_UNUSED type* typedsw_##name##_peek_oldest(typedsw_##name##_t* this) \
+{                                                                       \
+        if(this->base.count < 1){                                       \
+                return NULL;                                            \
+        }                                                               \
+        return &this->items[this->base.start].value;                    \
+}                                                                       \
+                                                                        \
+scope G_GNUC_UNUSED type* typedsw_##name##_peek_newest(typedsw_##name##_t* this) \
+{                                                                       \
+        gint32 index;                                                   \
+        if(this->base.count < 1){                                       \
+                return NULL;                                            \
+        }                                                               \
+        index = this->base.start + this->base.count - 1;                \
+        if(this->base.length <= index){                                 \
+                index -= this->base.length;                             \
+        }                                                               \
+        return &this->items[index].value;                               \
+}
+
+TYPEDSW_DECLARE(int32, gint32)
+TYPEDSW_DECLARE(int64, gint64)
+TYPEDSW_DECLARE(uint32, guint32)
+TYPEDSW_DECLARE(uint64, guint64)
+TYPEDSW_DECLARE(double, gdouble)
+
+
+#endif /* INCGUARD_NTRT_LIBRARY_TYPEDSW_H_ */
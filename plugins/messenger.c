@@ -55,7 +55,6 @@ messenger_class_init (MessengerClass * klass)
 
   GST_DEBUG_CATEGORY_INIT (messenger_debug_category, "rndctrler", 0,
       "MpRTP Receiving Controller");
-
 }
 
 
@@ -63,14 +62,19 @@ void
 messenger_finalize (GObject * object)
 {
   Messenger *this = MESSENGER (object);
-  while(!g_queue_is_empty(this->messages)){
-    g_slice_free1(this->block_size, g_queue_pop_head(this->messages));
+  gpointer block;
+  while((block = mpmcring_pop(this->messages)) != NULL){
+    g_slice_free1(this->block_size, block);
+  }
+  mpmcring_dtor(this->messages);
+  while((block = g_queue_pop_head(this->overflow)) != NULL){
+    g_slice_free1(this->block_size, block);
   }
-  g_queue_free(this->messages);
-  while(!g_queue_is_empty(this->recycle)){
-    g_slice_free1(this->block_size, g_queue_pop_head(this->recycle));
+  g_queue_free(this->overflow);
+  while((block = mpmcring_pop(this->recycle)) != NULL){
+    g_slice_free1(this->block_size, block);
   }
-//  g_object_unref(this->recycle);
+  mpmcring_dtor(this->recycle);
   g_object_unref(this->sysclock);
 }
 
@@ -81,8 +85,9 @@ messenger_init (Messenger * this)
   g_cond_init(&this->cond);
   g_cond_init(&this->waiting_signal);
   this->sysclock      = gst_system_clock_obtain();
-  this->messages      = g_queue_new();
-  this->recycle       = g_queue_new();
+  this->messages      = mpmcring_ctor(MESSENGER_MESSAGES_RING_LENGTH);
+  this->overflow      = g_queue_new();
+  this->recycle       = mpmcring_ctor(MESSENGER_RECYCLE_RING_LENGTH);
   this->recycle_limit = 1000;
 }
 
@@ -95,75 +100,154 @@ Messenger *make_messenger(gsize block_size)
 
 void messenger_set_recycle_limit(Messenger *this, guint recycle_limit)
 {
-  g_mutex_lock (&this->mutex);
   this->recycle_limit = recycle_limit;
-  g_mutex_unlock (&this->mutex);
 }
 
-gpointer messenger_pop_block (Messenger *this)
+static gboolean _is_empty(Messenger *this)
 {
-  gpointer result = NULL;
+  return mpmcring_isempty(this->messages) && !g_atomic_int_get(&this->overflowed);
+}
 
-  g_mutex_lock (&this->mutex);
-  while(g_queue_is_empty(this->messages)){
-    g_cond_wait (&this->cond, &this->mutex);
+//Messages in the ring are older than the ones in the overflow queue,
+//as producers do not use the ring while the overflow queue is not empty.
+static gpointer _pop(Messenger *this, gboolean locked)
+{
+  gpointer result = mpmcring_pop(this->messages);
+  if(G_LIKELY(result != NULL) || !g_atomic_int_get(&this->overflowed)){
+    return result;
+  }
+  if(!locked){
+    g_mutex_lock(&this->mutex);
+  }
+  //a producer may have got into the ring just before an other one overflowed
+  result = mpmcring_pop(this->messages);
+  if(!result && (result = g_queue_pop_head(this->overflow)) != NULL){
+    g_atomic_int_add(&this->overflowed, -1);
+  }
+  if(!locked){
+    g_mutex_unlock(&this->mutex);
   }
-  result = g_queue_pop_head(this->messages);
-  g_mutex_unlock (&this->mutex);
   return result;
 }
 
-
-gpointer messenger_try_pop_block(Messenger *this)
+//Sleeps if there is no message until one is pushed or end_time passes (never if it is negative).
+//Returns FALSE if it has timed out. The caller holds the mutex.
+static gboolean _wait_unlocked(Messenger *this, gint64 end_time)
 {
-  gpointer result = NULL;
-  g_mutex_lock(&this->mutex);
-  if(!g_queue_is_empty(this->messages)){
-    result = g_queue_pop_head(this->messages);
+  gboolean result = TRUE;
+  g_atomic_int_set(&this->waiting, TRUE);
+  //pairs with the fence in _push, either the producer sees the flag or the message is seen here.
+  //The overflow queue is filled under the mutex, so it can not change meanwhile.
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if(_is_empty(this)){
+    if(end_time < 0){
+      g_cond_wait(&this->cond, &this->mutex);
+    }else{
+      result = g_cond_wait_until(&this->cond, &this->mutex, end_time);
+    }
   }
-  g_mutex_unlock(&this->mutex);
+  g_atomic_int_set(&this->waiting, FALSE);
   return result;
 }
 
-
-guint messenger_get_length_with_timeout (Messenger *this, gint64 microseconds)
+//A pending wake up is served before the messages, as it was when the messages were kept in a GQueue
+static gpointer _pop_or_wait_unlocked(Messenger *this, gint64 end_time, gboolean wake_up)
 {
-  gint64 end_time;
-  guint result = 0;
-
-  g_mutex_lock (&this->mutex);
-  end_time = g_get_monotonic_time () + microseconds;
-  while (g_queue_is_empty(this->messages)){
-    if (!g_cond_wait_until (&this->cond, &this->mutex, end_time)){
+  gpointer result;
+  for(;;){
+    if(wake_up && this->woken_up){
+      //the wake up is consumed, so the caller can check why it was woken up and wait again
+      g_atomic_int_set(&this->woken_up, FALSE);
+      return NULL;
+    }
+    if((result = _pop(this, TRUE)) != NULL){
+      return result;
+    }
+    if(!_wait_unlocked(this, end_time)){
       // timeout has passed.
-      goto done;
+      return _pop(this, TRUE);
     }
   }
-  result = g_queue_get_length(this->messages);
-done:
+}
+
+static gpointer _pop_or_wait(Messenger *this, gint64 end_time, gboolean wake_up)
+{
+  gpointer result;
+  if(!wake_up || !g_atomic_int_get(&this->woken_up)){
+    result = _pop(this, FALSE);
+    if(result){
+      return result;
+    }
+  }
+  g_mutex_lock (&this->mutex);
+  result = _pop_or_wait_unlocked(this, end_time, wake_up);
   g_mutex_unlock (&this->mutex);
   return result;
 }
 
-gpointer messenger_pop_block_with_timeout (Messenger *this, gint64 microseconds)
+static void _push(Messenger* this, gpointer message, gboolean locked)
+{
+  if(G_UNLIKELY(g_atomic_int_get(&this->overflowed)) || !mpmcring_push(this->messages, message)){
+    if(!locked){
+      g_mutex_lock(&this->mutex);
+    }
+    g_queue_push_tail(this->overflow, message);
+    g_atomic_int_inc(&this->overflowed);
+    g_cond_signal(&this->cond);
+    if(!locked){
+      g_mutex_unlock(&this->mutex);
+    }
+    return;
+  }
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if(!g_atomic_int_get(&this->waiting)){
+    return;
+  }
+  if(!locked){
+    g_mutex_lock(&this->mutex);
+  }
+  g_cond_signal(&this->cond);
+  if(!locked){
+    g_mutex_unlock(&this->mutex);
+  }
+}
+
+gpointer messenger_pop_block (Messenger *this)
+{
+  return _pop_or_wait(this, -1, FALSE);
+}
+
+
+gpointer messenger_try_pop_block(Messenger *this)
+{
+  return _pop(this, FALSE);
+}
+
+
+guint messenger_get_length_with_timeout (Messenger *this, gint64 microseconds)
 {
   gint64 end_time;
-  gpointer result = NULL;
+  guint result = 0;
 
   g_mutex_lock (&this->mutex);
   end_time = g_get_monotonic_time () + microseconds;
-  while (g_queue_is_empty(this->messages)){
-    if (!g_cond_wait_until (&this->cond, &this->mutex, end_time)){
+  while (_is_empty(this)){
+    if (!_wait_unlocked(this, end_time)){
       // timeout has passed.
       goto done;
     }
   }
-  result = g_queue_pop_head(this->messages);
+  result = mpmcring_readcapacity(this->messages) + g_atomic_int_get(&this->overflowed);
 done:
   g_mutex_unlock (&this->mutex);
   return result;
 }
 
+gpointer messenger_pop_block_with_timeout (Messenger *this, gint64 microseconds)
+{
+  return _pop_or_wait(this, g_get_monotonic_time () + microseconds, FALSE);
+}
+
 static void _wait(Messenger *this, GstClockTime end)
 {
   GstClockTime now = _now(this);
@@ -180,12 +264,13 @@ static void _wait(Messenger *this, GstClockTime end)
 
 void messenger_wait_before_pop_all (Messenger *this, GstClockTime waiting, GQueue* queue)
 {
+  gpointer message;
   g_mutex_lock (&this->mutex);
   if(0) _wait(this, _now(this) + waiting);
 
   g_cond_wait_until(&this->waiting_signal, &this->mutex, g_get_monotonic_time() + waiting / 1000);
-  while (!g_queue_is_empty(this->messages)){
-      g_queue_push_tail(queue, g_queue_pop_head(this->messages));
+  while ((message = _pop(this, TRUE)) != NULL){
+      g_queue_push_tail(queue, message);
   }
   g_mutex_unlock (&this->mutex);
 }
@@ -194,54 +279,53 @@ void messenger_release_wait(Messenger* this) {
   g_cond_broadcast(&this->waiting_signal);
 }
 
+gpointer messenger_pop_block_or_wake_up(Messenger *this)
+{
+  return _pop_or_wait(this, -1, TRUE);
+}
+
+void messenger_wake_up(Messenger* this)
+{
+  g_mutex_lock (&this->mutex);
+  g_atomic_int_set(&this->woken_up, TRUE);
+  g_cond_broadcast(&this->cond);
+  g_mutex_unlock (&this->mutex);
+}
+
 
 void messenger_push_block(Messenger* this, gpointer message)
 {
-  gboolean was_empty;
-  g_mutex_lock(&this->mutex);
-  was_empty = g_queue_is_empty(this->messages);
-  g_queue_push_tail(this->messages, message);
-  if(was_empty){
-    g_cond_signal(&this->cond);
-  }
-  g_mutex_unlock(&this->mutex);
+  _push(this, message, FALSE);
 }
 
 
 void messenger_throw_block(Messenger* this, gpointer message)
 {
-  g_mutex_lock(&this->mutex);
-  if(0 < this->recycle_limit && this->recycle_limit < g_queue_get_length(this->recycle)){
+  if(0 < this->recycle_limit && this->recycle_limit <= mpmcring_readcapacity(this->recycle)){
     g_slice_free1(this->block_size, message);
-    goto done;
+    return;
   }
   memset(message, 0, this->block_size);
-  g_queue_push_tail(this->recycle, message);
-done:
-  g_mutex_unlock(&this->mutex);
+  if(!mpmcring_push(this->recycle, message)){
+    g_slice_free1(this->block_size, message);
+  }
 }
 
 void messenger_throw_blocks(Messenger* this, GQueue* messages)
 {
-  g_mutex_lock(&this->mutex);
   while(!g_queue_is_empty(messages)){
-    messenger_throw_block_unlocked(this, g_queue_pop_head(messages));
+    messenger_throw_block(this, g_queue_pop_head(messages));
   }
-  g_mutex_unlock(&this->mutex);
 }
 
 
 gpointer messenger_retrieve_block(Messenger *this)
 {
-  gpointer result;
-  g_mutex_lock(&this->mutex);
-  if(g_queue_is_empty(this->recycle)){
+  gpointer result = mpmcring_pop(this->recycle);
+  if(!result){
     result = g_slice_alloc0(this->block_size);
-  }else{
-    result = g_queue_pop_head(this->recycle);
   }
   //shape
-  g_mutex_unlock(&this->mutex);
   return result;
 }
 
@@ -260,80 +344,43 @@ void messenger_unlock(Messenger* this)
 
 gpointer messenger_pop_block_unlocked (Messenger *this)
 {
-  gpointer result = g_queue_pop_head(this->messages);;
-  while (!result){
-    g_cond_wait (&this->cond, &this->mutex);
-    if(g_queue_is_empty(this->messages)){
-      continue;
-    }
-    result = g_queue_pop_head(this->messages);
-  }
-  return result;
+  return _pop_or_wait_unlocked(this, -1, FALSE);
+}
+
+
+gpointer messenger_pop_block_or_wake_up_unlocked (Messenger *this)
+{
+  return _pop_or_wait_unlocked(this, -1, TRUE);
 }
 
 
 gpointer messenger_try_pop_block_unlocked (Messenger *this)
 {
-  gpointer result = NULL;
-  if(!g_queue_is_empty(this->messages)){
-    result = g_queue_pop_head(this->messages);
-  }
-  return result;
+  return _pop(this, TRUE);
 }
 
 
 gpointer messenger_pop_block_with_timeout_unlocked (Messenger *this, gint64 microseconds)
 {
-  gint64 end_time;
-  gpointer result = NULL;
-
-  end_time = g_get_monotonic_time () + microseconds;
-  while (g_queue_is_empty(this->messages)){
-    if (!g_cond_wait_until (&this->cond, &this->mutex, end_time)){
-      // timeout has passed.
-      goto done;
-    }
-  }
-  result = g_queue_pop_head(this->messages);
-done:
-  return result;
+  return _pop_or_wait_unlocked(this, g_get_monotonic_time () + microseconds, FALSE);
 }
 
 
 void messenger_push_block_unlocked(Messenger* this, gpointer message)
 {
-  gboolean was_empty;
-  was_empty = g_queue_is_empty(this->messages);
-  g_queue_push_tail(this->messages, message);
-  if(was_empty){
-    g_cond_signal(&this->cond);
-  }
+  _push(this, message, TRUE);
 }
 
 
 void messenger_throw_block_unlocked(Messenger* this, gpointer message)
 {
-  if(0 < this->recycle_limit && this->recycle_limit < g_queue_get_length(this->recycle)){
-    g_slice_free1(this->block_size, message);
-    goto done;
-  }
-  memset(message, 0, this->block_size);
-  g_queue_push_tail(this->recycle, message);
-done:
-  return;
+  messenger_throw_block(this, message);
 }
 
 
 gpointer messenger_retrieve_block_unlocked(Messenger *this)
 {
-  gpointer result;
-  if(g_queue_is_empty(this->recycle)){
-    result = g_slice_alloc0(this->block_size);
-  }else{
-    result = g_queue_pop_head(this->recycle);
-  }
-  //shape
-  return result;
+  return messenger_retrieve_block(this);
 }
 
 //------------------------------------------------------------
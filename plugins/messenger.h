@@ -10,6 +10,7 @@
 
 #include <gst/gst.h>
 #include "lib_datapuffer.h"
+#include "lib_mpmcring.h"
 
 typedef struct _Messenger Messenger;
 typedef struct _MessengerClass MessengerClass;
@@ -25,13 +26,27 @@ typedef struct _MessengerClass MessengerClass;
 
 typedef void (*MessengerItemShaper)(gpointer result,gpointer udata);
 
+//Messages pushed while this many are waiting to be popped go to the overflow queue
+#define MESSENGER_MESSAGES_RING_LENGTH 8192
+#define MESSENGER_RECYCLE_RING_LENGTH 1024
+
+//Messages and thrown blocks are kept in lock-free rings, any thread can push,
+//retrieve and throw blocks without the mutex. The mutex and the cond are only
+//used to put the consumer to sleep when there is no message, and producers
+//only take the mutex to signal if the consumer is sleeping.
+//A producer never waits for the consumer: if the ring is full, the message and
+//every later one goes to the overflow queue under the mutex until it is drained,
+//so the order of the messages is kept.
+//The _unlocked functions are for callers holding the lock by messenger_lock.
 struct _Messenger
 {
   GObject             object;
   GstClock*           sysclock;
   GMutex              mutex;
-  GQueue*             messages;
-  GQueue*             recycle;
+  mpmcring_t*         messages;
+  GQueue*             overflow;
+  volatile gint       overflowed;     ///< number of messages in the overflow queue
+  mpmcring_t*         recycle;
 
   GCond               cond;
   GCond               waiting_signal;
@@ -39,6 +54,8 @@ struct _Messenger
   gsize               block_size;
 
   guint               recycle_limit;
+  volatile gint       waiting;
+  volatile gint       woken_up;
 
 };
 
@@ -58,6 +75,10 @@ gpointer messenger_pop_block_with_timeout (Messenger *this, gint64 microseconds)
 void messenger_push_block(Messenger* this, gpointer message);
 void messenger_wait_before_pop_all (Messenger *this, GstClockTime waiting, GQueue* queue);
 void messenger_release_wait(Messenger* this);
+//Blocks until a message arrives or messenger_wake_up is called, in the latter case returns NULL.
+//A pending wake up is returned before the messages waiting in the messenger.
+gpointer messenger_pop_block_or_wake_up(Messenger *this);
+void messenger_wake_up(Messenger* this);
 void messenger_throw_block(Messenger* this, gpointer message);
 void messenger_throw_blocks(Messenger* this, GQueue* messages);
 gpointer messenger_retrieve_block(Messenger *this);
@@ -67,6 +88,7 @@ void messenger_unlock(Messenger* this);
 gpointer messenger_pop_block_unlocked (Messenger *this);
 gpointer messenger_try_pop_block_unlocked (Messenger *this);
 gpointer messenger_pop_block_with_timeout_unlocked (Messenger *this, gint64 microseconds);
+gpointer messenger_pop_block_or_wake_up_unlocked (Messenger *this);
 void messenger_push_block_unlocked(Messenger* this, gpointer message);
 void messenger_throw_block_unlocked(Messenger* this, gpointer message);
 gpointer messenger_retrieve_block_unlocked(Messenger *this);
@@ -1,7 +1,12 @@
 #include "mprtputils.h"
 #include <string.h>
 
-static void _test_do_bitxor(void);
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BITXOR_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+typedef void (*BitXorNFunc)(guint8* to, guint8** from, gint32 from_num, gint32 length);
 
 void do_bitxor(guint8* to, guint8* from, gint32 length) {
   gint i;
@@ -28,12 +33,112 @@ void do_bitxor(guint8* to, guint8* from, gint32 length) {
   }
 }
 
+static void _do_bitxor_n_tail(guint8* to, guint8** from, gint32 from_num, gint32 start, gint32 length) {
+  gint32 i, j;
+  guint8 acc;
+  for(i = start; i < length; ++i){
+    acc = from[0][i];
+    for(j = 1; j < from_num; ++j){
+      acc ^= from[j][i];
+    }
+    to[i] = acc;
+  }
+}
+
+static void _do_bitxor_n_scalar(guint8* to, guint8** from, gint32 from_num, gint32 length) {
+  gint32 i, j;
+  guint64 acc, word;
+  for(i = 0; i + 8 <= length; i += 8){
+    memcpy(&acc, from[0] + i, 8);
+    for(j = 1; j < from_num; ++j){
+      memcpy(&word, from[j] + i, 8);
+      acc ^= word;
+    }
+    memcpy(to + i, &acc, 8);
+  }
+  _do_bitxor_n_tail(to, from, from_num, i, length);
+}
+
+#ifdef BITXOR_X86_DISPATCH
+__attribute__((target("sse2")))
+static void _do_bitxor_n_sse2(guint8* to, guint8** from, gint32 from_num, gint32 length) {
+  gint32 i, j;
+  __m128i acc0, acc1;
+  for(i = 0; i + 32 <= length; i += 32){
+    acc0 = _mm_loadu_si128((const __m128i*)(from[0] + i));
+    acc1 = _mm_loadu_si128((const __m128i*)(from[0] + i + 16));
+    for(j = 1; j < from_num; ++j){
+      acc0 = _mm_xor_si128(acc0, _mm_loadu_si128((const __m128i*)(from[j] + i)));
+      acc1 = _mm_xor_si128(acc1, _mm_loadu_si128((const __m128i*)(from[j] + i + 16)));
+    }
+    _mm_storeu_si128((__m128i*)(to + i), acc0);
+    _mm_storeu_si128((__m128i*)(to + i + 16), acc1);
+  }
+  for(; i + 16 <= length; i += 16){
+    acc0 = _mm_loadu_si128((const __m128i*)(from[0] + i));
+    for(j = 1; j < from_num; ++j){
+      acc0 = _mm_xor_si128(acc0, _mm_loadu_si128((const __m128i*)(from[j] + i)));
+    }
+    _mm_storeu_si128((__m128i*)(to + i), acc0);
+  }
+  _do_bitxor_n_tail(to, from, from_num, i, length);
+}
+
+__attribute__((target("avx2")))
+static void _do_bitxor_n_avx2(guint8* to, guint8** from, gint32 from_num, gint32 length) {
+  gint32 i, j;
+  __m256i acc0, acc1;
+  for(i = 0; i + 64 <= length; i += 64){
+    acc0 = _mm256_loadu_si256((const __m256i*)(from[0] + i));
+    acc1 = _mm256_loadu_si256((const __m256i*)(from[0] + i + 32));
+    for(j = 1; j < from_num; ++j){
+      acc0 = _mm256_xor_si256(acc0, _mm256_loadu_si256((const __m256i*)(from[j] + i)));
+      acc1 = _mm256_xor_si256(acc1, _mm256_loadu_si256((const __m256i*)(from[j] + i + 32)));
+    }
+    _mm256_storeu_si256((__m256i*)(to + i), acc0);
+    _mm256_storeu_si256((__m256i*)(to + i + 32), acc1);
+  }
+  for(; i + 32 <= length; i += 32){
+    acc0 = _mm256_loadu_si256((const __m256i*)(from[0] + i));
+    for(j = 1; j < from_num; ++j){
+      acc0 = _mm256_xor_si256(acc0, _mm256_loadu_si256((const __m256i*)(from[j] + i)));
+    }
+    _mm256_storeu_si256((__m256i*)(to + i), acc0);
+  }
+  _do_bitxor_n_tail(to, from, from_num, i, length);
+}
+#endif
+
+static BitXorNFunc _select_bitxor_n_impl(void) {
+#ifdef BITXOR_X86_DISPATCH
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")){
+    return _do_bitxor_n_avx2;
+  }
+  if(__builtin_cpu_supports("sse2")){
+    return _do_bitxor_n_sse2;
+  }
+#endif
+  return _do_bitxor_n_scalar;
+}
+
+void do_bitxor_n(guint8* to, guint8** from, gint32 from_num, gint32 length) {
+  static gsize impl = 0;
+  if(g_once_init_enter(&impl)){
+    g_once_init_leave(&impl, (gsize) _select_bitxor_n_impl());
+  }
+  if(from_num < 1){
+    memset(to, 0, length);
+    return;
+  }
+  ((BitXorNFunc) impl)(to, from, from_num, length);
+}
+
 void gst_rtp_buffer_set_mprtp_extension(GstRTPBuffer* rtp, guint8 ext_header_id, guint8 subflow_id, guint16 subflow_seq)
 {
   MPRTPSubflowHeaderExtension mprtp_ext;
   mprtp_ext.id = subflow_id;
   mprtp_ext.seq = subflow_seq;
-  DISABLE_LINE _test_do_bitxor();
   gst_rtp_buffer_add_extension_onebyte_header (rtp, ext_header_id, (gpointer) &mprtp_ext, sizeof (mprtp_ext));
 }
 
@@ -62,15 +167,20 @@ guint16 subflowseqtracker_increase(SubflowSeqTrack *subseqtracker)
   return subseqtracker->seqence_num;
 }
 
-void gst_rtp_buffer_set_abs_time_extension(GstRTPBuffer* rtp, guint8 abs_time_ext_header_id)
+void mprtp_setup_abs_time_extension(RTPAbsTimeExtension* data)
 {
-    RTPAbsTimeExtension data;
     guint32 time;
 
     //Absolute sending time +0x83AA7E80
     //https://tools.ietf.org/html/draft-alvestrand-rmcat-remb-03
     time = (NTP_NOW >> 14) & 0x00ffffff;
-    memcpy (&data, &time, 3);
+    memcpy (data, &time, 3);
+}
+
+void gst_rtp_buffer_set_abs_time_extension(GstRTPBuffer* rtp, guint8 abs_time_ext_header_id)
+{
+    RTPAbsTimeExtension data;
+    mprtp_setup_abs_time_extension(&data);
     gst_rtp_buffer_add_extension_onebyte_header (rtp, abs_time_ext_header_id, (gpointer) &data, sizeof (data));
 }
 
@@ -104,6 +214,35 @@ guint64 gst_rtp_buffer_get_abs_time_extension_new(GstRTPBuffer* rtp, guint8 abs_
   return result << 14;
 }
 
+const guint8* mprtp_peek_onebyte_extension(const guint8* data, gsize size, guint8 ext_header_id)
+{
+  gsize offset, end, length;
+  if (size < 12 || !(data[0] & 0x10)) {
+    return NULL;
+  }
+  //the extension follows the fixed header and the CSRCs
+  offset = 12 + (data[0] & 0x0f) * 4;
+  if (size < offset + 4 || GST_READ_UINT16_BE (data + offset) != 0xBEDE) {
+    return NULL;
+  }
+  end = MIN (size, offset + 4 + GST_READ_UINT16_BE (data + offset + 2) * 4);
+  for (offset += 4; offset < end; offset += 1 + length) {
+    if (data[offset] == 0) {
+      //padding
+      length = 0;
+      continue;
+    }
+    length = (data[offset] & 0x0f) + 1;
+    if ((data[offset] >> 4) == 15 || end < offset + 1 + length) {
+      break;
+    }
+    if ((data[offset] >> 4) == ext_header_id) {
+      return data + offset + 1;
+    }
+  }
+  return NULL;
+}
+
 gboolean gst_buffer_is_mprtp(GstBuffer* buffer, guint8 mprtp_ext_header_id)
 {
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
@@ -126,75 +265,6 @@ gboolean gst_rtp_buffer_is_fectype(GstRTPBuffer* rtp, guint8 fec_payload_type)
   return gst_rtp_buffer_get_payload_type(rtp) == fec_payload_type;
 }
 
-static void _test_do_bitxor(void) {
-  {
-    guint8 a[] = {0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10};
-    guint8 b[] = {0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01};
-    do_bitxor(a, b, 8);
-    g_print("test bitxor 8*8bits expected: 1111... value: %X%X%X%X%X%X%X%X\n",
-        a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
-  }
-
-  {
-    guint8 a[] = {0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01};
-    guint8 b[] = {0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10};
-    do_bitxor(a, b, 9);
-    g_print("test bitxor 8*9bits expected: 1111... value: %X%X%X%X%X%X%X%X%X\n",
-        a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8]);
-  }
-
-  {
-    guint8 a[] = {0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10};
-    guint8 b[] = {0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01};
-    do_bitxor(a, b, 10);
-    g_print("test bitxor 8*10bits expected: 1111... value: %X%X%X%X%X%X%X%X%X%X\n",
-        a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8], a[9]);
-  }
-
-  {
-    guint8 a[] = {0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01};
-    guint8 b[] = {0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10};
-    do_bitxor(a, b, 11);
-    g_print("test bitxor 8*11bits expected: 1111... value: %X%X%X%X%X%X%X%X%X%X%X\n",
-        a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8], a[9], a[10]);
-  }
-
-  {
-    guint8 a[] = {0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10};
-    guint8 b[] = {0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01};
-    do_bitxor(a, b, 12);
-    g_print("test bitxor 8*12bits expected: 1111... value: %X%X%X%X%X%X%X%X%X%X%X%X\n",
-        a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8], a[9], a[10], a[11]);
-  }
-
-  {
-    guint8 a[] = {0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01};
-    guint8 b[] = {0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10};
-    do_bitxor(a, b, 13);
-    g_print("test bitxor 8*13bits expected: 1111... value: %X%X%X%X%X%X%X%X%X%X%X%X%X\n",
-        a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8], a[9], a[10], a[11], a[12]);
-  }
-
-  {
-    guint8 a[] = {0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10};
-    guint8 b[] = {0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01};
-    do_bitxor(a, b, 14);
-    g_print("test bitxor 8*13bits expected: 1111... value: %X%X%X%X%X%X%X%X%X%X%X%X%X%X\n",
-        a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8], a[9], a[10], a[11], a[12], a[13]);
-  }
-
-  {
-    guint8 a[] = {0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01};
-    guint8 b[] = {0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10};
-    do_bitxor(a, b, 15);
-    g_print("test bitxor 8*13bits expected: 1111... value: %X%X%X%X%X%X%X%X%X%X%X%X%X%X%X\n",
-        a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8], a[9], a[10], a[11], a[12], a[13], a[14]);
-  }
-}
-
-
-
-
 // Code migrated from https://www.geeksforgeeks.org/iterative-quick-sort/
 // Function to swap numbers
 static void _swap(gpointer *a, gpointer *b){
@@ -88,14 +88,26 @@ typedef struct{
 }SubflowSeqTrack;
 
 void do_bitxor(guint8* to, guint8* from, gint32 length);
+//XORs from_num source bitstrings of the given length into to in one pass.
+//to may alias one of the sources.
+void do_bitxor_n(guint8* to, guint8** from, gint32 from_num, gint32 length);
 
 void gst_rtp_buffer_set_mprtp_extension(GstRTPBuffer* rtp, guint8 ext_header_id, guint8 subflow_id, guint16 subflow_seq);
 void gst_rtp_buffer_get_mprtp_extension(GstRTPBuffer* rtp, guint8 ext_header_id, guint8 *subflow_id, guint16 *subflow_seq);
 
+//Fills the extension with the current absolute sending time
+void mprtp_setup_abs_time_extension(RTPAbsTimeExtension* data);
 void gst_rtp_buffer_set_abs_time_extension(GstRTPBuffer* rtp, guint8 abs_time_ext_header_id);
 guint64 gst_rtp_buffer_get_abs_time_extension(GstRTPBuffer* rtp, guint8 abs_time_ext_header_id);
 guint64 gst_rtp_buffer_get_abs_time_extension_new(GstRTPBuffer* rtp, guint8 abs_time_ext_header_id);
 
+//Bytes copied from the beginning of a packet to peek into its header without mapping.
+//It covers the RTP header with some CSRCs and the first extension elements.
+#define MPRTP_PEEK_HEADER_LENGTH 128
+//Returns the data of the one byte header extension element with the given id
+//from the beginning of an RTP packet copied into data, or NULL if it is not there.
+const guint8* mprtp_peek_onebyte_extension(const guint8* data, gsize size, guint8 ext_header_id);
+
 gboolean gst_buffer_is_mprtp(GstBuffer* buffer, guint8 mprtp_ext_header_id);
 gboolean gst_rtp_buffer_is_mprtp(GstRTPBuffer* rtp, guint8 mprtp_ext_header_id);
 gboolean gst_rtp_buffer_is_fectype(GstRTPBuffer* rtp, guint8 fec_payload_type);
@@ -37,16 +37,7 @@ GST_DEBUG_CATEGORY_STATIC (notifier_debug_category);
 
 G_DEFINE_TYPE (Notifier, notifier, G_TYPE_OBJECT);
 
-typedef struct{
-  gchar               name[256];
-  ListenerFunc        callback;
-  ListenerFilterFunc  filter;
-  gpointer            udata;
-}Listener;
-
-
-static Listener* _make_listener(ListenerFunc callback, ListenerFilterFunc filter, gpointer udata);
-static void _dispose_listener(gpointer item);
+#define NOTIFIER_INITIAL_LISTENERS_LENGTH 4
 
 
 //----------------------------------------------------------------------
@@ -76,9 +67,7 @@ void
 notifier_finalize (GObject * object)
 {
   Notifier *this = NOTIFIER (object);
-  if(this->listeners){
-    g_slist_free_full(this->listeners, _dispose_listener);
-  }
+  g_free(this->listeners);
 }
 
 void
@@ -96,79 +85,60 @@ Notifier *make_notifier(const gchar* name)
 
 void notifier_add_listener(Notifier *this, ListenerFunc callback, gpointer udata)
 {
-  Listener *listener = _make_listener(callback, NULL, udata);
-  //Debug purpose:
-  strcpy(listener->name, this->name);
-  this->listeners = g_slist_prepend(this->listeners, listener);
+  notifier_add_listener_with_filter(this, callback, NULL, udata);
 }
 
 void notifier_add_listener_with_filter(Notifier *this, ListenerFunc callback, ListenerFilterFunc filter, gpointer udata)
 {
-  Listener *listener = _make_listener(callback, filter, udata);
-  //Debug purpose:
-  strcpy(listener->name, this->name);
-  this->listeners = g_slist_prepend(this->listeners, listener);
-}
-
-static gint _find_listener_by_func(gconstpointer itemp, gconstpointer searchedp)
-{
-  const ListenerFunc searched_callback = searchedp;
-  const Listener* listener = itemp;
-  return listener->callback == searched_callback ? 0 : -1;
-}
-
-void notifier_rem_listener(Notifier *this, ListenerFunc callback)
-{
-  GSList* it;
-  it = g_slist_find_custom(this->listeners, callback, _find_listener_by_func);
-  if(!it){
+  Listener *listener;
+  if(!callback){
+    g_warning("Listener callback for %s is undefined", this->name);
     return;
   }
-  this->listeners = g_slist_remove(this->listeners, it->data);
-  _dispose_listener(it->data);
+  if(this->listeners_num == this->listeners_length){
+    this->listeners_length = MAX(NOTIFIER_INITIAL_LISTENERS_LENGTH, this->listeners_length * 2);
+    this->listeners = g_renew(Listener, this->listeners, this->listeners_length);
+  }
+  listener = this->listeners + this->listeners_num++;
+  listener->callback = GST_DEBUG_FUNCPTR(callback);
+  listener->filter   = filter;
+  listener->udata    = udata;
 }
 
-
-static void _listener_helper(gpointer item, gpointer udata)
+void notifier_rem_listener(Notifier *this, ListenerFunc callback)
 {
-  Listener* listener = item;
-  if(listener->filter && !listener->filter(listener->udata, udata)){
-    goto done;
-  }
-  if(listener->callback){
-    listener->callback(listener->udata, udata);
-  }else{
-    g_print("Listener callback is undefined");
+  gint32 i;
+  for(i = this->listeners_num - 1; 0 <= i; --i){
+    if(this->listeners[i].callback != callback){
+      continue;
+    }
+    memmove(this->listeners + i, this->listeners + i + 1, (this->listeners_num - i - 1) * sizeof(Listener));
+    --this->listeners_num;
+    return;
   }
-done:
-  return;
 }
 
 void notifier_do(Notifier *this, gpointer subject)
 {
-  if(!this){
+  Listener* listener;
+  gint32 i;
+  if(!this || this->listeners_num == 0){
+    return;
+  }
+  if(this->listeners_num == 1 && !this->listeners->filter){
+    this->listeners->callback(this->listeners->udata, subject);
     return;
   }
 //PROFILING2("notifier_do",
-  g_slist_foreach(this->listeners, _listener_helper, subject);
+  //the last added is called first, listeners added by a callback are not called until the next time
+  for(i = this->listeners_num - 1; 0 <= i; --i){
+    listener = this->listeners + i;
+    if(listener->filter && !listener->filter(listener->udata, subject)){
+      continue;
+    }
+    listener->callback(listener->udata, subject);
+  }
 //);
 }
 
 
-Listener* _make_listener(ListenerFunc callback, ListenerFilterFunc filter, gpointer udata)
-{
-  Listener* result = g_slice_new0(Listener);
-//  result->callback = callback;
-  result->callback = GST_DEBUG_FUNCPTR(callback);
-  result->filter = filter;
-  result->udata = udata;
-
-  return result;
-}
-
-void _dispose_listener(gpointer item)
-{
-  g_slice_free(Listener, item);
-}
-
-
@@ -22,20 +22,28 @@ typedef struct _NotifierClass NotifierClass;
 #define NOTIFIER_CAST(src)        ((Notifier *)(src))
 
 
+typedef gboolean (*ListenerFilterFunc)(gpointer udata, gpointer item);
+typedef void (*ListenerFunc)(gpointer udata, gpointer item);
+
+typedef struct{
+  ListenerFunc        callback;
+  ListenerFilterFunc  filter;
+  gpointer            udata;
+}Listener;
+
 struct _Notifier
 {
   GObject          object;
   gchar            name[256];
-  GSList*          listeners;
+  Listener*        listeners;         //in the order they are added
+  gint32           listeners_num;
+  gint32           listeners_length;
 };
 
 struct _NotifierClass{
   GObjectClass parent_class;
 };
 
-typedef gboolean (*ListenerFilterFunc)(gpointer udata, gpointer item);
-typedef void (*ListenerFunc)(gpointer udata, gpointer item);
-
 
 GType notifier_get_type (void);
 
@@ -45,6 +53,42 @@ void notifier_add_listener_with_filter(Notifier *this, ListenerFunc callback, Li
 void notifier_rem_listener(Notifier *this, ListenerFunc callback);
 void notifier_do(Notifier *this, gpointer subject);
 
+//Typed notify, add and remove listener functions for the subject type.
+//Components firing the notifier take name##_listener_t in their add functions,
+//Listeners are written as (gpointer udata, type subject) and registered without a cast,
+//so a listener for an other subject type does not compile.
+//A single listener without filter is called directly from the inlined notify.
+#define DEFINE_NOTIFIER_TYPE(name, type)                                          \
+typedef void (*name##_listener_t)(gpointer udata, type subject);                 \
+typedef gboolean (*name##_filter_t)(gpointer udata, type subject);               \
+                                                                                  \
+static inline void notifier_do_##name(Notifier *this, type subject)             \
+{                                                                                 \
+  if(this && this->listeners_num == 1 && !this->listeners->filter){              \
+    ((name##_listener_t) this->listeners->callback)(this->listeners->udata, subject); \
+    return;                                                                       \
+  }                                                                               \
+  notifier_do(this, (gpointer) subject);                                          \
+}                                                                                 \
+                                                                                  \
+static inline void notifier_add_##name##_listener(Notifier *this,               \
+    name##_listener_t callback, gpointer udata)                                   \
+{                                                                                 \
+  notifier_add_listener(this, (ListenerFunc) callback, udata);                    \
+}                                                                                 \
+                                                                                  \
+static inline void notifier_add_##name##_listener_with_filter(Notifier *this,   \
+    name##_listener_t callback, name##_filter_t filter, gpointer udata)           \
+{                                                                                 \
+  notifier_add_listener_with_filter(this, (ListenerFunc) callback,               \
+      (ListenerFilterFunc) filter, udata);                                        \
+}                                                                                 \
+                                                                                  \
+static inline void notifier_rem_##name##_listener(Notifier *this,               \
+    name##_listener_t callback)                                                   \
+{                                                                                 \
+  notifier_rem_listener(this, (ListenerFunc) callback);                           \
+}
 
 
 #endif /* NOTIFIER_H_ */
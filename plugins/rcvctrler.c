@@ -70,7 +70,7 @@ rcvctrler_finalize (GObject * object);
 //------------------------ Outgoing Report Producer -------------------------
 static void
 _on_received_packet(
-    RcvController *this,
+    gpointer udata,
     RcvPacket *packet);
 
 static void
@@ -191,7 +191,7 @@ make_rcvctrler(
       this->subflows, (ListenerFunc)_on_congestion_controlling_changed, this);
 
   rcvtracker_add_on_received_packet_listener(rcvtracker,
-      (ListenerFunc) _on_received_packet,
+      _on_received_packet,
       this);
 
   return this;
@@ -239,6 +239,7 @@ rcvctrler_receive_mprtcp (RcvController *this, GstBuffer * buf)
     subflow->last_SR_report_rcvd = NTP_NOW;
   }
 
+  report_processor_release_summary(this->report_processor, summary);
 }
 
 
@@ -329,8 +330,9 @@ static void _do_fb_report(RcvController *this) {
 //  g_print("do_report HSN: %hu\n", this->HSN);
 }
 
-void _on_received_packet( RcvController *this, RcvPacket *packet)
+void _on_received_packet(gpointer udata, RcvPacket *packet)
 {
+  RcvController *this = udata;
   if (this->rtcp_fb_frame_interval_th < 1) {
     return;
   }
@@ -0,0 +1,188 @@
+/* GStreamer Scheduling tree
+ * Copyright (C) 2015 Balázs Kreith (contact: balazs.kreith@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include "rcvframes.h"
+
+GST_DEBUG_CATEGORY_STATIC (rcvframes_debug_category);
+#define GST_CAT_DEFAULT rcvframes_debug_category
+
+G_DEFINE_TYPE (RcvFrames, rcvframes, G_TYPE_OBJECT);
+
+//Initial number of packet slots of a frame, doubled when it runs out
+#define RCVFRAME_INITIAL_PACKETS_LENGTH 16
+
+//----------------------------------------------------------------------
+//-------- Private functions belongs to RcvFrames object ----------
+//----------------------------------------------------------------------
+
+static void rcvframes_finalize (GObject * object);
+
+static gint
+_cmp_seq (guint16 x, guint16 y)
+{
+  if(x == y) return 0;
+  if(x < y && y - x < 32768) return -1;
+  if(x > y && x - y > 32768) return -1;
+  if(x < y && y - x > 32768) return 1;
+  if(x > y && x - y < 32768) return 1;
+  return 0;
+}
+
+static gpointer _rcvframe_ctor(void)
+{
+  RcvFrame* result = g_slice_new0(RcvFrame);
+  result->packets = g_malloc0(sizeof(RcvPacket*) * RCVFRAME_INITIAL_PACKETS_LENGTH);
+  result->packets_length = RCVFRAME_INITIAL_PACKETS_LENGTH;
+  return result;
+}
+
+static void _rcvframe_dtor(gpointer item)
+{
+  RcvFrame* frame = item;
+  g_free(frame->packets);
+  g_slice_free(RcvFrame, frame);
+}
+
+//----------------------------------------------------------------------
+//--------- Private functions implementations to RcvFrames object --------
+//----------------------------------------------------------------------
+
+void
+rcvframes_class_init (RcvFramesClass * klass)
+{
+  GObjectClass *gobject_class;
+
+  gobject_class = (GObjectClass *) klass;
+
+  gobject_class->finalize = rcvframes_finalize;
+
+  GST_DEBUG_CATEGORY_INIT (rcvframes_debug_category, "rcvframes", 0,
+      "MpRTP Received Frames");
+}
+
+void
+rcvframes_finalize (GObject * object)
+{
+  RcvFrames *this = RCVFRAMES (object);
+  RcvFrame* frame;
+  gint32 i;
+  while((frame = g_queue_pop_head(this->frames)) != NULL){
+    for(i = 0; i < frame->packets_num; ++i){
+      rcvpacket_unref(frame->packets[i]);
+    }
+    _rcvframe_dtor(frame);
+  }
+  g_queue_free(this->frames);
+  g_hash_table_destroy(this->index);
+  g_object_unref(this->recycle);
+}
+
+void
+rcvframes_init (RcvFrames * this)
+{
+  this->index   = g_hash_table_new(g_direct_hash, g_direct_equal);
+  this->frames  = g_queue_new();
+  this->recycle = make_recycle(50, _rcvframe_ctor, _rcvframe_dtor, NULL);
+}
+
+RcvFrames* make_rcvframes(void)
+{
+  return (RcvFrames *) g_object_new (RCVFRAMES_TYPE, NULL);
+}
+
+static gint _frames_cmp(RcvFrame* first, RcvFrame* second)
+{
+  return _cmp_seq(first->packets[0]->abs_seq, second->packets[0]->abs_seq);
+}
+
+//Packets mostly arrive in order, so searching from the end is amortized constant
+static void _insert_packet(RcvFrame* frame, RcvPacket* packet)
+{
+  gint32 i;
+  if(frame->packets_length <= frame->packets_num){
+    frame->packets_length <<= 1;
+    frame->packets = g_realloc(frame->packets, sizeof(RcvPacket*) * frame->packets_length);
+  }
+  for(i = frame->packets_num; 0 < i && _cmp_seq(packet->abs_seq, frame->packets[i - 1]->abs_seq) < 0; --i){
+    frame->packets[i] = frame->packets[i - 1];
+  }
+  frame->packets[i] = packet;
+  ++frame->packets_num;
+}
+
+//New frames mostly come after the last one, so the list is searched from its tail
+static void _insert_frame(RcvFrames* this, RcvFrame* frame)
+{
+  GList* it;
+  for(it = this->frames->tail; it && _frames_cmp(frame, it->data) < 0; it = it->prev);
+  if(!it){
+    g_queue_push_head(this->frames, frame);
+  }else{
+    g_queue_insert_after(this->frames, it, frame);
+  }
+}
+
+RcvFrame* rcvframes_add_packet(RcvFrames* this, RcvPacket* packet)
+{
+  RcvFrame* frame;
+  frame = g_hash_table_lookup(this->index, GUINT_TO_POINTER(packet->snd_rtp_ts));
+  if(frame){
+    _insert_packet(frame, packet);
+    return frame;
+  }
+  frame = recycle_retrieve(this->recycle);
+  frame->timestamp     = packet->snd_rtp_ts;
+  frame->created_in_ts = packet->rcv_rtp_ts;
+  _insert_packet(frame, packet);
+  g_hash_table_insert(this->index, GUINT_TO_POINTER(frame->timestamp), frame);
+  _insert_frame(this, frame);
+  return frame;
+}
+
+RcvFrame* rcvframes_peek_first(RcvFrames* this)
+{
+  return g_queue_peek_head(this->frames);
+}
+
+RcvFrame* rcvframes_pop_first(RcvFrames* this)
+{
+  RcvFrame* result = g_queue_pop_head(this->frames);
+  if(result){
+    g_hash_table_remove(this->index, GUINT_TO_POINTER(result->timestamp));
+  }
+  return result;
+}
+
+void rcvframes_throw_frame(RcvFrames* this, RcvFrame* frame)
+{
+  frame->timestamp     = 0;
+  frame->created_in_ts = 0;
+  frame->packets_num   = 0;
+  recycle_add(this->recycle, frame);
+}
+
+gint32 rcvframes_length(RcvFrames* this)
+{
+  return g_queue_get_length(this->frames);
+}
@@ -0,0 +1,57 @@
+/*
+ * rcvframes.h
+ *
+ */
+
+#ifndef RCVFRAMES_H_
+#define RCVFRAMES_H_
+
+#include <gst/gst.h>
+#include "rcvpackets.h"
+#include "recycle.h"
+
+typedef struct _RcvFrames RcvFrames;
+typedef struct _RcvFramesClass RcvFramesClass;
+
+#define RCVFRAMES_TYPE             (rcvframes_get_type())
+#define RCVFRAMES(src)             (G_TYPE_CHECK_INSTANCE_CAST((src),RCVFRAMES_TYPE,RcvFrames))
+#define RCVFRAMES_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass),RCVFRAMES_TYPE,RcvFramesClass))
+#define RCVFRAMES_IS_SOURCE(src)          (G_TYPE_CHECK_INSTANCE_TYPE((src),RCVFRAMES_TYPE))
+#define RCVFRAMES_IS_SOURCE_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass),RCVFRAMES_TYPE))
+#define RCVFRAMES_CAST(src)        ((RcvFrames *)(src))
+
+typedef struct{
+  guint32      timestamp;
+  guint32      created_in_ts;
+  RcvPacket**  packets;          //ordered by abs_seq
+  gint32       packets_num;
+  gint32       packets_length;
+}RcvFrame;
+
+//Frames of the received packets indexed by their RTP timestamp
+//and ordered by the sequence number of their first packet.
+struct _RcvFrames
+{
+  GObject                  object;
+  GHashTable*              index;
+  GQueue*                  frames;
+  Recycle*                 recycle;
+};
+
+struct _RcvFramesClass{
+  GObjectClass parent_class;
+};
+
+GType rcvframes_get_type (void);
+RcvFrames* make_rcvframes(void);
+
+//The packet reference is taken over by the frame
+RcvFrame* rcvframes_add_packet(RcvFrames* this, RcvPacket* packet);
+RcvFrame* rcvframes_peek_first(RcvFrames* this);
+//The packet references of the popped frame are owned by the caller,
+//the frame itself must be given back by rcvframes_throw_frame
+RcvFrame* rcvframes_pop_first(RcvFrames* this);
+void rcvframes_throw_frame(RcvFrames* this, RcvFrame* frame);
+gint32 rcvframes_length(RcvFrames* this);
+
+#endif /* RCVFRAMES_H_ */
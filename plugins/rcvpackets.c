@@ -49,7 +49,8 @@ static void _extract_mprtp_info(RcvPackets* this, RcvPacket* packet, GstRTPBuffe
 //--------- Private functions implementations to SchTree object --------
 //----------------------------------------------------------------------
 
-DEFINE_RECYCLE_TYPE(static, rcvpacket, RcvPacket);
+DEFINE_RECYCLE_SLAB_TYPE(static, rcvpacket, RcvPacket, 64);
+G_STATIC_ASSERT(G_STRUCT_OFFSET(RcvPacket, header_size) <= RECYCLE_SLAB_ALIGNMENT);
 
 static void _rcvpacket_shaper(RcvPacket* result, gpointer udata)
 {
@@ -209,10 +210,12 @@ void _extract_mprtp_info(RcvPackets* this, RcvPacket* packet, GstRTPBuffer *rtp)
 
   guint8 mprtp_ext_header_id = rcvpackets_get_mprtp_ext_header_id(this);
 
-  packet->abs_rcv_ntp_time  = NTP_NOW;
-  packet->abs_snd_ntp_chunk = gst_rtp_buffer_get_abs_time_extension_new(rtp, this->abs_time_ext_header_id);
+#ifdef MPRTP_PACKET_ANALYSIS
+  packet->analysis.abs_rcv_ntp_time  = NTP_NOW;
+  packet->analysis.abs_snd_ntp_chunk = gst_rtp_buffer_get_abs_time_extension_new(rtp, this->abs_time_ext_header_id);
 
-  packet->abs_snd_ntp_time = gst_rtp_buffer_get_abs_time_extension(rtp, this->abs_time_ext_header_id);
+  packet->analysis.abs_snd_ntp_time = gst_rtp_buffer_get_abs_time_extension(rtp, this->abs_time_ext_header_id);
+#endif
 
   gst_rtp_buffer_get_mprtp_extension(rtp, mprtp_ext_header_id, &packet->subflow_id, &packet->subflow_seq);
 
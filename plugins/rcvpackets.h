@@ -12,6 +12,7 @@
 #include <gst/net/gstnetaddressmeta.h>
 #include "rcvsubflows.h"
 #include "recycle.h"
+#include "notifier.h"
 
 typedef struct _RcvPackets RcvPackets;
 typedef struct _RcvPacketsClass RcvPacketsClass;
@@ -25,36 +26,44 @@ typedef struct _RcvPacketsClass RcvPacketsClass;
 
 typedef struct _RcvPacket RcvPacket;
 
+DEFINE_NOTIFIER_TYPE(rcvpacket, RcvPacket*)
+
+//Absolute times of the packets, compiled in only if MPRTP_PACKET_ANALYSIS is defined
+typedef struct _RcvPacketAnalysis
+{
+  guint64              abs_snd_ntp_chunk;
+  guint64              abs_snd_ntp_time;
+  guint64              abs_rcv_ntp_time;
+}RcvPacketAnalysis;
+
+//The fields the tracker, the jitterbuffer and the joiner touch for every
+//received packet are in the first cache line.
 struct _RcvPacket
 {
 //  RcvPackets*          base_db;
   GstBuffer*           buffer;
-  gint                 ref;
   GstClockTime         received;
 //  GstClockTime         delay;
-
-  guint64              abs_snd_ntp_chunk;
-  guint64              abs_snd_ntp_time;
-  guint64              abs_rcv_ntp_time;
-
-  gboolean             marker;
-  guint8               payload_type;
-  guint16              abs_seq;
-  guint32              snd_rtp_ts;
-  guint32              ssrc;
-
-  guint                header_size;
+  gint64               subflow_skew_in_ts;
+  gint                 ref;
   guint                payload_size;
-
+  guint32              cc_ts;
+  guint32              rcv_rtp_ts;
+  guint32              snd_rtp_ts;
+  guint32              subflow_jitter_at_rcv;
+  guint16              abs_seq;
   guint16              subflow_seq;
   guint8               subflow_id;
-  gint64               subflow_skew_in_ts;
-  guint32              subflow_jitter_at_rcv;
+  guint8               payload_type;
+  gboolean             marker;
+  guint32              ssrc;
 
+  guint                header_size;
   Recycle*             destiny;
-  guint32              cc_ts;
-  guint32              rcv_rtp_ts;
 
+#ifdef MPRTP_PACKET_ANALYSIS
+  RcvPacketAnalysis    analysis;
+#endif
 
 //  gint64               abs_rtp_skew;
 //  gint64               subflow_rtp_skew;
@@ -82,6 +91,9 @@ struct _RcvPacketsClass{
 
 
 GType rcvpackets_get_type (void);
+//Packets are carved from slabs owned by the returned object and the slabs are freed
+//when it is finalized, so every packet got from it must be unrefed before
+//the last reference of it is dropped.
 RcvPackets* make_rcvpackets(void);
 void rcvpackets_reset(RcvPackets* this);
 
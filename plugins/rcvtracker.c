@@ -39,7 +39,7 @@ GST_DEBUG_CATEGORY_STATIC (rcvtracker_debug_category);
 #define THIS_WRITELOCK(this) g_rw_lock_writer_lock(&this->rwmutex)
 #define THIS_WRITEUNLOCK(this) g_rw_lock_writer_unlock(&this->rwmutex)
 
-#define _now(this) gst_clock_get_time (this->sysclock)
+#define _now(this) clocktick_now (this->sysclock)
 #define _priv(this) ((Private*)(this->priv))
 //#define _get_subflow(this, subflow_id) ((Subflow*)(_priv(this)->subflows + subflow_id))
 
@@ -175,38 +175,38 @@ void rcvtracker_on_recovered_buffer(RcvTracker* this, GstBuffer* repairedbuf)
 void rcvtracker_add_discarded_packet(RcvTracker* this, RcvPacket* packet)
 {
   ++this->stat.discarded_packets;
-  notifier_do(this->on_discarded_packet, packet);
+  notifier_do_rcvpacket(this->on_discarded_packet, packet);
 }
 
-void rcvtracker_add_on_received_packet_listener(RcvTracker * this, ListenerFunc callback, gpointer udata)
+void rcvtracker_add_on_received_packet_listener(RcvTracker * this, rcvpacket_listener_t callback, gpointer udata)
 {
-  notifier_add_listener(this->on_received_packet, callback, udata);
+  notifier_add_rcvpacket_listener(this->on_received_packet, callback, udata);
 }
 
-void rcvtracker_add_on_received_packet_listener_with_filter(RcvTracker * this, ListenerFunc callback, ListenerFilterFunc filter, gpointer udata)
+void rcvtracker_add_on_received_packet_listener_with_filter(RcvTracker * this, rcvpacket_listener_t callback, rcvpacket_filter_t filter, gpointer udata)
 {
-  notifier_add_listener_with_filter(this->on_received_packet, callback, filter, udata);
+  notifier_add_rcvpacket_listener_with_filter(this->on_received_packet, callback, filter, udata);
 }
 
-void rcvtracker_rem_on_received_packet_listener(RcvTracker * this, ListenerFunc callback)
+void rcvtracker_rem_on_received_packet_listener(RcvTracker * this, rcvpacket_listener_t callback)
 {
-  notifier_rem_listener(this->on_received_packet, callback);
+  notifier_rem_rcvpacket_listener(this->on_received_packet, callback);
 }
 
 
 void rcvtracker_add_on_discarded_packet_listener(RcvTracker * this,
-                                    ListenerFunc callback,
+                                    rcvpacket_listener_t callback,
                                     gpointer udata)
 {
-  notifier_add_listener(this->on_discarded_packet, callback, udata);
+  notifier_add_rcvpacket_listener(this->on_discarded_packet, callback, udata);
 }
 
 void rcvtracker_add_on_discarded_packet_listener_with_filter(RcvTracker * this,
-                                    ListenerFunc callback,
-                                    ListenerFilterFunc filter,
+                                    rcvpacket_listener_t callback,
+                                    rcvpacket_filter_t filter,
                                     gpointer udata)
 {
-  notifier_add_listener_with_filter(this->on_discarded_packet, callback, filter, udata);
+  notifier_add_rcvpacket_listener_with_filter(this->on_discarded_packet, callback, filter, udata);
 }
 
 
@@ -274,7 +274,7 @@ void rcvtracker_add_packet(RcvTracker * this, RcvPacket* packet)
     Subflow* subflow = _get_subflow(this, packet->subflow_id);
     _subflow_add_packet(this, subflow, packet);
   }
-  notifier_do(this->on_received_packet, packet);
+  notifier_do_rcvpacket(this->on_received_packet, packet);
 }
 
 
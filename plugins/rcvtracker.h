@@ -13,6 +13,7 @@
 #include "rcvpackets.h"
 #include "mprtputils.h"
 #include "timestampgenerator.h"
+#include "lib_clocktick.h"
 
 typedef struct _RcvTracker RcvTracker;
 typedef struct _RcvTrackerClass RcvTrackerClass;
@@ -77,23 +78,23 @@ void rcvtracker_on_recovered_buffer(RcvTracker* this, GstBuffer* repairedbuf);
 void rcvtracker_add_discarded_packet(RcvTracker* this, RcvPacket* packet);
 
 void rcvtracker_add_on_received_packet_listener(RcvTracker * this,
-                                        ListenerFunc callback,
+                                        rcvpacket_listener_t callback,
                                         gpointer udata);
 
 void rcvtracker_add_on_received_packet_listener_with_filter(RcvTracker * this,
-                                                            ListenerFunc callback,
-                                                            ListenerFilterFunc filter,
+                                                            rcvpacket_listener_t callback,
+                                                            rcvpacket_filter_t filter,
                                                             gpointer udata);
 
-void rcvtracker_rem_on_received_packet_listener(RcvTracker * this, ListenerFunc callback);
+void rcvtracker_rem_on_received_packet_listener(RcvTracker * this, rcvpacket_listener_t callback);
 
 void rcvtracker_add_on_discarded_packet_listener(RcvTracker * this,
-                                    ListenerFunc callback,
+                                    rcvpacket_listener_t callback,
                                     gpointer udata);
 
 void rcvtracker_add_on_discarded_packet_listener_with_filter(RcvTracker * this,
-                                    ListenerFunc callback,
-                                    ListenerFilterFunc filter,
+                                    rcvpacket_listener_t callback,
+                                    rcvpacket_filter_t filter,
                                     gpointer udata);
 
 void rcvtracker_add_packet(RcvTracker * this, RcvPacket* packet);
@@ -39,9 +39,59 @@ G_DEFINE_TYPE (Recycle, recycle, G_TYPE_OBJECT);
 //-------- Private functions belongs to Scheduler tree object ----------
 //----------------------------------------------------------------------
 
+typedef struct _Magazine Magazine;
+struct _Magazine{
+  Magazine*          next;
+  gint32             rounds;                          ///< number of items in the magazine
+  gpointer           items[RECYCLE_MAGAZINE_SIZE];
+};
+
+//Shared part of a pool, it outlives the Recycle until
+//every thread gave back the magazines it loaded from it.
+struct _RecycleDepot{
+  volatile gint      ref;
+  GMutex             mutex;
+  volatile gint      alive;
+  RecycleItemDtor    dtor;
+  Magazine*          full;
+  Magazine*          empty;
+  gint32             full_num;
+  gint32             full_limit;
+  guint64            hits;
+  guint64            misses;
+  gsize              item_size;       ///< size of the slab items, 0 if the pool has a ctor and dtor
+  gint32             slab_length;
+  GSList*            slabs;
+  gpointer           free_items;      ///< destroyed slab items linked through their first word
+  guint8*            carved;          ///< next item of the last slab not given out yet
+  guint8*            carved_end;
+};
+
+typedef struct{
+  RecycleDepot*      depot;
+  Magazine*          loaded;
+  Magazine*          previous;
+  guint64            hits;
+  guint64            misses;
+}ThreadSlot;
+
+//Open addressed table of the slots, so pools hashed to the same place do not evict each other
+typedef struct{
+  ThreadSlot**       slots;
+  guint32            mask;            ///< number of slots - 1, the number of slots is a power of 2
+  guint32            used;
+  gint               epoch;           ///< value of _freed_pools_epoch the cache last looked for freed pools at
+}ThreadCache;
+
 static void
 recycle_finalize (GObject * object);
 
+static void _thread_cache_dtor(gpointer data);
+
+static GPrivate _thread_cache = G_PRIVATE_INIT(_thread_cache_dtor);
+//Incremented whenever a pool is finalized, threads give back the magazines of freed pools when it changes
+static volatile gint _freed_pools_epoch = 0;
+
 void
 recycle_class_init (RecycleClass * klass)
 {
@@ -56,13 +106,317 @@ recycle_class_init (RecycleClass * klass)
 
 }
 
+static gpointer _slab_alloc(RecycleDepot* depot)
+{
+  gpointer result;
+  guint8* slab;
+  g_mutex_lock(&depot->mutex);
+  if(depot->free_items){
+    result = depot->free_items;
+    depot->free_items = *(gpointer*) result;
+  }else{
+    if(depot->carved == depot->carved_end){
+      slab = g_malloc(depot->item_size * depot->slab_length + RECYCLE_SLAB_ALIGNMENT - 1);
+      depot->slabs = g_slist_prepend(depot->slabs, slab);
+      depot->carved = (guint8*)(((gsize) slab + RECYCLE_SLAB_ALIGNMENT - 1) & ~((gsize) RECYCLE_SLAB_ALIGNMENT - 1));
+      depot->carved_end = depot->carved + depot->item_size * depot->slab_length;
+    }
+    result = depot->carved;
+    depot->carved += depot->item_size;
+  }
+  g_mutex_unlock(&depot->mutex);
+  memset(result, 0, depot->item_size);
+  return result;
+}
+
+static void _slab_free(RecycleDepot* depot, gpointer item)
+{
+  g_mutex_lock(&depot->mutex);
+  *(gpointer*) item = depot->free_items;
+  depot->free_items = item;
+  g_mutex_unlock(&depot->mutex);
+}
+
+static void _magazine_clear(Magazine* magazine, RecycleDepot* depot)
+{
+  while(0 < magazine->rounds){
+    if(depot->item_size){
+      _slab_free(depot, magazine->items[--magazine->rounds]);
+    }else{
+      depot->dtor(magazine->items[--magazine->rounds]);
+    }
+  }
+}
+
+static void _magazines_dtor(Magazine* magazine, RecycleDepot* depot)
+{
+  Magazine* next;
+  for(; magazine; magazine = next){
+    next = magazine->next;
+    _magazine_clear(magazine, depot);
+    g_slice_free(Magazine, magazine);
+  }
+}
+
+static void _depot_unref(RecycleDepot* depot)
+{
+  if(!g_atomic_int_dec_and_test(&depot->ref)){
+    return;
+  }
+  g_slist_free_full(depot->slabs, g_free);
+  g_mutex_clear(&depot->mutex);
+  g_slice_free(RecycleDepot, depot);
+}
+
+//Returns FALSE if the depot can not take the magazine,
+//then the caller destroys its items.
+static gboolean _depot_take_unlocked(RecycleDepot* depot, Magazine* magazine)
+{
+  if(!depot->alive){
+    return FALSE;
+  }
+  if(magazine->rounds == 0){
+    magazine->next = depot->empty;
+    depot->empty = magazine;
+    return TRUE;
+  }
+  if(depot->full_limit <= depot->full_num){
+    return FALSE;
+  }
+  magazine->next = depot->full;
+  depot->full = magazine;
+  ++depot->full_num;
+  return TRUE;
+}
+
+static void _flush_counters_unlocked(ThreadSlot* slot)
+{
+  slot->depot->hits += slot->hits;
+  slot->depot->misses += slot->misses;
+  slot->hits = slot->misses = 0;
+}
+
+static void _slot_release(ThreadSlot* slot)
+{
+  RecycleDepot* depot = slot->depot;
+  gboolean loaded_taken, previous_taken;
+
+  g_mutex_lock(&depot->mutex);
+  _flush_counters_unlocked(slot);
+  loaded_taken = _depot_take_unlocked(depot, slot->loaded);
+  previous_taken = _depot_take_unlocked(depot, slot->previous);
+  g_mutex_unlock(&depot->mutex);
+
+  if(!loaded_taken){
+    slot->loaded->next = NULL;
+    _magazines_dtor(slot->loaded, depot);
+  }
+  if(!previous_taken){
+    slot->previous->next = NULL;
+    _magazines_dtor(slot->previous, depot);
+  }
+  g_slice_free(ThreadSlot, slot);
+  _depot_unref(depot);
+}
+
+void _thread_cache_dtor(gpointer data)
+{
+  ThreadCache* cache = data;
+  guint32 i;
+  for(i = 0; i <= cache->mask; ++i){
+    if(cache->slots[i]){
+      _slot_release(cache->slots[i]);
+    }
+  }
+  g_free(cache->slots);
+  g_free(cache);
+}
+
+static guint32 _home(ThreadCache* cache, RecycleDepot* depot)
+{
+  return (guint32)(((guint64)(gsize) depot * G_GUINT64_CONSTANT(0x9E3779B97F4A7C15)) >> 32) & cache->mask;
+}
+
+//Returns the index of the slot of the depot or the empty index the probing stopped at.
+//The table is at most half full, so there is always an empty index.
+static guint32 _probe(ThreadCache* cache, RecycleDepot* depot)
+{
+  guint32 i = _home(cache, depot);
+  while(cache->slots[i] && cache->slots[i]->depot != depot){
+    i = (i + 1) & cache->mask;
+  }
+  return i;
+}
+
+static ThreadSlot* _find_slot(ThreadCache* cache, RecycleDepot* depot)
+{
+  return cache->slots[_probe(cache, depot)];
+}
+
+static void _grow(ThreadCache* cache)
+{
+  ThreadSlot** slots = cache->slots;
+  guint32 i, num = cache->mask + 1;
+  cache->slots = g_new0(ThreadSlot*, num << 1);
+  cache->mask  = (num << 1) - 1;
+  for(i = 0; i < num; ++i){
+    if(slots[i]){
+      cache->slots[_probe(cache, slots[i]->depot)] = slots[i];
+    }
+  }
+  g_free(slots);
+}
+
+//Takes the slot of the depot out of the table. The slots probed after it are shifted back
+//into the hole, so a later lookup does not stop there before reaching them.
+static ThreadSlot* _remove_slot(ThreadCache* cache, RecycleDepot* depot)
+{
+  guint32 i = _probe(cache, depot), j, home;
+  ThreadSlot* result = cache->slots[i];
+  if(!result){
+    return NULL;
+  }
+  for(j = (i + 1) & cache->mask; cache->slots[j]; j = (j + 1) & cache->mask){
+    home = _home(cache, cache->slots[j]->depot);
+    //the slot at j can fill the hole if its home is not between the hole and j
+    if(((j - i) & cache->mask) <= ((j - home) & cache->mask)){
+      cache->slots[i] = cache->slots[j];
+      i = j;
+    }
+  }
+  cache->slots[i] = NULL;
+  --cache->used;
+  return result;
+}
+
+//Gives back the magazines of the pools finalized since the last look,
+//so a thread does not hold the items of a freed pool until it exits.
+static void _release_freed_pools(ThreadCache* cache)
+{
+  RecycleDepot* depot;
+  guint32 i = 0;
+  while(i <= cache->mask){
+    depot = cache->slots[i] ? cache->slots[i]->depot : NULL;
+    if(!depot || g_atomic_int_get(&depot->alive)){
+      ++i;
+      continue;
+    }
+    //the index is checked again, a shifted back slot may have taken its place
+    _slot_release(_remove_slot(cache, depot));
+  }
+}
+
+static ThreadSlot* _get_slot(Recycle* this)
+{
+  ThreadCache* cache = g_private_get(&_thread_cache);
+  ThreadSlot* slot;
+  gint epoch = g_atomic_int_get(&_freed_pools_epoch);
+  if(G_UNLIKELY(!cache)){
+    cache = g_new0(ThreadCache, 1);
+    cache->slots = g_new0(ThreadSlot*, RECYCLE_THREAD_SLOTS_NUM);
+    cache->mask  = RECYCLE_THREAD_SLOTS_NUM - 1;
+    cache->epoch = epoch;
+    g_private_set(&_thread_cache, cache);
+  }
+  if(G_UNLIKELY(cache->epoch != epoch)){
+    cache->epoch = epoch;
+    _release_freed_pools(cache);
+  }
+  slot = _find_slot(cache, this->depot);
+  if(G_LIKELY(slot != NULL)){
+    return slot;
+  }
+  if(cache->mask < (cache->used + 1) << 1){
+    _grow(cache);
+  }
+  //slots are allocated one by one, so the one returned stays valid if the table grows meanwhile
+  slot = g_slice_new0(ThreadSlot);
+  g_atomic_int_inc(&this->depot->ref);
+  slot->depot    = this->depot;
+  slot->loaded   = g_slice_new0(Magazine);
+  slot->previous = g_slice_new0(Magazine);
+  cache->slots[_probe(cache, this->depot)] = slot;
+  ++cache->used;
+  return slot;
+}
+
+//Exchanges the empty loaded magazine to a full one if the depot has any
+static void _exchange_empty(ThreadSlot* slot)
+{
+  RecycleDepot* depot = slot->depot;
+  Magazine* full;
+  g_mutex_lock(&depot->mutex);
+  _flush_counters_unlocked(slot);
+  if(depot->full){
+    full = depot->full;
+    depot->full = full->next;
+    --depot->full_num;
+    slot->loaded->next = depot->empty;
+    depot->empty = slot->loaded;
+    slot->loaded = full;
+  }
+  g_mutex_unlock(&depot->mutex);
+}
+
+//Exchanges the full loaded magazine to an empty one,
+//or destroys its items if the depot is full as well
+static void _exchange_full(ThreadSlot* slot)
+{
+  RecycleDepot* depot = slot->depot;
+  Magazine* full = slot->loaded;
+  gboolean taken;
+  g_mutex_lock(&depot->mutex);
+  _flush_counters_unlocked(slot);
+  taken = _depot_take_unlocked(depot, full);
+  if(taken){
+    slot->loaded = depot->empty;
+    if(slot->loaded){
+      depot->empty = slot->loaded->next;
+    }
+  }
+  g_mutex_unlock(&depot->mutex);
+
+  if(!taken){
+    _magazine_clear(full, depot);
+  }else if(!slot->loaded){
+    slot->loaded = g_slice_new0(Magazine);
+  }
+}
+
+static void _swap(ThreadSlot* slot)
+{
+  Magazine* magazine = slot->loaded;
+  slot->loaded = slot->previous;
+  slot->previous = magazine;
+}
 
 void
 recycle_finalize (GObject * object)
 {
   Recycle *this = RECYCLE (object);
-  datapuffer_clear(this->items, this->dtor);
-  datapuffer_dtor(this->items);
+  RecycleDepot* depot = this->depot;
+  ThreadCache* cache = g_private_get(&_thread_cache);
+  ThreadSlot* slot = cache ? _remove_slot(cache, depot) : NULL;
+  Magazine *full, *empty;
+
+  if(slot){
+    _slot_release(slot);
+  }
+  //magazines other threads still hold are destroyed when they give them back,
+  //which they do at their next retrieve or add after the epoch changed
+  g_mutex_lock(&depot->mutex);
+  g_atomic_int_set(&depot->alive, FALSE);
+  full = depot->full;
+  empty = depot->empty;
+  depot->full = depot->empty = NULL;
+  depot->full_num = 0;
+  g_mutex_unlock(&depot->mutex);
+
+  g_atomic_int_inc(&_freed_pools_epoch);
+
+  _magazines_dtor(full, depot);
+  _magazines_dtor(empty, depot);
+  _depot_unref(depot);
 }
 
 void
@@ -74,27 +428,48 @@ recycle_init (Recycle * this)
 Recycle *make_recycle(gint32 size, RecycleItemCtor ctor, RecycleItemDtor dtor, RecycleItemShaper shaper)
 {
   Recycle *result = g_object_new(RECYCLE_TYPE, NULL);
-  result->items  = datapuffer_ctor(size);
+  result->depot  = g_slice_new0(RecycleDepot);
   result->ctor   = ctor;
   result->dtor   = dtor;
   result->shaper = shaper;
+
+  g_mutex_init(&result->depot->mutex);
+  result->depot->ref        = 1;
+  result->depot->alive      = TRUE;
+  result->depot->dtor       = dtor;
+  result->depot->full_limit = MAX(1, size / RECYCLE_MAGAZINE_SIZE);
+  return result;
+}
+
+Recycle *make_recycle_slab(gint32 size, gsize item_size, gint32 slab_length, RecycleItemShaper shaper)
+{
+  Recycle *result = make_recycle(size, NULL, NULL, shaper);
+  //items keep the alignment of the slab and a destroyed one holds the link of the free list
+  item_size = MAX(item_size, sizeof(gpointer));
+  result->depot->item_size   = (item_size + RECYCLE_SLAB_ALIGNMENT - 1) & ~((gsize) RECYCLE_SLAB_ALIGNMENT - 1);
+  result->depot->slab_length = MAX(1, slab_length);
   return result;
 }
 
 gpointer recycle_retrieve(Recycle* this)
 {
-  gpointer result = NULL;
-  if(datapuffer_isempty(this->items)){
-    result = this->ctor();
-    goto done;
+  ThreadSlot* slot = _get_slot(this);
+  if(slot->loaded->rounds == 0){
+    if(0 < slot->previous->rounds){
+      _swap(slot);
+    }else{
+      _exchange_empty(slot);
+    }
   }
-  result = datapuffer_read(this->items);
-//  g_print("from recycle %p item %p is read\n", this, result);
-  if (!result) {
-    result = this->ctor();
+  if(0 < slot->loaded->rounds){
+    ++slot->hits;
+    return slot->loaded->items[--slot->loaded->rounds];
   }
-done:
-  return result;
+  ++slot->misses;
+  if(this->depot->item_size){
+    return _slab_alloc(this->depot);
+  }
+  return this->ctor();
 }
 
 gpointer recycle_retrieve_and_shape(Recycle *this, gpointer udata)
@@ -108,13 +483,40 @@ gpointer recycle_retrieve_and_shape(Recycle *this, gpointer udata)
 
 void recycle_add(Recycle* this, gpointer item)
 {
+  ThreadSlot* slot = _get_slot(this);
+  if(slot->loaded->rounds == RECYCLE_MAGAZINE_SIZE){
+    if(slot->previous->rounds < RECYCLE_MAGAZINE_SIZE){
+      _swap(slot);
+    }else{
+      _exchange_full(slot);
+    }
+  }
+  slot->loaded->items[slot->loaded->rounds++] = item;
+}
 
-  if(datapuffer_isfull(this->items)){
-    this->dtor(item);
-    return;
+static guint64 _get_counter(Recycle* this, gsize offset)
+{
+  RecycleDepot* depot = this->depot;
+  ThreadCache* cache = g_private_get(&_thread_cache);
+  ThreadSlot* slot = cache ? _find_slot(cache, depot) : NULL;
+  guint64 result;
+  g_mutex_lock(&depot->mutex);
+  if(slot){
+    _flush_counters_unlocked(slot);
   }
+  result = G_STRUCT_MEMBER(guint64, depot, offset);
+  g_mutex_unlock(&depot->mutex);
+  return result;
+}
 
-  datapuffer_write(this->items, item);
+guint64 recycle_get_hits(Recycle* this)
+{
+  return _get_counter(this, G_STRUCT_OFFSET(RecycleDepot, hits));
+}
+
+guint64 recycle_get_misses(Recycle* this)
+{
+  return _get_counter(this, G_STRUCT_OFFSET(RecycleDepot, misses));
 }
 
 
@@ -128,6 +530,3 @@ DEFINE_RECYCLE_TYPE(/*global scope*/, int64, gint64)
 DEFINE_RECYCLE_TYPE(/*global scope*/, uint32, guint32)
 DEFINE_RECYCLE_TYPE(/*global scope*/, uint64, guint64)
 DEFINE_RECYCLE_TYPE(/*global scope*/, double, gdouble)
-
-
-
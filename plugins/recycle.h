@@ -40,6 +40,13 @@ scope Recycle* make_recycle_##name(gint32 size, RecycleItemShaper shaper)   \
   return result;                                                    \
 }
 
+//Same as DEFINE_RECYCLE_TYPE, but the items are carved from slabs of slab_length items
+#define DEFINE_RECYCLE_SLAB_TYPE(scope, name, type, slab_length)    \
+scope Recycle* make_recycle_##name(gint32 size, RecycleItemShaper shaper)   \
+{                                                                   \
+  return make_recycle_slab(size, sizeof(type), slab_length, shaper);   \
+}
+
 
 
 
@@ -49,10 +56,23 @@ typedef void (*RecycleItemDtor)(gpointer item);
 typedef void (*RecycleItemShaper)(gpointer result,gpointer udata);
 typedef gboolean (*RecycleItemUnrefAndTest)(gpointer item);
 
+//Number of items a magazine holds
+#define RECYCLE_MAGAZINE_SIZE 16
+//Initial size of the table a thread finds its magazines of the pools in,
+//it is doubled when it gets half full. Must be a power of 2.
+#define RECYCLE_THREAD_SLOTS_NUM 64
+//Items of slab pools start at this alignment, so the first cache line of an item is not shared
+#define RECYCLE_SLAB_ALIGNMENT 64
+
+typedef struct _RecycleDepot RecycleDepot;
+
+//Items can be retrieved and added on any thread.
+//Every thread keeps two magazines of items for the pool and
+//only locks the shared depot when it exchanges an empty or a full magazine.
 struct _Recycle
 {
   GObject                 object;
-  datapuffer_t*           items;
+  RecycleDepot*           depot;
   RecycleItemCtor         ctor;
   RecycleItemDtor         dtor;
 
@@ -68,10 +88,18 @@ struct _RecycleClass{
 GType recycle_get_type (void);
 
 Recycle *make_recycle(gint32 size, RecycleItemCtor ctor, RecycleItemDtor dtor, RecycleItemShaper shaper);
+//Items are carved from contiguous slabs instead of being allocated one by one.
+//A destroyed item goes back to the free list of the pool, the slabs are freed when the pool
+//and every magazine taken from it is gone, so items must be given back before that.
+Recycle *make_recycle_slab(gint32 size, gsize item_size, gint32 slab_length, RecycleItemShaper shaper);
 void recycle_set_unref_tester(Recycle* this, RecycleItemUnrefAndTest unref_and_test);
 gpointer recycle_retrieve(Recycle* this);
 gpointer recycle_retrieve_and_shape(Recycle *this, gpointer udata);
 void recycle_add(Recycle* this, gpointer item);
+//Retrieves served from a magazine and the ones had to construct a new item.
+//Counts of other threads are included up to their last magazine exchange.
+guint64 recycle_get_hits(Recycle* this);
+guint64 recycle_get_misses(Recycle* this);
 
 Recycle* make_recycle_uint8(gint32 size, RecycleItemShaper shaper);
 Recycle* make_recycle_uint16(gint32 size, RecycleItemShaper shaper);
@@ -157,20 +157,32 @@ void report_processor_set_ssrc(ReportProcessor *this, guint32 ssrc)
 void report_processor_process_mprtcp(ReportProcessor * this, GstBuffer* buffer, GstMPRTCPReportSummary* result)
 {
   guint32 ssrc;
-  GstMapInfo map = GST_MAP_INFO_INIT;
   GstMPRTCPSubflowReport *report;
   GstMPRTCPSubflowBlock *block;
 
-  gst_buffer_map(buffer, &map, GST_MAP_READ);
-  report = (GstMPRTCPSubflowReport *)map.data;
+  //the mapping is kept, so the summary can refer to the report instead of copying it
+  result->buffer = gst_buffer_ref(buffer);
+  gst_buffer_map(buffer, &result->map, GST_MAP_READ);
+  report = (GstMPRTCPSubflowReport *)result->map.data;
   gst_mprtcp_report_getdown(report, &ssrc);
   result->created = _now(this);
   result->ssrc = ssrc;
   result->updated = _now(this);
   block = gst_mprtcp_get_first_block(report);
   _processing_mprtcp_subflow_block(this, block, result);
+}
 
-  gst_buffer_unmap(buffer, &map);
+void report_processor_release_summary(ReportProcessor * this, GstMPRTCPReportSummary* summary)
+{
+  if(!summary->buffer){
+    return;
+  }
+  gst_buffer_unmap(summary->buffer, &summary->map);
+  gst_buffer_unref(summary->buffer);
+  summary->buffer = NULL;
+  summary->AFB.fci_data = NULL;
+  summary->XR.CongestionControlFeedback.chunks = NULL;
+  summary->XR.CongestionControlFeedback.chunks_num = 0;
 }
 
 void report_processor_set_logfile(ReportProcessor *this, const gchar *logfile)
@@ -316,8 +328,9 @@ _processing_afb (ReportProcessor *this,
                        &summary->AFB.fci_id);
 
   gst_rtcp_afb_getdown_fci_data(afb,
-                                summary->AFB.fci_data,
+                                NULL,
                                 &summary->AFB.fci_length);
+  summary->AFB.fci_data = (const gchar*) &afb->fci_data;
 }
 
 
@@ -367,6 +380,7 @@ _processing_xr_rle_losts_block (ReportProcessor *this,
   summary->XR.LostRLE.processed = TRUE;
   src = xrb->chunks;
   summary->XR.LostRLE.vector_length = 0;
+  memset(summary->XR.LostRLE.vector, 0, sizeof(summary->XR.LostRLE.vector));
   gst_rtcp_xr_rle_losts_getdown(xrb,
                                     &summary->XR.LostRLE.early_bit,
                                     &summary->XR.LostRLE.thinning,
@@ -380,8 +394,13 @@ _processing_xr_rle_losts_block (ReportProcessor *this,
   for(chunk_i = 0; chunk_i < chunks_num; ++chunk_i){
     gst_rtcp_xr_chunk_ntoh_cpy(&chunk, src + chunk_i);
     for(bit_i = 0; bit_i < 15 && _cmp_seq(seq, summary->XR.LostRLE.end_seq) <= 0; ++bit_i){
-      summary->XR.LostRLE.vector[summary->XR.LostRLE.vector_length++] =
-          0 < (chunk.Bitvector.bitvector & (guint16)(1<<bit_i)) ? TRUE : FALSE;
+      if(REPORT_SUMMARY_MAX_VECTOR_LENGTH <= summary->XR.LostRLE.vector_length){
+        return;
+      }
+      if(0 < (chunk.Bitvector.bitvector & (guint16)(1<<bit_i))){
+        report_summary_bit_set(summary->XR.LostRLE.vector, summary->XR.LostRLE.vector_length);
+      }
+      ++summary->XR.LostRLE.vector_length;
     }
   }
 }
@@ -399,7 +418,8 @@ _processing_xr_cc_rle_fb_block (ReportProcessor *this,
 
   summary->XR.CongestionControlFeedback.processed = TRUE;
   src = xrb->chunks;
-  summary->XR.LostRLE.vector_length = 0;
+  memset(summary->XR.CongestionControlFeedback.lost, 0, sizeof(summary->XR.CongestionControlFeedback.lost));
+  memset(summary->XR.CongestionControlFeedback.ecn, 0, sizeof(summary->XR.CongestionControlFeedback.ecn));
   gst_rtcp_xr_cc_fb_rle_getdown(xrb,
       &summary->XR.CongestionControlFeedback.report_count,
       &summary->XR.CongestionControlFeedback.report_timestamp,
@@ -407,12 +427,15 @@ _processing_xr_cc_rle_fb_block (ReportProcessor *this,
       &summary->XR.CongestionControlFeedback.begin_seq,
       &summary->XR.CongestionControlFeedback.end_seq
   );
-  chunks_num = gst_rtcp_xr_cc_fb_rle_block_get_chunks_num(xrb);
+  chunks_num = MIN(gst_rtcp_xr_cc_fb_rle_block_get_chunks_num(xrb), REPORT_SUMMARY_MAX_VECTOR_LENGTH);
+  summary->XR.CongestionControlFeedback.chunks = src;
+  summary->XR.CongestionControlFeedback.chunks_num = chunks_num;
   for(chunk_i = 0; chunk_i < chunks_num; ++chunk_i){
     gst_rtcp_xr_chunk_ntoh_cpy(&chunk, src + chunk_i);
-    summary->XR.CongestionControlFeedback.vector[chunk_i].ato = chunk.CCFeedback.ato;
-    summary->XR.CongestionControlFeedback.vector[chunk_i].ecn = chunk.CCFeedback.ecn;
-    summary->XR.CongestionControlFeedback.vector[chunk_i].lost = chunk.CCFeedback.lost;
+    report_summary_2bits_set(summary->XR.CongestionControlFeedback.ecn, chunk_i, chunk.CCFeedback.ecn);
+    if(chunk.CCFeedback.lost){
+      report_summary_bit_set(summary->XR.CongestionControlFeedback.lost, chunk_i);
+    }
   }
   if (summary->XR.CongestionControlFeedback.begin_seq < summary->XR.CongestionControlFeedback.end_seq) {
       summary->XR.CongestionControlFeedback.vector_length = summary->XR.CongestionControlFeedback.end_seq -
@@ -421,6 +444,8 @@ _processing_xr_cc_rle_fb_block (ReportProcessor *this,
     summary->XR.CongestionControlFeedback.vector_length = 65536 -
         summary->XR.CongestionControlFeedback.begin_seq + summary->XR.CongestionControlFeedback.end_seq + 1;
   }
+  summary->XR.CongestionControlFeedback.vector_length =
+      MIN(summary->XR.CongestionControlFeedback.vector_length, REPORT_SUMMARY_MAX_VECTOR_LENGTH);
 
 }
 
@@ -11,6 +11,7 @@
 #include <gst/gst.h>
 #include "streamjoiner.h"
 #include "ricalcer.h"
+#include "gstmprtcpbuffer.h"
 
 
 typedef struct _ReportProcessor ReportProcessor;
@@ -26,6 +27,16 @@ typedef struct _GstMPRTCPReportSummary GstMPRTCPReportSummary;
 #define REPORTPROCESSOR_CAST(src)        ((ReportProcessor *)(src))
 
 
+//Maximal number of packets a summarized loss or feedback vector covers
+#define REPORT_SUMMARY_MAX_VECTOR_LENGTH 1024
+
+//Vectors of one bit per packet, 32 packets in a word
+#define report_summary_bit_get(bits, index) (((bits)[(index) >> 5] >> ((index) & 31)) & 1)
+#define report_summary_bit_set(bits, index) ((bits)[(index) >> 5] |= 1u << ((index) & 31))
+//Vectors of two bits per packet, 16 packets in a word
+#define report_summary_2bits_get(bits, index) (((bits)[(index) >> 4] >> (((index) & 15) << 1)) & 3)
+#define report_summary_2bits_set(bits, index, value) ((bits)[(index) >> 4] |= ((guint32)(value) & 3) << (((index) & 15) << 1))
+
 typedef struct _GstMPRTCPXRReportSummary{
   gboolean            processed;
   struct{
@@ -42,7 +53,7 @@ typedef struct _GstMPRTCPXRReportSummary{
     guint8            thinning;
     guint16           begin_seq;
     guint16           end_seq;
-    gboolean          vector[1024];
+    guint32           vector[REPORT_SUMMARY_MAX_VECTOR_LENGTH / 32];
     guint             vector_length;
   }LostRLE;
 
@@ -66,11 +77,11 @@ typedef struct _GstMPRTCPXRReportSummary{
     guint32           report_timestamp;
     guint16           begin_seq;
     guint16           end_seq;
-    struct {
-     gboolean lost;
-     gboolean ecn;
-     guint16  ato;
-    }vector[1024];
+    guint32           lost[REPORT_SUMMARY_MAX_VECTOR_LENGTH / 32];
+    guint32           ecn[REPORT_SUMMARY_MAX_VECTOR_LENGTH / 16];
+    //arrival time offsets are read from the chunks of the report itself
+    const GstRTCPXRChunk* chunks;
+    guint             chunks_num;
     guint vector_length;
   }CongestionControlFeedback;
 }GstMPRTCPXRReportSummary;
@@ -104,11 +115,29 @@ struct _GstMPRTCPReportSummary{
     gboolean          processed;
     guint32           media_source_ssrc;
     guint32           fci_id;
-    gchar             fci_data[1400];
+    const gchar*      fci_data;
     guint             fci_length;
   }AFB;
+
+  //The views above point into the mapped report,
+  //they are valid until report_processor_release_summary is called
+  GstBuffer*          buffer;
+  GstMapInfo          map;
 };
 
+//Arrival time offset of the index-th packet of the congestion control feedback,
+//0 for packets the report has no chunk for
+static inline guint16
+report_summary_get_cc_ato(const GstMPRTCPXRReportSummary* xr, guint index)
+{
+  GstRTCPXRChunk chunk;
+  if(xr->CongestionControlFeedback.chunks_num <= index){
+    return 0;
+  }
+  gst_rtcp_xr_chunk_ntoh_cpy(&chunk, (GstRTCPXRChunk*) xr->CongestionControlFeedback.chunks + index);
+  return chunk.CCFeedback.ato;
+}
+
 
 
 struct _ReportProcessor
@@ -128,6 +157,7 @@ struct _ReportProcessorClass{
 
 void report_processor_set_ssrc(ReportProcessor *this, guint32 ssrc);
 void report_processor_process_mprtcp(ReportProcessor * this, GstBuffer* buffer, GstMPRTCPReportSummary* result);
+void report_processor_release_summary(ReportProcessor * this, GstMPRTCPReportSummary* summary);
 void report_processor_set_logfile(ReportProcessor *this, const gchar *logfile);
 GType report_processor_get_type (void);
 #endif /* REPPROCER_H_ */
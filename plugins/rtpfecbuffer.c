@@ -42,18 +42,16 @@ void rtpfecbuffer_init_segment(GstRTPFECSegment *segment)
 }
 
 
+//Extracted instead of mapped, so a buffer made of a header and payload memories is not merged
 void rtpfecbuffer_setup_bitstring(GstBuffer *buf, guint8 *bitstring, gint16 *bitstring_length)
 {
-  GstMapInfo info = GST_MAP_INFO_INIT;
   guint16 length, written_length;
-  gst_buffer_map(buf, &info, GST_MAP_READ);
-  memcpy(bitstring, info.data, 8);
-  length = info.size-12;
+  gst_buffer_extract(buf, 0, bitstring, 8);
+  length = gst_buffer_get_size(buf)-12;
   written_length = g_htons(length);
   memcpy(bitstring + 8, &written_length, 2);
-  memcpy(bitstring + 10, info.data + 12, length);
+  gst_buffer_extract(buf, 12, bitstring + 10, length);
   *bitstring_length = length + 10;
-  gst_buffer_unmap(buf, &info);
 }
 
 
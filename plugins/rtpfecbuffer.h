@@ -12,6 +12,8 @@
 
 
 #define GST_RTPFEC_MAX_PROTECTION_NUM 16
+//Maximal number of Reed-Solomon repair packets generated for one block
+#define GST_RTPFEC_MAX_REPAIR_NUM 8
 
 
 #ifdef __WIN32__
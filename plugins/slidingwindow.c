@@ -27,7 +27,7 @@
 #include <math.h>
 #include <string.h>
 
-#define _now(this) (gst_clock_get_time (this->sysclock))
+#define _now(this) (clocktick_now (this->sysclock))
 
 GST_DEBUG_CATEGORY_STATIC (slidingwindow_debug_category);
 #define GST_CAT_DEFAULT coslidingwindow_debug_category
@@ -339,7 +339,7 @@ gboolean _slidingwindow_default_obsolation(gpointer udata, SlidingWindowItem *it
   if(!this->treshold){
     return FALSE;
   }
-  return item->added < _now(this) - this->treshold;
+  return item->added < this->refreshed - this->treshold;
 }
 
 static void _slidingwindow_obsolate_time_limit(SlidingWindow* this)
@@ -377,7 +377,7 @@ again:
   goto again;
 }
 
-void slidingwindow_refresh(SlidingWindow *this)
+static void _slidingwindow_obsolate(SlidingWindow *this)
 {
   if(datapuffer_isempty(this->items)){
     return;
@@ -386,6 +386,12 @@ void slidingwindow_refresh(SlidingWindow *this)
   _slidingwindow_obsolate_time_limit(this);
 }
 
+void slidingwindow_refresh(SlidingWindow *this)
+{
+  this->refreshed = _now(this);
+  _slidingwindow_obsolate(this);
+}
+
 gpointer slidingwindow_peek_oldest(SlidingWindow* this)
 {
   SlidingWindowItem *item;
@@ -496,12 +502,13 @@ void slidingwindow_add_data(SlidingWindow* this, gpointer data)
 {
   SlidingWindowItem *item;
 
-  slidingwindow_refresh(this);
+  this->refreshed = _now(this);
+  _slidingwindow_obsolate(this);
 
 //  item = g_slice_new0(SlidingWindowItem);
   item = recycle_retrieve(this->items_recycle);
 
-  item->added = _now(this);
+  item->added = this->refreshed;
   if(this->data_recycle){
     item->data = recycle_retrieve_and_shape(this->data_recycle, data);
   }else{
@@ -621,4 +628,3 @@ void swplugin_dtor(gpointer target)
   swplugin = target;
   swplugin->disposer(swplugin);
 }
-
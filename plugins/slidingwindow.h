@@ -13,6 +13,7 @@
 #include "lib_bintree.h"
 #include "notifier.h"
 #include "recycle.h"
+#include "lib_clocktick.h"
 
 typedef struct _SlidingWindow SlidingWindow;
 typedef struct _SlidingWindowClass SlidingWindowClass;
@@ -44,6 +45,7 @@ struct _SlidingWindow
   gint                     min_itemnum;
   GstClock*                sysclock;
   GstClockTime             treshold;
+  GstClockTime             refreshed;       ///< time of the last obsolation
   gint32                   num_limit;
   gint32                   num_act_limit;
 
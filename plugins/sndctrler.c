@@ -148,6 +148,10 @@ sndctrler_finalize (GObject * object)
 {
   SndController *this = SNDCTRLER (object);
 
+  //the subflow controllers keep packets of the tracker
+  while(this->controllers){
+    _dispose_congestion_controller(this, this->controllers->data);
+  }
   g_object_unref (this->sysclock);
   g_object_unref (this->emit_msger);
   g_object_unref (this->subflows);
@@ -271,6 +275,7 @@ PROFILING("report_updater",
   }
 );
 done:
+  report_processor_release_summary(this->report_processor, summary);
   return;
 }
 
@@ -315,14 +320,12 @@ void
 _emit_signal (SndController *this)
 {
   MPRTPPluginSignal *msg;
-  messenger_lock(this->emit_msger);
-  msg = messenger_retrieve_block_unlocked(this->emit_msger);
+  msg = messenger_retrieve_block(this->emit_msger);
 
   _update_subflow_target_utilization(this);
   memcpy(msg, this->mprtp_signal_data, sizeof(MPRTPPluginSignal));
 
-  messenger_push_block_unlocked(this->emit_msger, msg);
-  messenger_unlock(this->emit_msger);
+  messenger_push_block(this->emit_msger, msg);
 }
 
 
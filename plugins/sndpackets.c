@@ -49,10 +49,14 @@ G_DEFINE_TYPE (SndPackets, sndpackets, G_TYPE_OBJECT);
 
 static void sndpackets_finalize (GObject * object);
 static void _setup_sndpacket(SndPacket* result, GstBuffer* buffer);
+static void _setup_header(SndPacket* packet, GstBuffer* buffer);
+static void _patch_header(SndPacket* packet, guint offset, gconstpointer data, gsize size);
 static void _setup_abs_time_extension(SndPacket* packet);
 static gboolean _vp8_keyframe_filter(GstBuffer* rtp);
 
-DEFINE_RECYCLE_TYPE(static, sndpacket, SndPacket);
+//Packets are carved from slabs, so the ones sent after each other are next to each other in memory
+DEFINE_RECYCLE_SLAB_TYPE(static, sndpacket, SndPacket, 64);
+G_STATIC_ASSERT(G_STRUCT_OFFSET(SndPacket, made) <= RECYCLE_SLAB_ALIGNMENT);
 
 //----------------------------------------------------------------------
 //--------- Private functions implementations to SchTree object --------
@@ -78,6 +82,7 @@ sndpackets_finalize (GObject * object)
   SndPackets *this;
   this = SNDPACKETS(object);
 
+  g_object_unref(this->recycle);
   g_object_unref(this->sysclock);
 
 }
@@ -114,13 +119,13 @@ SndPacket* sndpackets_make_packet(SndPackets* this, GstBuffer* buffer)
   SndPacket* result = recycle_retrieve_and_shape(this->recycle, buffer);
 
   result->made    = _now(this);
-  result->buffer  = buffer;
   result->destiny = this->recycle;
 
   result->mprtp_ext_header_id    = this->mprtp_ext_header_id;
   result->abs_time_ext_header_id = this->abs_time_ext_header_id;
 
   result->keyframe               = this->keyframe_filtercb ? this->keyframe_filtercb(buffer) : FALSE;
+  _setup_header(result, buffer);
   return result;
 }
 
@@ -195,16 +200,24 @@ void sndpacket_setup_mprtp(SndPacket *packet, guint8 subflow_id, guint16 subflow
     g_print("Packet %hu has no buffer\n", packet->abs_seq);
   }
 
-  {
+  if(!packet->mprtp_ext_offset){
 //    GstBuffer* prev = packet->buffer;
     packet->buffer = gst_buffer_make_writable(packet->buffer);
 //    g_print("%p -> %p\n", prev, packet->buffer);
   }
 
 
-  gst_rtp_buffer_map(packet->buffer, GST_MAP_READWRITE, &rtp);
-  gst_rtp_buffer_set_mprtp_extension(&rtp, packet->mprtp_ext_header_id, subflow_id, subflow_seq);
-  gst_rtp_buffer_unmap(&rtp);
+  if(packet->mprtp_ext_offset){
+    MPRTPSubflowHeaderExtension mprtp_ext;
+    memset(&mprtp_ext, 0, sizeof(mprtp_ext));
+    mprtp_ext.id  = subflow_id;
+    mprtp_ext.seq = subflow_seq;
+    _patch_header(packet, packet->mprtp_ext_offset, &mprtp_ext, sizeof(mprtp_ext));
+  }else{
+    gst_rtp_buffer_map(packet->buffer, GST_MAP_READWRITE, &rtp);
+    gst_rtp_buffer_set_mprtp_extension(&rtp, packet->mprtp_ext_header_id, subflow_id, subflow_seq);
+    gst_rtp_buffer_unmap(&rtp);
+  }
 
   packet->subflow_id  = subflow_id;
   packet->subflow_seq = subflow_seq;
@@ -213,26 +226,112 @@ void sndpacket_setup_mprtp(SndPacket *packet, guint8 subflow_id, guint16 subflow
 
 
 void _setup_sndpacket(SndPacket* result, GstBuffer* buffer)
+{
+  memset(result, 0, sizeof(SndPacket));
+  result->ref     = 1;
+}
+
+//Parses the packet and rebuilds its header into a separate memory in the same mapping.
+//The one-byte extension elements of the MPRTP and the absolute time extensions are reserved
+//in the new header, so later they are patched at fixed offsets and the payload memories
+//are shared with the original buffer instead of being copied or reallocated.
+void _setup_header(SndPacket* packet, GstBuffer* buffer)
 {
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstMemory* header;
+  GstMapInfo info;
+  GstBuffer* result;
+  gpointer ext_data = NULL;
+  guint16 ext_bits = 0;
+  guint ext_wordlen = 0;
+  guint fixed_length, header_length, ext_length, offset;
+
+  packet->buffer = buffer;
+  if(!gst_rtp_buffer_map(buffer, GST_MAP_READ, &rtp)){
+    return;
+  }
+  packet->abs_seq      = gst_rtp_buffer_get_seq(&rtp);
+  packet->timestamp    = gst_rtp_buffer_get_timestamp(&rtp);
+  packet->ssrc         = gst_rtp_buffer_get_ssrc(&rtp);
+  packet->payload_size = gst_rtp_buffer_get_payload_len(&rtp);
+  packet->payload_type = gst_rtp_buffer_get_payload_type(&rtp);
+  packet->header_size  = gst_rtp_buffer_get_header_len(&rtp);
+
+  if(packet->mprtp_ext_header_id < 1 || 14 < packet->mprtp_ext_header_id ||
+     packet->abs_time_ext_header_id < 1 || 14 < packet->abs_time_ext_header_id ||
+     packet->mprtp_ext_header_id == packet->abs_time_ext_header_id){
+    goto done;
+  }
+  if(gst_rtp_buffer_get_extension_data(&rtp, &ext_bits, &ext_data, &ext_wordlen)){
+    //only one-byte header extensions without our elements are rewritten, the rest goes the slow way
+    if(ext_bits != 0xBEDE ||
+       mprtp_peek_onebyte_extension(rtp.data[0], packet->header_size, packet->mprtp_ext_header_id) ||
+       mprtp_peek_onebyte_extension(rtp.data[0], packet->header_size, packet->abs_time_ext_header_id)){
+      goto done;
+    }
+  }
 
-  memset(result, 0, sizeof(SndPacket));
+  fixed_length = 12 + 4 * gst_rtp_buffer_get_csrc_count(&rtp);
+  ext_length   = ext_wordlen * 4 + 1 + sizeof(MPRTPSubflowHeaderExtension) + 1 + sizeof(RTPAbsTimeExtension);
+  ext_length   = (ext_length + 3) & ~3;
+  header = gst_allocator_alloc(NULL, fixed_length + 4 + ext_length, NULL);
+  gst_memory_map(header, &info, GST_MAP_WRITE);
+  memset(info.data, 0, info.size);
+  memcpy(info.data, rtp.data[0], fixed_length);
+  info.data[0] |= 0x10;
+  GST_WRITE_UINT16_BE(info.data + fixed_length, 0xBEDE);
+  GST_WRITE_UINT16_BE(info.data + fixed_length + 2, ext_length / 4);
+  offset = fixed_length + 4;
+  if(ext_data){
+    memcpy(info.data + offset, ext_data, ext_wordlen * 4);
+    offset += ext_wordlen * 4;
+  }
+  info.data[offset] = (packet->mprtp_ext_header_id << 4) | (sizeof(MPRTPSubflowHeaderExtension) - 1);
+  packet->mprtp_ext_offset = offset + 1;
+  offset += 1 + sizeof(MPRTPSubflowHeaderExtension);
+  info.data[offset] = (packet->abs_time_ext_header_id << 4) | (sizeof(RTPAbsTimeExtension) - 1);
+  packet->abs_time_ext_offset = offset + 1;
+  gst_memory_unmap(header, &info);
+
+  header_length = packet->header_size;
+  gst_rtp_buffer_unmap(&rtp);
 
-  gst_rtp_buffer_map(buffer, GST_MAP_READ, &rtp);
-  result->abs_seq      = gst_rtp_buffer_get_seq(&rtp);
-  result->timestamp    = gst_rtp_buffer_get_timestamp(&rtp);
-  result->ssrc         = gst_rtp_buffer_get_ssrc(&rtp);
-  result->payload_size = gst_rtp_buffer_get_payload_len(&rtp);
-  result->payload_type = gst_rtp_buffer_get_payload_type(&rtp);
-  result->header_size  = gst_rtp_buffer_get_header_len(&rtp);
+  result = gst_buffer_copy_region(buffer, GST_BUFFER_COPY_ALL, header_length,
+      gst_buffer_get_size(buffer) - header_length);
+  gst_buffer_prepend_memory(result, header);
+  gst_buffer_unref(buffer);
+  packet->buffer = result;
+  return;
+done:
   gst_rtp_buffer_unmap(&rtp);
+}
 
-  result->ref     = 1;
+//Writes into the header memory of the packet, the header is copied
+//only if another buffer (e.g. one held by the FEC encoder) shares it
+void _patch_header(SndPacket* packet, guint offset, gconstpointer data, gsize size)
+{
+  GstMemory* header;
+  GstMapInfo info;
+  packet->buffer = gst_buffer_make_writable(packet->buffer);
+  header = gst_buffer_peek_memory(packet->buffer, 0);
+  if(!gst_memory_is_writable(header)){
+    header = gst_memory_copy(header, 0, -1);
+    gst_buffer_replace_memory(packet->buffer, 0, header);
+  }
+  gst_memory_map(header, &info, GST_MAP_WRITE);
+  memcpy(info.data + offset, data, size);
+  gst_memory_unmap(header, &info);
 }
 
 void _setup_abs_time_extension(SndPacket* packet)
 {
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  if(packet->abs_time_ext_offset){
+    RTPAbsTimeExtension data;
+    mprtp_setup_abs_time_extension(&data);
+    _patch_header(packet, packet->abs_time_ext_offset, &data, sizeof(data));
+    return;
+  }
   packet->buffer = gst_buffer_make_writable(packet->buffer);
 
   gst_rtp_buffer_map(packet->buffer, GST_MAP_READWRITE, &rtp);
@@ -13,6 +13,7 @@
 #include "sndsubflows.h"
 #include "rcvsubflows.h"
 #include "recycle.h"
+#include "notifier.h"
 
 typedef struct _SndPackets SndPackets;
 typedef struct _SndPacketsClass SndPacketsClass;
@@ -31,50 +32,62 @@ typedef enum{
   SNDPACKET_IFRAME_FILTER_MODE_VP8 = 1,
 }SndPacketIFrameFilters;
 
+//Statistical analysis of the packets, compiled in only if MPRTP_PACKET_ANALYSIS is defined
+//(e.g.: ./configure CFLAGS=-DMPRTP_PACKET_ANALYSIS)
+typedef struct _SndPacketAnalysis
+{
+  guint32              dts;
+  guint32              qts;
+  gdouble              qsample;
+  guint32              subflow_skew;
+  guint                arrival_status;
+}SndPacketAnalysis;
+
+//The fields the tracker and the controllers touch for every sent and acknowledged
+//packet are in the first cache line, the ones only used at making and sending follow.
 typedef struct _SndPacket
 {
 //  SndPackets*          base_db;
   GstBuffer*           buffer;
+  GstClockTime         sent;
+  gint64               skew;
   gint                 ref;
+  guint                payload_size;
+  guint32              sent_ts;
+  guint32              rcvd_ts;
+  guint32              timestamp;
+  guint16              abs_seq;
+  guint16              subflow_seq;
+  guint8               subflow_id;
+  guint8               payload_type;
+  gboolean             lost;
+  gboolean             acknowledged;
+  gboolean             keyframe;
+
   GstClockTime         made;
-  GstClockTime         sent;
   GstClockTime         queued;
+  GstClockTime         scheduled;
+  gpointer             schnode;
+  Recycle*             destiny;
 
   gboolean             marker;
-  guint8               payload_type;
-  guint16              abs_seq;
-  guint32              timestamp;
   guint32              ssrc;
-
   guint                header_size;
-  guint                payload_size;
-
-  guint16              subflow_seq;
-  guint8               subflow_id;
-  gpointer             schnode;
-  GstClockTime         scheduled;
-
-  gboolean             lost;
-  gboolean             acknowledged;
 
   guint8               abs_time_ext_header_id;
   guint8               mprtp_ext_header_id;
-  Recycle*             destiny;
+  //Offsets of the reserved extension data in the header memory, 0 if the header is not rewritten
+  guint16              abs_time_ext_offset;
+  guint16              mprtp_ext_offset;
 
-  gboolean             keyframe;
-  guint32              sent_ts;
-  guint32              rcvd_ts;
-  gint64               skew;
-
-  // TODO: delete it when statistical analysis is finished
-  guint32 dts;
-  guint32 qts;
-  gdouble qsample;
-  guint32 subflow_skew;
-  guint arrival_status;
+#ifdef MPRTP_PACKET_ANALYSIS
+  SndPacketAnalysis    analysis;
+#endif
 
 }SndPacket;
 
+DEFINE_NOTIFIER_TYPE(sndpacket, SndPacket*)
+
 
 struct _SndPackets
 {
@@ -98,6 +111,12 @@ struct _SndPacketsClass{
 
 
 GType sndpackets_get_type (void);
+//Packets are carved from slabs owned by the returned object and the slabs are freed
+//when it is finalized, whether or not packets are still referenced.
+//Any SndPacket pointer kept afterwards dangles: the windows of the tracker,
+//the packets of the subflow controllers and whatever the listeners of the
+//tracker's sent and obsolated notifiers kept. So the controllers, the tracker
+//and the queue must be unrefed before the last reference of it is dropped.
 SndPackets* make_sndpackets(void);
 void sndpackets_reset(SndPackets* this);
 
@@ -32,9 +32,15 @@
 GST_DEBUG_CATEGORY_STATIC (sndqueue_debug_category);
 #define GST_CAT_DEFAULT sndqueue_debug_category
 
-#define _now(this) gst_clock_get_time (this->sysclock)
+#define _now(this) clocktick_now (this->sysclock)
 #define _priv(this) ((Private*)(this->priv))
 #define _stat(this) ((RTPQueueStat*)(&this->stat))
+
+//Resolution of the timer wheel the paced subflows are waiting in
+#define SNDQUEUE_PACING_RESOLUTION (50 * GST_USECOND)
+//Bytes a subflow can send at once after it was idle
+#define SNDQUEUE_PACING_BURST_TIME (5 * GST_MSECOND)
+#define SNDQUEUE_PACING_MIN_BURST_BYTES 3000
 //#define _get_subflow(this, subflow_id) ((Subflow*)(_priv(this)->subflows + subflow_id))
 
 G_DEFINE_TYPE (SndQueue, sndqueue, G_TYPE_OBJECT);
@@ -96,6 +102,7 @@ sndqueue_finalize (GObject * object)
   g_object_unref(this->sysclock);
   g_object_unref(this->on_packet_queued);
   g_object_unref(this->unqueued_packets);
+  timerwheel_dtor(this->pacing_wheel);
 }
 
 
@@ -118,23 +125,30 @@ SndQueue *make_sndqueue(SndSubflows* subflows_db)
   }
   this->unqueued_packets = g_queue_new();
   this->queued_bytes_considered = TRUE;
+  this->pacing_wheel = timerwheel_ctor(SNDQUEUE_PACING_RESOLUTION, _now(this));
   return this;
 }
 
-void sndqueue_add_on_packet_queued(SndQueue * this, ListenerFunc callback, gpointer udata)
+void sndqueue_add_on_packet_queued(SndQueue * this, sndpacket_listener_t callback, gpointer udata)
 {
-  notifier_add_listener(this->on_packet_queued, callback, udata);
+  notifier_add_sndpacket_listener(this->on_packet_queued, callback, udata);
 }
 
 void sndqueue_on_subflow_joined(SndQueue* this, SndSubflow* subflow)
 {
+  SndQueuePacer* pacer = this->pacers + subflow->id;
   this->packets[subflow->id] = g_queue_new();
+  timerwheel_remove(this->pacing_wheel, &pacer->timer);
+  pacer->tokens = 0.;
+  pacer->refilled = _now(this);
+  this->pacing_bitrate[subflow->id] = 0;
 }
 
 void sndqueue_on_subflow_detached(SndQueue* this, SndSubflow* subflow)
 {
   g_object_unref(this->packets[subflow->id]);
   this->packets[subflow->id] = NULL;
+  timerwheel_remove(this->pacing_wheel, &this->pacers[subflow->id].timer);
 }
 
 void
@@ -238,7 +252,7 @@ void sndqueue_push_packet(SndQueue * this, SndPacket* packet)
   ++_stat(this)->packets_in_queue[packet->subflow_id];
 
   packet->queued = _now(this);
-  notifier_do(this->on_packet_queued, packet);
+  notifier_do_sndpacket(this->on_packet_queued, packet);
 
   subflow = sndsubflows_get_subflow(this->subflows, packet->subflow_id);
 
@@ -265,6 +279,7 @@ void sndqueue_push_packet(SndQueue * this, SndPacket* packet)
 typedef struct{
   GstClockTime next_approve;
   guint8       subflow_id;
+  gboolean     paced;
   SndQueue*    this;
 }PopHelperTuple;
 
@@ -273,15 +288,31 @@ static void _pop_helper(SndSubflow* subflow, PopHelperTuple* pop_helper) {
     return;
   }
 
+  if (timerwheel_timer_is_pending(&pop_helper->this->pacers[subflow->id].timer)) {
+    pop_helper->paced = TRUE;
+    return;
+  }
+
   if (!pop_helper->subflow_id || subflow->pacing_time < pop_helper->next_approve) {
     pop_helper->subflow_id   = subflow->id;
     pop_helper->next_approve = subflow->pacing_time;
   }
 }
 
+static void _refill_tokens(SndQueue * this, guint8 subflow_id, GstClockTime now) {
+  SndQueuePacer* pacer = this->pacers + subflow_id;
+  gdouble rate = this->pacing_bitrate[subflow_id];
+  gdouble burst = MAX(SNDQUEUE_PACING_MIN_BURST_BYTES, rate * SNDQUEUE_PACING_BURST_TIME / GST_SECOND);
+  if (pacer->refilled < now) {
+    pacer->tokens = MIN(burst, pacer->tokens + rate * (now - pacer->refilled) / GST_SECOND);
+  }
+  pacer->refilled = now;
+}
+
 static void _set_pacing_time(SndQueue * this, guint8 subflow_id, SndPacket* packet) {
   SndSubflow* subflow = sndsubflows_get_subflow(this->subflows, subflow_id);
-  gdouble pacing_interval_in_s;
+  SndQueuePacer* pacer = this->pacers + subflow_id;
+  GstClockTime now = _now(this);
   gdouble alpha = 1. / (gdouble)_stat(this)->packets_in_queue[subflow->id];
   volatile gint32* pacing_bitrate = this->pacing_bitrate + subflow->id;
 
@@ -299,30 +330,43 @@ static void _set_pacing_time(SndQueue * this, guint8 subflow_id, SndPacket* pack
 //    *pacing_bitrate = (1.2 * this->actual_targets[subflow_id]) / 8;
   }
 
-  pacing_interval_in_s = (gdouble) packet->payload_size / (gdouble) *pacing_bitrate;
-  subflow->pacing_time = _now(this) + pacing_interval_in_s * GST_SECOND;
+  //Without a target the subflow is not paced
+  if (*pacing_bitrate <= 0) {
+    pacer->tokens = 0.;
+    pacer->refilled = now;
+    subflow->pacing_time = now;
+    return;
+  }
+
+  _refill_tokens(this, subflow_id, now);
+  pacer->tokens -= packet->payload_size;
+  if (0. <= pacer->tokens) {
+    subflow->pacing_time = now;
+    return;
+  }
+  //The subflow waits in the wheel until the debt is paid back
+  subflow->pacing_time = now + (-pacer->tokens / (gdouble) *pacing_bitrate) * GST_SECOND;
+  timerwheel_add(this->pacing_wheel, &pacer->timer, subflow->pacing_time);
 }
 
 SndPacket* sndqueue_pop_packet(SndQueue * this, GstClockTime* next_approve)
 {
   SndPacket* result = NULL;
   GQueue* queue;
-  PopHelperTuple pop_helper = {*next_approve,0,this};
+  PopHelperTuple pop_helper = {*next_approve,0,FALSE,this};
   GstClockTime now = _now(this);
 
+  //subflows whose timer expired can send again
+  timerwheel_advance(this->pacing_wheel, now, NULL, NULL);
   sndsubflows_iterate(this->subflows, (GFunc) _pop_helper, &pop_helper);
 
   if(!pop_helper.subflow_id) {
-    this->empty = TRUE;
+    if (pop_helper.paced) {
+      *next_approve = timerwheel_get_next_expiry(this->pacing_wheel);
+    } else {
+      this->empty = TRUE;
+    }
     goto done;
-  }else if(now < pop_helper.next_approve){
-    // TODO: here we can switch pacing back.
-//    if(next_approve){
-//      *next_approve = MIN(pop_helper.next_approve, *next_approve);
-//    }
-//    if (*next_approve < now - GST_MSECOND) {
-//      goto done;
-//    }
   }
 
   queue = this->packets[pop_helper.subflow_id];
@@ -13,6 +13,7 @@
 #include "sndsubflows.h"
 #include "sndpackets.h"
 #include "slidingwindow.h"
+#include "lib_timerwheel.h"
 
 typedef struct _SndQueue SndQueue;
 typedef struct _SndQueueClass SndQueueClass;
@@ -34,6 +35,13 @@ typedef struct _RTPQueueStat{
   gint32                    total_pushed_packets;
 }RTPQueueStat;
 
+//Token bucket of a subflow, the subflow is paced while its timer is pending
+typedef struct _SndQueuePacer{
+  timerwheeltimer_t         timer;      ///< expires when the bucket is refilled to zero
+  gdouble                   tokens;     ///< bytes can be sent in a burst, negative while paced
+  GstClockTime              refilled;
+}SndQueuePacer;
+
 struct _SndQueue
 {
   GObject                   object;
@@ -51,6 +59,8 @@ struct _SndQueue
 //  volatile gint32           total_queued_bytes;
   volatile gint32           actual_targets[MPRTP_PLUGIN_MAX_SUBFLOW_NUM];
   volatile gint32           pacing_bitrate[MPRTP_PLUGIN_MAX_SUBFLOW_NUM];
+  SndQueuePacer             pacers[MPRTP_PLUGIN_MAX_SUBFLOW_NUM];
+  timerwheel_t*             pacing_wheel;
   volatile gboolean         empty;
   volatile gint32           total_bitrate;
   volatile gint32           total_target;
@@ -67,13 +77,15 @@ struct _SndQueueClass{
 GType sndqueue_get_type (void);
 SndQueue *make_sndqueue(SndSubflows* subflows_db);
 
-void sndqueue_add_on_packet_queued(SndQueue * this, ListenerFunc callback, gpointer udata);
+void sndqueue_add_on_packet_queued(SndQueue * this, sndpacket_listener_t callback, gpointer udata);
 void sndqueue_on_subflow_joined(SndQueue* this, SndSubflow* subflow);
 void sndqueue_on_subflow_detached(SndQueue* this, SndSubflow* subflow);
 void sndqueue_on_subflow_state_changed(SndQueue* this, SndSubflow* subflow);
 void sndqueue_on_subflow_target_bitrate_changed(SndQueue* this, SndSubflow* subflow);
 
 void sndqueue_push_packet(SndQueue * this, SndPacket* packet);
+//Returns NULL and sets next_approve to the time a paced subflow can send again
+//if there are queued packets, but all of them belongs to paced subflows
 SndPacket* sndqueue_pop_packet(SndQueue* this, GstClockTime* next_approve);
 gboolean sndqueue_is_empty(SndQueue* this);
 RTPQueueStat* sndqueue_get_stat(SndQueue* this);
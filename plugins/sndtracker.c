@@ -32,7 +32,7 @@
 GST_DEBUG_CATEGORY_STATIC (sndtracker_debug_category);
 #define GST_CAT_DEFAULT sndtracker_debug_category
 
-#define _now(this) gst_clock_get_time (this->sysclock)
+#define _now(this) clocktick_now (this->sysclock)
 #define _priv(this) ((Private*)(this->priv))
 //#define _get_subflow(this, subflow_id) ((Subflow*)(_priv(this)->subflows + subflow_id))
 
@@ -43,10 +43,20 @@ typedef struct{
   gpointer   udata;
 }SubflowNotifier;
 
+//The sent packets window holds at most this many packets at once
+#define SNDTRACKER_SENT_WINDOW_LENGTH 1000
+//Sent packets of a subflow are indexed by their subflow sequence modulo this,
+//which is not less than the sent window, so in-flight packets never share a slot
+#define SNDTRACKER_SENT_RING_LENGTH 1024
+//Descriptors of the sent packets this many sequences ahead are prefetched at batch retrieving
+#define SNDTRACKER_PREFETCH_DISTANCE 8
+#define _prefetch(addr) __builtin_prefetch(addr)
+#define _sent_slot(subflow, seq) ((subflow)->sent_packets[(guint16)(seq) & (SNDTRACKER_SENT_RING_LENGTH - 1)])
+
 typedef struct _Subflow{
   gboolean            init;
   SndTrackerStat      stat;
-  SndPacket*          sent_packets[65536];
+  SndPacket**         sent_packets;
 }Subflow;
 
 typedef struct _Priv{
@@ -87,6 +97,15 @@ static Subflow* _get_subflow(
     SndTracker *this,
     guint8 subflow_id);
 
+static void
+_init_subflow(Subflow* subflow);
+
+static void
+_stat_acked(SndTrackerStat* stat, gint32 packets_num, gint32 bytes, gint32 received_num, gint32 received_bytes);
+
+static void
+_stat_found(SndTrackerStat* stat, gint32 packets_num, gint32 bytes);
+
 //----------------------------------------------------------------------
 //--------- Private functions implementations to SchTree object --------
 //----------------------------------------------------------------------
@@ -127,7 +146,7 @@ void
 sndtracker_init (SndTracker * this)
 {
   this->sysclock = gst_system_clock_obtain();
-  this->sent_sw  = make_slidingwindow(1000, GST_SECOND);
+  this->sent_sw  = make_slidingwindow(SNDTRACKER_SENT_WINDOW_LENGTH, GST_SECOND);
   this->acked_sw = make_slidingwindow(1000, GST_SECOND);
   this->fec_sw   = make_slidingwindow(500, GST_SECOND);
 
@@ -206,9 +225,12 @@ void sndtracker_packet_sent(SndTracker * this, SndPacket* packet)
     subflow->stat.total_sent_bytes += packet->payload_size;
     ++subflow->stat.total_sent_packets;
 
-    subflow->sent_packets[packet->subflow_seq] = packet;
+    if(!subflow->init){
+      _init_subflow(subflow);
+    }
+    _sent_slot(subflow, packet->subflow_seq) = packet;
 
-    notifier_do(this->on_packet_sent, packet);
+    notifier_do_sndpacket(this->on_packet_sent, packet);
   }
 
   slidingwindow_add_data(this->sent_sw, sndpacket_ref(packet));
@@ -234,7 +256,45 @@ void sndtracker_packet_sent(SndTracker * this, SndPacket* packet)
 SndPacket* sndtracker_retrieve_sent_packet(SndTracker * this, guint8 subflow_id, guint16 subflow_seq)
 {
   Subflow* subflow = _get_subflow(this, subflow_id);
-  SndPacket* result = subflow->sent_packets[subflow_seq];
+  SndPacket* result;
+  if(!subflow->sent_packets){
+    return NULL;
+  }
+  result = _sent_slot(subflow, subflow_seq);
+  //the slot may hold an older packet not obsolated yet, or a newer one
+  if(!result || result->subflow_seq != subflow_seq){
+    return NULL;
+  }
+  return result;
+}
+
+gint32 sndtracker_retrieve_sent_packets(SndTracker * this, guint8 subflow_id, guint16 begin_seq,
+    gint32 length, SndPacket** packets)
+{
+  Subflow* subflow = _get_subflow(this, subflow_id);
+  SndPacket* packet;
+  gint32 i, result = 0;
+  guint16 seq;
+  if(!subflow->sent_packets){
+    memset(packets, 0, sizeof(SndPacket*) * length);
+    return 0;
+  }
+  //the ring is contiguous, the descriptors it points to are the ones missing from the cache
+  for(i = 0; i < length && i < SNDTRACKER_PREFETCH_DISTANCE; ++i){
+    _prefetch(_sent_slot(subflow, begin_seq + i));
+  }
+  for(i = 0, seq = begin_seq; i < length; ++i, ++seq){
+    if(i + SNDTRACKER_PREFETCH_DISTANCE < length){
+      _prefetch(_sent_slot(subflow, seq + SNDTRACKER_PREFETCH_DISTANCE));
+    }
+    packet = _sent_slot(subflow, seq);
+    if(!packet || packet->subflow_seq != seq){
+      packet = NULL;
+    }else{
+      ++result;
+    }
+    packets[i] = packet;
+  }
   return result;
 }
 
@@ -248,80 +308,85 @@ GstClockTime sndtracker_get_intervals_per_frame(SndTracker* this) {
 
 void sndtracker_packet_found(SndTracker * this, SndPacket* packet)
 {
-  packet->lost = FALSE;
-  //subtract from lost
-
-  this->stat.received_bytes_in_1s += packet->payload_size;
-  ++this->stat.received_packets_in_1s;
-
-  this->stat.total_received_bytes += packet->payload_size;
-  ++this->stat.total_received_packets;
-
-  --this->stat.lost_packets_in_1s;
-
-  if(packet->subflow_id != 0){
-    Subflow* subflow = _get_subflow(this, packet->subflow_id);
-
-    subflow->stat.received_bytes_in_1s += packet->payload_size;
-    ++subflow->stat.received_packets_in_1s;
+  sndtracker_packets_found(this, packet->subflow_id, &packet, 1);
+}
 
-    subflow->stat.total_received_bytes += packet->payload_size;
-    ++subflow->stat.total_received_packets;
+void sndtracker_packets_found(SndTracker * this, guint8 subflow_id, SndPacket** packets, gint32 packets_num)
+{
+  gint32 i, bytes = 0;
+  if(packets_num < 1){
+    return;
+  }
+  for(i = 0; i < packets_num; ++i){
+    packets[i]->lost = FALSE;
+    bytes += packets[i]->payload_size;
+  }
 
-    --subflow->stat.lost_packets_in_1s;
+  _stat_found(&this->stat, packets_num, bytes);
+  if(subflow_id != 0){
+    _stat_found(&_get_subflow(this, subflow_id)->stat, packets_num, bytes);
   }
 }
 
 
 void sndtracker_packet_acked(SndTracker * this, SndPacket* packet)
 {
+  sndtracker_packets_acked(this, packet->subflow_id, &packet, 1);
+}
 
-  this->stat.bytes_in_flight -= packet->payload_size;
-  --this->stat.packets_in_flight;
-
-  this->stat.acked_bytes_in_1s += packet->payload_size;
-  ++this->stat.acked_packets_in_1s;
-
-  this->stat.total_acked_bytes += packet->payload_size;
-  ++this->stat.total_acked_packets;
-
-  if(!packet->lost){
-    this->stat.received_bytes_in_1s += packet->payload_size;
-    ++this->stat.received_packets_in_1s;
+void sndtracker_packets_acked(SndTracker * this, guint8 subflow_id, SndPacket** packets, gint32 packets_num)
+{
+  gint32 i, bytes = 0, received_num = 0, received_bytes = 0;
+  SndPacket* packet;
+  if(packets_num < 1){
+    return;
+  }
+  for(i = 0; i < packets_num; ++i){
+    packet = packets[i];
+    bytes += packet->payload_size;
+    if(!packet->lost){
+      received_bytes += packet->payload_size;
+      ++received_num;
+    }
+    slidingwindow_add_data(this->acked_sw,  sndpacket_ref(packet));
+  }
 
-    this->stat.total_received_bytes += packet->payload_size;
-    ++this->stat.total_received_packets;
-  } else {
-    ++this->stat.lost_packets_in_1s;
+  _stat_acked(&this->stat, packets_num, bytes, received_num, received_bytes);
+  if(subflow_id != 0){
+    _stat_acked(&_get_subflow(this, subflow_id)->stat, packets_num, bytes, received_num, received_bytes);
   }
+}
 
-  if(packet->subflow_id != 0){
-    Subflow* subflow = _get_subflow(this, packet->subflow_id);
+void _stat_acked(SndTrackerStat* stat, gint32 packets_num, gint32 bytes, gint32 received_num, gint32 received_bytes)
+{
+  stat->bytes_in_flight -= bytes;
+  stat->packets_in_flight -= packets_num;
 
-    subflow->stat.bytes_in_flight -= packet->payload_size;
-    --subflow->stat.packets_in_flight;
+  stat->acked_bytes_in_1s += bytes;
+  stat->acked_packets_in_1s += packets_num;
 
-    subflow->stat.acked_bytes_in_1s += packet->payload_size;
-    ++subflow->stat.acked_packets_in_1s;
+  stat->total_acked_bytes += bytes;
+  stat->total_acked_packets += packets_num;
 
-    subflow->stat.total_acked_bytes += packet->payload_size;
-    ++subflow->stat.total_acked_packets;
+  stat->received_bytes_in_1s += received_bytes;
+  stat->received_packets_in_1s += received_num;
 
-    if(!packet->lost){
-      subflow->stat.received_bytes_in_1s += packet->payload_size;
-      ++subflow->stat.received_packets_in_1s;
+  stat->total_received_bytes += received_bytes;
+  stat->total_received_packets += received_num;
 
-      subflow->stat.total_received_bytes += packet->payload_size;
-      ++subflow->stat.total_received_packets;
-    }else {
-      ++subflow->stat.lost_packets_in_1s;
-    }
+  stat->lost_packets_in_1s += packets_num - received_num;
+}
 
-  }
+void _stat_found(SndTrackerStat* stat, gint32 packets_num, gint32 bytes)
+{
+  stat->received_bytes_in_1s += bytes;
+  stat->received_packets_in_1s += packets_num;
 
-  slidingwindow_add_data(this->acked_sw,  sndpacket_ref(packet));
+  stat->total_received_bytes += bytes;
+  stat->total_received_packets += packets_num;
 
-  return;
+  //subtract from lost
+  stat->lost_packets_in_1s -= packets_num;
 }
 
 void sndtracker_add_fec_response(SndTracker * this, FECEncoderResponse *fec_response)
@@ -339,14 +404,14 @@ void sndtracker_add_fec_response(SndTracker * this, FECEncoderResponse *fec_resp
   slidingwindow_add_data(this->fec_sw, fec_response);
 }
 
-void sndtracker_add_on_packet_sent(SndTracker * this, ListenerFunc callback, gpointer udata)
+void sndtracker_add_on_packet_sent(SndTracker * this, sndpacket_listener_t callback, gpointer udata)
 {
-  notifier_add_listener(this->on_packet_sent, callback, udata);
+  notifier_add_sndpacket_listener(this->on_packet_sent, callback, udata);
 }
 
-void sndtracker_add_on_packet_obsolated(SndTracker * this, ListenerFunc callback, gpointer udata)
+void sndtracker_add_on_packet_obsolated(SndTracker * this, sndpacket_listener_t callback, gpointer udata)
 {
-  notifier_add_listener(this->on_packet_obsolated, callback, udata);
+  notifier_add_sndpacket_listener(this->on_packet_obsolated, callback, udata);
 }
 
 void sndtracker_add_on_stat_changed(SndTracker * this, ListenerFunc callback, gpointer udata)
@@ -354,14 +419,14 @@ void sndtracker_add_on_stat_changed(SndTracker * this, ListenerFunc callback, gp
   notifier_add_listener(this->on_stat_changed, callback, udata);
 }
 
-void sndtracker_add_on_packet_sent_with_filter(SndTracker * this, ListenerFunc callback, ListenerFilterFunc filter, gpointer udata)
+void sndtracker_add_on_packet_sent_with_filter(SndTracker * this, sndpacket_listener_t callback, sndpacket_filter_t filter, gpointer udata)
 {
-  notifier_add_listener_with_filter(this->on_packet_sent, callback, filter, udata);
+  notifier_add_sndpacket_listener_with_filter(this->on_packet_sent, callback, filter, udata);
 }
 
-void sndtracker_rem_on_packet_sent(SndTracker * this, ListenerFunc callback)
+void sndtracker_rem_on_packet_sent(SndTracker * this, sndpacket_listener_t callback)
 {
-  notifier_rem_listener(this->on_packet_sent, callback);
+  notifier_rem_sndpacket_listener(this->on_packet_sent, callback);
 }
 
 void _sent_packets_rem_pipe(SndTracker* this, SndPacket* packet)
@@ -381,9 +446,12 @@ void _sent_packets_rem_pipe(SndTracker* this, SndPacket* packet)
     if(!packet->acknowledged){
 //      g_print("Packet %hu is not acknowledged in time\n", packet->subflow_seq);
     }
-    subflow->sent_packets[packet->subflow_seq] = NULL;
+    if(subflow->sent_packets &&
+       _sent_slot(subflow, packet->subflow_seq) == packet){
+      _sent_slot(subflow, packet->subflow_seq) = NULL;
+    }
 
-    notifier_do(this->on_packet_obsolated, packet);
+    notifier_do_sndpacket(this->on_packet_obsolated, packet);
   }
 
   if(!packet->acknowledged){
@@ -456,9 +524,19 @@ static Private* _priv_ctor(void)
 
 static void _priv_dtor(Private *priv)
 {
+  gint i;
+  for(i = 0; i < 256; ++i){
+    g_free(priv->subflows[i].sent_packets);
+  }
   g_free(priv);
 }
 
+void _init_subflow(Subflow* subflow)
+{
+  subflow->sent_packets = g_malloc0(sizeof(SndPacket*) * SNDTRACKER_SENT_RING_LENGTH);
+  subflow->init = TRUE;
+}
+
 void
 _on_subflow_joined(SndTracker* this, SndSubflow* sndsubflow)
 {
@@ -466,7 +544,7 @@ _on_subflow_joined(SndTracker* this, SndSubflow* sndsubflow)
   if(subflow->init){
     return;
   }
-  subflow->init = TRUE;
+  _init_subflow(subflow);
 }
 
 void
@@ -481,4 +559,3 @@ Subflow* _get_subflow(SndTracker *this, guint8 subflow_id)
   result = _priv(this)->subflows + subflow_id;
   return result;
 }
-
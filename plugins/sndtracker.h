@@ -97,14 +97,22 @@ void sndtracker_packet_sent(SndTracker * this, SndPacket* packet);
 SndPacket* sndtracker_retrieve_sent_packet(SndTracker * this, guint8 subflow_id, guint16 subflow_seq);
 gdouble sndtracker_get_packets_per_frame(SndTracker* this);
 GstClockTime sndtracker_get_intervals_per_frame(SndTracker* this);
+//Fills packets with the tracked packets of the subflow sent with the sequences from begin_seq
+//(NULL where the packet is not tracked anymore) and returns the number of packets found.
+//Descriptors are prefetched ahead, so a feedback vector is resolved in one pass.
+gint32 sndtracker_retrieve_sent_packets(SndTracker * this, guint8 subflow_id, guint16 begin_seq,
+    gint32 length, SndPacket** packets);
 void sndtracker_packet_found(SndTracker * this, SndPacket* packet);
 void sndtracker_packet_acked(SndTracker * this, SndPacket* packet);
+//Batch versions of the above for packets all sent on the given subflow, the stats are updated once
+void sndtracker_packets_found(SndTracker * this, guint8 subflow_id, SndPacket** packets, gint32 packets_num);
+void sndtracker_packets_acked(SndTracker * this, guint8 subflow_id, SndPacket** packets, gint32 packets_num);
 void sndtracker_add_fec_response(SndTracker * this, FECEncoderResponse *fec_response);
-void sndtracker_add_on_packet_sent(SndTracker * this, ListenerFunc callback, gpointer udata);
-void sndtracker_add_on_packet_obsolated(SndTracker * this, ListenerFunc callback, gpointer udata);
+void sndtracker_add_on_packet_sent(SndTracker * this, sndpacket_listener_t callback, gpointer udata);
+void sndtracker_add_on_packet_obsolated(SndTracker * this, sndpacket_listener_t callback, gpointer udata);
 void sndtracker_add_on_stat_changed(SndTracker * this, ListenerFunc callback, gpointer udata);
-void sndtracker_add_on_packet_sent_with_filter(SndTracker * this, ListenerFunc callback, ListenerFilterFunc filter, gpointer udata);
-void sndtracker_rem_on_packet_sent(SndTracker * this, ListenerFunc callback);
+void sndtracker_add_on_packet_sent_with_filter(SndTracker * this, sndpacket_listener_t callback, sndpacket_filter_t filter, gpointer udata);
+void sndtracker_rem_on_packet_sent(SndTracker * this, sndpacket_listener_t callback);
 
 RTPQueueStat* sndtracker_get_rtpqstat(SndTracker * this);
 SndTrackerStat* sndtracker_get_stat(SndTracker * this);
@@ -37,24 +37,6 @@ GST_DEBUG_CATEGORY_STATIC (stream_joiner_debug_category);
 
 G_DEFINE_TYPE (StreamJoiner, stream_joiner, G_TYPE_OBJECT);
 
-typedef struct{
-  guint32      timestamp;
-  guint32      created_in_ts;
-  GSList*      packets;
-}Frame;
-
-DEFINE_RECYCLE_TYPE(static, frame, Frame);
-
-static gint
-_cmp_ts (guint32 x, guint32 y)
-{
-  if(x == y) return 0;
-  if(x < y && y - x < 2147483648) return -1;
-  if(x > y && x - y > 2147483648) return -1;
-  if(x < y && y - x > 2147483648) return 1;
-  if(x > y && x - y < 2147483648) return 1;
-  return 0;
-}
 
 static gint
 _cmp_seq (guint16 x, guint16 y)
@@ -75,23 +57,6 @@ static guint32 _delta_ts(guint32 last_ts, guint32 actual_ts) {
   }
 }
 
-static gint _packets_cmp(RcvPacket* first, RcvPacket* second)
-{
-  //It should return 0 if the elements are equal,
-  //a negative value if the first element comes
-  //before the second, and a positive value
-  //if the second element comes before the first.
-
-  return _cmp_seq(first->abs_seq, second->abs_seq);
-}
-
-static gint _frames_data_cmp(Frame* first, Frame* second, gpointer udata)
-{
-  if (first->packets != NULL && second->packets != NULL) {
-    return _packets_cmp(first->packets->data, second->packets->data);
-  }
-  return _cmp_ts(first->timestamp, second->timestamp);
-}
 
 //----------------------------------------------------------------------
 //-------- Private functions belongs to StreamJoiner object ----------
@@ -101,8 +66,6 @@ static void
 stream_joiner_finalize (
     GObject * object);
 
-static Frame* _make_frame(StreamJoiner* this, RcvPacket* packet);
-static void _dispose_frame(StreamJoiner* this, Frame* frame);
 static void _update_joining_delay(StreamJoiner* this);
 
 //----------------------------------------------------------------------
@@ -131,6 +94,7 @@ stream_joiner_finalize (GObject * object)
     rcvpacket_unref(packet);
   }
   g_queue_free(this->playoutq);
+  g_object_unref(this->frames);
   g_object_unref(this->sysclock);
 
 }
@@ -147,8 +111,7 @@ make_stream_joiner(TimestampGenerator* rtp_ts_generator)
 {
   StreamJoiner *result;
   result = (StreamJoiner *) g_object_new (STREAMJOINER_TYPE, NULL);
-  result->frames = NULL;
-  result->frames_recycle = make_recycle_frame(50, NULL);
+  result->frames = make_rcvframes();
   result->rtp_ts_generator = g_object_ref(rtp_ts_generator);
 //  result->playout_history = make_slidingwindow_double(200, 2 * GST_SECOND);
   result->playoutq   = g_queue_new();
@@ -244,8 +207,6 @@ static void _update_subflow_sampling(StreamJoiner *this, RcvPacket* packet) {
 
 void stream_joiner_push_packet(StreamJoiner *this, RcvPacket* packet)
 {
-  Frame* frame = NULL;
-  GList* it;
   if (!packet) {
     return;
   }
@@ -280,22 +241,8 @@ void stream_joiner_push_packet(StreamJoiner *this, RcvPacket* packet)
 
   }
 
-  // because it seems g_list_find_custom does not work?????
-  for (it = this->frames; it; it = it->next) {
-    Frame* actual = it->data;
-    if (actual->timestamp == packet->snd_rtp_ts) {
-      frame = actual;
-      break;
-    }
-  }
-
   packet = rcvpacket_ref(packet);
-  if(!frame) {
-    frame = _make_frame(this, packet);
-    this->frames = g_list_insert_sorted_with_data(this->frames, frame, (GCompareDataFunc) _frames_data_cmp, NULL);
-  } else {
-    frame->packets = g_slist_insert_sorted(frame->packets, packet, (GCompareFunc) _packets_cmp);
-  }
+  rcvframes_add_packet(this->frames, packet);
 
   if (_cmp_seq(this->HSN, packet->abs_seq) < 0) {
     this->HSN = packet->abs_seq;
@@ -346,19 +293,19 @@ static void _update_subflow_waiting_time(StreamJoinerSubflow* subflow, guint16 a
 RcvPacket* stream_joiner_pop_packet(StreamJoiner *this)
 {
   RcvPacket* packet = NULL;
-  Frame* frame;
+  RcvFrame* frame;
   GstClockTime now = _now(this);
-  GSList* it;
+  gint32 i;
   GstClockTime dSending = 0;
 
   if(!g_queue_is_empty(this->playoutq)){
     goto playout_from_queue;
   }
 
-  if (this->frames == NULL) { // We have no frame to playout
+  frame = rcvframes_peek_first(this->frames);
+  if (frame == NULL) { // We have no frame to playout
     return NULL;
   }
-  frame = g_list_first(this->frames)->data;
 
   // We have frame to playout
   if (this->first_frame_played == FALSE) { // is this the first frame to playout?
@@ -387,14 +334,14 @@ RcvPacket* stream_joiner_pop_packet(StreamJoiner *this)
             GST_TIME_AS_MSECONDS(this->joining_delay),
             GST_TIME_AS_MSECONDS(timestamp_generator_get_time(this->rtp_ts_generator, _delta_ts(frame->created_in_ts, timestamp_generator_get_ts(this->rtp_ts_generator)))),
             GST_TIME_AS_MSECONDS(this->last_played_out_time + dSending + this->joining_delay - now),
-            g_list_length(this->frames));
+            rcvframes_length(this->frames));
 
     // Check if played out time needs to be reset or not.
     this->last_played_out_time += dSending + this->joining_delay;
   }
 
-  for (it = frame->packets; it; it = it->next) {
-    packet = it->data;
+  for (i = 0; i < frame->packets_num; ++i) {
+    packet = frame->packets[i];
     g_queue_push_tail(this->playoutq, packet);
     {
       GstClockTime waiting_time = timestamp_generator_get_time(this->rtp_ts_generator, _delta_ts(packet->rcv_rtp_ts, timestamp_generator_get_ts(this->rtp_ts_generator)));
@@ -410,10 +357,8 @@ RcvPacket* stream_joiner_pop_packet(StreamJoiner *this)
   this->last_played_out_ts = timestamp_generator_get_ts(this->rtp_ts_generator);
 //  this->last_played_out_time = now;
 
-  g_slist_free(frame->packets);
-  frame->packets = NULL;
-  this->frames = g_list_remove(this->frames, frame);
-  _dispose_frame(this, frame);
+  rcvframes_pop_first(this->frames);
+  rcvframes_throw_frame(this->frames, frame);
   this->first_frame_played_out = TRUE;
 
 playout_from_queue:
@@ -475,23 +420,3 @@ void _update_joining_delay(StreamJoiner* this) {
   return;
 }
 
-
-Frame* _make_frame(StreamJoiner* this, RcvPacket* packet)
-{
-  Frame* result = recycle_retrieve(this->frames_recycle);
-  result->timestamp = packet->snd_rtp_ts;
-  result->created_in_ts = packet->rcv_rtp_ts;
-  result->packets = g_slist_prepend(NULL, packet);
-  return result;
-}
-
-void _dispose_frame(StreamJoiner* this, Frame* frame)
-{
-  if (frame->packets) {
-    g_slist_free(frame->packets);
-  }
-//  frame->packets = NULL;
-  memset(frame, 0, sizeof(Frame));
-  recycle_add(this->frames_recycle, frame);
-}
-
@@ -11,6 +11,7 @@
 #include <gst/gst.h>
 #include "lib_swplugins.h"
 #include "rcvtracker.h"
+#include "rcvframes.h"
 #include "mediator.h"
 
 typedef struct _StreamJoiner StreamJoiner;
@@ -64,8 +65,7 @@ struct _StreamJoiner
 //  gint32               clock_rate;
   GQueue*              playoutq;
   GQueue*              discardedq;
-  GList*               frames;
-  Recycle*             frames_recycle;
+  RcvFrames*           frames;
   TimestampGenerator*  rtp_ts_generator;
   StreamJoinerSubflow* subflows;
 
@@ -43,6 +43,11 @@ enum{
 
 #define _qstat(this) sndqueue_get_stat(this->sndqueue)
 #define _now(this) gst_clock_get_time (this->sysclock)
+//A subflow is keyed by its pass plus the bits waiting in its queue, as if they were sent already
+#define _key(this, index) (this->passes[this->heap[index]] + this->backlogs[this->heap[index]] / this->weights[this->heap[index]])
+
+//Subflows with lower or no target are weighted by this bitrate
+#define STREAM_SPLITTER_MIN_WEIGHT 10000.
 //----------------------------------------------------------------------
 //-------- Private functions belongs to Scheduler tree object ----------
 //----------------------------------------------------------------------
@@ -55,6 +60,11 @@ static SndSubflow*
 _select_next_subflow(
     StreamSplitter * this,
     SndPacket *packet);
+
+static void
+_refresh_target_off(
+    StreamSplitter * this);
+
 //----------------------------------------------------------------------
 //---- Private function implementations to Stream Dealer object --------
 //----------------------------------------------------------------------
@@ -89,7 +99,6 @@ stream_splitter_class_init (StreamSplitterClass * klass)
 
   GST_DEBUG_CATEGORY_INIT (stream_splitter_debug_category, "stream_splitter", 0,
       "Stream Splitter");
-
 }
 
 StreamSplitter* make_stream_splitter(SndSubflows* sndsubflows, SndTracker* tracker, SndQueue* sndqueue)
@@ -122,8 +131,121 @@ stream_splitter_finalize (GObject * object)
 void
 stream_splitter_init (StreamSplitter * this)
 {
+  gint32 i;
   this->sysclock = gst_system_clock_obtain ();
   this->made                   = _now(this);
+  for (i = 0; i < MPRTP_PLUGIN_MAX_SUBFLOW_NUM; ++i) {
+    this->heap_positions[i] = -1;
+  }
+}
+
+static void _heap_swap(StreamSplitter* this, gint32 a, gint32 b)
+{
+  guint8 subflow_id = this->heap[a];
+  this->heap[a] = this->heap[b];
+  this->heap[b] = subflow_id;
+  this->heap_positions[this->heap[a]] = a;
+  this->heap_positions[this->heap[b]] = b;
+}
+
+static void _heap_sift_up(StreamSplitter* this, gint32 index)
+{
+  gint32 parent;
+  for (; 0 < index; index = parent) {
+    parent = (index - 1) / 2;
+    if (_key(this, parent) <= _key(this, index)) {
+      break;
+    }
+    _heap_swap(this, parent, index);
+  }
+}
+
+static void _heap_sift_down(StreamSplitter* this, gint32 index)
+{
+  gint32 child;
+  for (; (child = 2 * index + 1) < this->heap_length; index = child) {
+    if (child + 1 < this->heap_length && _key(this, child + 1) < _key(this, child)) {
+      ++child;
+    }
+    if (_key(this, index) <= _key(this, child)) {
+      break;
+    }
+    _heap_swap(this, index, child);
+  }
+}
+
+static void _heap_insert(StreamSplitter* this, guint8 subflow_id)
+{
+  if (0 <= this->heap_positions[subflow_id]) {
+    return;
+  }
+  //A (re)joining subflow starts from the actual virtual time,
+  //so it does not take over the stream to catch up.
+  this->passes[subflow_id] = this->vtime;
+  this->heap[this->heap_length] = subflow_id;
+  this->heap_positions[subflow_id] = this->heap_length;
+  _heap_sift_up(this, this->heap_length++);
+}
+
+static void _heap_remove(StreamSplitter* this, guint8 subflow_id)
+{
+  gint32 index = this->heap_positions[subflow_id];
+  if (index < 0) {
+    return;
+  }
+  this->heap_positions[subflow_id] = -1;
+  if (index == --this->heap_length) {
+    return;
+  }
+  this->heap[index] = this->heap[this->heap_length];
+  this->heap_positions[this->heap[index]] = index;
+  _heap_sift_down(this, index);
+  _heap_sift_up(this, index);
+}
+
+//Restores the place of the subflow after its key changed
+static void _heap_fix(StreamSplitter* this, guint8 subflow_id)
+{
+  gint32 index = this->heap_positions[subflow_id];
+  if (index < 0) {
+    return;
+  }
+  _heap_sift_down(this, index);
+  _heap_sift_up(this, index);
+}
+
+//Restores the heap after the key of every subflow may have changed
+static void _heap_rebuild(StreamSplitter* this)
+{
+  gint32 index;
+  for (index = this->heap_length / 2 - 1; 0 <= index; --index) {
+    _heap_sift_down(this, index);
+  }
+}
+
+static void _refresh_backlog(StreamSplitter* this, guint8 subflow_id)
+{
+  this->backlogs[subflow_id] = _qstat(this)->queued_bytes[subflow_id]<<3;
+  _heap_fix(this, subflow_id);
+}
+
+static void _refresh_weight(StreamSplitter* this, guint8 subflow_id)
+{
+  gdouble weight;
+  if (0 < this->stable_targets[subflow_id]) {
+    weight = this->stable_targets[subflow_id] * (1.-this->target_off) + this->allocated_targets[subflow_id] * (this->target_off);
+  } else {
+    weight = this->allocated_targets[subflow_id];
+  }
+  this->weights[subflow_id] = MAX(STREAM_SPLITTER_MIN_WEIGHT, weight);
+}
+
+static void _refresh_weights(StreamSplitter* this)
+{
+  gint32 i;
+  for (i = 0; i < this->heap_length; ++i) {
+    _refresh_weight(this, this->heap[i]);
+  }
 }
 
 
@@ -230,6 +352,10 @@ static void _subflow_report_handler(StreamSplitter* this, SndSubflow* source)
   }
 
 done:
+  //targets and rates are changed only here, so the weights are refreshed here as well
+  _refresh_target_off(this);
+  _refresh_weights(this);
+  _heap_rebuild(this);
   source->base_db->target_off = this->target_off;
   source->base_db->total_desired_target = this->media_rate;
   source->base_db->total_stable_target = this->stable_rate;
@@ -240,9 +366,11 @@ done:
 
 
 void
-stream_splitter_on_packet_queued(StreamSplitter* this, SndPacket* packet)
+stream_splitter_on_packet_queued(gpointer udata, SndPacket* packet)
 {
-
+  StreamSplitter* this = udata;
+  //a paced or backed up subflow is charged by its queue until it drains
+  _refresh_backlog(this, packet->subflow_id);
 }
 
 void
@@ -250,38 +378,62 @@ stream_splitter_on_subflow_joined(StreamSplitter* this, SndSubflow* subflow)
 {
   g_object_ref(subflow->control_channel);
   mediator_set_request_handler(subflow->control_channel, (ListenerFunc) _subflow_report_handler, this);
+  this->allocated_targets[subflow->id] = subflow->allocated_target;
+  _refresh_weight(this, subflow->id);
+  if (subflow->active) {
+    _heap_insert(this, subflow->id);
+  }
 }
 
 void
 stream_splitter_on_subflow_detached(StreamSplitter* this, SndSubflow* subflow)
 {
+  _heap_remove(this, subflow->id);
+  this->stable_targets[subflow->id] = 0;
+  this->allocated_targets[subflow->id] = 0;
   g_object_unref(subflow->control_channel);
 }
 
 void
-stream_splitter_on_packet_sent(StreamSplitter* this, SndPacket* packet)
+stream_splitter_on_subflow_path_active_changed(StreamSplitter* this, SndSubflow* subflow)
 {
-
+  if (subflow->active) {
+    _refresh_weight(this, subflow->id);
+    _heap_insert(this, subflow->id);
+  } else {
+    _heap_remove(this, subflow->id);
+  }
 }
 
 void
-stream_splitter_on_packet_obsolated(StreamSplitter* this, SndPacket* packet)
+stream_splitter_on_packet_sent(gpointer udata, SndPacket* packet)
 {
+  StreamSplitter* this = udata;
+  //the sent packet is credited back. The backlog is read from the queue statistics,
+  //so packets the queue dropped meanwhile are credited as well.
+  _refresh_backlog(this, packet->subflow_id);
+}
 
+void
+stream_splitter_on_packet_obsolated(gpointer udata, SndPacket* packet)
+{
+  //obsolated packets were credited back when they were sent, they do not change the backlog
 }
 
 void
 stream_splitter_on_subflow_stable_target_bitrate_chaned(StreamSplitter* this, SndSubflow* subflow)
 {
-  // TODO: change this, because it will be elliminated
-//  this->total_stable_target -= this->stable_targets[subflow->id];
-//  this->stable_targets[subflow->id] = subflow->approved_target;
-//  this->total_stable_target += this->stable_targets[subflow->id];
+  this->stable_targets[subflow->id] = subflow->stable_bitrate;
+  _refresh_weights(this);
+  _heap_rebuild(this);
 }
 
 void
 stream_splitter_on_subflow_desired_target_chaned(StreamSplitter* this, SndSubflow* subflow)
 {
+  this->allocated_targets[subflow->id] = subflow->allocated_target;
+  _refresh_weight(this, subflow->id);
+  _heap_fix(this, subflow->id);
   // TODO: change this, because it will be elliminated
 //  this->total_target -= this->desired_targets[subflow->id];
 //  this->desired_targets[subflow->id] = subflow->approved_target;
@@ -343,8 +495,6 @@ SndSubflow* stream_splitter_select_subflow(StreamSplitter * this, SndPacket *pac
 //    // Calculate the avarage packet per frame
 //  }
 
-  _refresh_target_off(this);
-
   switch(this->mode) {
     case FRAME_SCHEDULING:
       if (new_frame) {
@@ -360,40 +510,34 @@ SndSubflow* stream_splitter_select_subflow(StreamSplitter * this, SndPacket *pac
 }
 
 SndSubflow* _select_next_subflow(StreamSplitter * this, SndPacket *packet) {
-    SndSubflow *selected = NULL, *subflow;
-    GSList* it;
-    volatile gint32 drate;
-    volatile gint32 selected_drate = 0;
+    SndSubflow *subflow;
+    gint32 index = 0, i;
     DISABLE_LINE _print_ratios(this);
 
-    for (it = sndsubflows_get_subflows(this->subflows); it; it = it->next) {
-      subflow = it->data;
-      drate = _qstat(this)->actual_bitrates[subflow->id] + _qstat(this)->queued_bytes[subflow->id] * 8;
-      if (0 < this->stable_targets[subflow->id]) {
-        drate -= this->stable_targets[subflow->id] * (1.-this->target_off) + this->allocated_targets[subflow->id] * (this->target_off);
-      } else {
-        drate -= this->allocated_targets[subflow->id];
-      }
-
-      if(!subflow->active){
-        continue;
-      }
+    if (!this->heap_length) {
+      return NULL;
+    }
 
-      if(this->keyframe_filtering){
-        if(packet->keyframe && subflow->state < this->max_state){
+    //keyframes are rare, the subflows are scanned for them only
+    if (this->keyframe_filtering && packet->keyframe) {
+      index = -1;
+      for (i = 0; i < this->heap_length; ++i) {
+        subflow = sndsubflows_get_subflow(this->subflows, this->heap[i]);
+        if (subflow->state < this->max_state) {
           continue;
         }
+        if (index < 0 || _key(this, i) < _key(this, index)) {
+          index = i;
+        }
       }
-
-      if (!selected || drate < selected_drate) {
-        selected = subflow;
-        selected_drate = drate;
+      if (index < 0) {
+        return NULL;
       }
     }
-    return selected;
-}
-
-
-
-
 
+    subflow = sndsubflows_get_subflow(this->subflows, this->heap[index]);
+    this->vtime = MAX(this->vtime, this->passes[subflow->id]);
+    this->passes[subflow->id] += (gdouble)(packet->payload_size<<3) / this->weights[subflow->id];
+    _heap_sift_down(this, index);
+    return subflow;
+}
@@ -59,6 +59,20 @@ struct _StreamSplitter
 
   SndTracker*          tracker;
 
+  //Weighted fair selection: every subflow has a virtual time it is
+  //passed by, advanced by the bits of the packets selected for it
+  //divided by its weight. The active subflows are kept in a min heap
+  //by their pass plus the bits waiting in their queue over the weight,
+  //so the next subflow is always on the top and a backed up one
+  //is passed over until its queue drains.
+  gdouble              weights[MPRTP_PLUGIN_MAX_SUBFLOW_NUM];
+  gdouble              passes[MPRTP_PLUGIN_MAX_SUBFLOW_NUM];
+  gdouble              backlogs[MPRTP_PLUGIN_MAX_SUBFLOW_NUM];        ///< bits in the queue of the subflow at the last queue or send event
+  gint32               heap_positions[MPRTP_PLUGIN_MAX_SUBFLOW_NUM];  ///< -1 if the subflow is not in the heap
+  guint8               heap[MPRTP_PLUGIN_MAX_SUBFLOW_NUM];
+  gint32               heap_length;
+  gdouble              vtime;
+
 };
 
 struct _StreamSplitterClass{
@@ -80,7 +94,7 @@ stream_splitter_get_total_media_rate(
 
 void
 stream_splitter_on_packet_queued(
-    StreamSplitter* this,
+    gpointer udata,
     SndPacket* packet);
 
 void
@@ -95,13 +109,13 @@ stream_splitter_on_subflow_detached(
 
 void
 stream_splitter_on_packet_sent(
-    StreamSplitter* this,
+    gpointer udata,
     SndPacket* packet);
 
 
 void
 stream_splitter_on_packet_obsolated(
-    StreamSplitter* this,
+    gpointer udata,
     SndPacket* packet);
 
 void
@@ -115,6 +129,11 @@ stream_splitter_on_subflow_desired_target_chaned(
     SndSubflow* subflow);
 
 
+void
+stream_splitter_on_subflow_path_active_changed(
+    StreamSplitter* this,
+    SndSubflow* subflow);
+
 void
 stream_splitter_on_subflow_state_changed(
     StreamSplitter* this,
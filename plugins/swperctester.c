@@ -2,6 +2,15 @@
 #include <math.h>
 #include "slidingwindow.h"
 #include "lib_swplugins.h"
+#include "lib_typedsw.h"
+#include "lib_latencyhist.h"
+#include "messenger.h"
+#include "streamsplitter.h"
+#include "fecdec.h"
+#include "gstmprtpplayouter.h"
+#include "lib_clocktick.h"
+#include "fractalfbproc.h"
+#include <gst/rtp/gstrtpbuffer.h>
 #include <stdlib.h>
 
 static void _on_percentile_1_calced(gint32 *result, swpercentilecandidates_t *candidates)
@@ -41,7 +50,37 @@ static gint32 bintree3cmp_pointer_int32(gint32** a, gint32** b)
 }
 
 
+typedef enum{
+  SWPERCTESTER_INPUT_RANDOM       = 0,
+  SWPERCTESTER_INPUT_INCREASING   = 1,
+  SWPERCTESTER_INPUT_DECREASING   = 2,
+  SWPERCTESTER_INPUT_ZIGZAG       = 3,
+  SWPERCTESTER_INPUT_DUPLICATES   = 4,
+}SWPercTesterInput;
+
+static const gchar* _input_names[] = {"random", "increasing", "decreasing", "zigzag", "duplicates"};
+
+//Sorted inputs degenerate unbalanced trees into lists, zigzag alternates
+//between the two ends of the window and duplicates pile up equal values
+static gint32 _generate_value(SWPercTesterInput input, gint32 i, gint32 max_random_number)
+{
+  switch(input){
+    case SWPERCTESTER_INPUT_INCREASING:
+      return i;
+    case SWPERCTESTER_INPUT_DECREASING:
+      return G_MAXINT32 - i;
+    case SWPERCTESTER_INPUT_ZIGZAG:
+      return i % 2 == 0 ? i : G_MAXINT32 - i;
+    case SWPERCTESTER_INPUT_DUPLICATES:
+      return (i / 64) % 4;
+    case SWPERCTESTER_INPUT_RANDOM:
+    default:
+      return rand() % max_random_number;
+  }
+}
+
 static void _sw_test_performance(gint32 percentile, gint32 runs, gint32 max_random_number, gint sw_size,
+    SWPercTesterInput input, gint32* values,
     GstClockTime *performance1, GstClockTime *performance2, GstClockTime* performance3) {
   gint32 perc1_result, perc2_result, perc3_result, i;
   SlidingWindow* sw1 = make_slidingwindow(sw_size, GST_SECOND);
@@ -76,8 +115,8 @@ static void _sw_test_performance(gint32 percentile, gint32 runs, gint32 max_rand
   *performance2 = 0;
   *performance3 = 0;
   for (i = 0; i < runs; ++i) {
-    gint32* value = g_malloc(sizeof(gint32));
-    *value = rand() % max_random_number;
+    gint32* value = values + i;
+    *value = _generate_value(input, i, max_random_number);
     {
       GstClockTime start;
       start = gst_clock_get_time(clock);
@@ -97,6 +136,10 @@ static void _sw_test_performance(gint32 percentile, gint32 runs, gint32 max_rand
       *performance3 += gst_clock_get_time(clock) - start;
     }
   }
+  g_object_unref(sw1);
+  g_object_unref(sw2);
+  g_object_unref(sw3);
+  g_object_unref(clock);
 }
 
 static void _sw_test_results(gint32 percentile, gint32 runs, gint32 max_random_number, gint sw_size) {
@@ -140,17 +183,534 @@ static void _sw_test_results(gint32 percentile, gint32 runs, gint32 max_random_n
 
 void swperctester_do(void) {
   GstClockTime performance1 = 0, performance2 = 0, performance3 = 0;
-  gint32 percentile = 50;
-  gint32 runs = 10;
-  gint32 max_random_number = 10;
-  gint32 sw_size = 10;
+  gint32 percentiles[] = {50, 90};
+  gint32 sw_sizes[] = {10, 100, 1000, 10000};
+  gint32 runs = 100000;
+  gint32 max_random_number = 1000000;
+  gint32* values = g_malloc(sizeof(gint32) * runs);
+  guint input, i, j;
   srand(time(NULL));   // should only be called once
-  _sw_test_performance(percentile, runs, max_random_number, sw_size, &performance1, &performance2, &performance3);
 
-  DISABLE_LINE _sw_test_results(percentile, runs, max_random_number, sw_size);
+  DISABLE_LINE _sw_test_results(50, 10, 10, 10);
+
+  //ns per added item, the window is full after its first sw_size items,
+  //so every further add also removes the oldest item
+  g_print("input | percentile | window | swpercentile | swpercentile2 | swlinpercentile\n");
+  for(input = 0; input < G_N_ELEMENTS(_input_names); ++input){
+    for(i = 0; i < G_N_ELEMENTS(percentiles); ++i){
+      for(j = 0; j < G_N_ELEMENTS(sw_sizes); ++j){
+        _sw_test_performance(percentiles[i], runs, max_random_number, sw_sizes[j],
+            (SWPercTesterInput) input, values,
+            &performance1, &performance2, &performance3);
+        g_print("%s | %d | %d | %lu | %lu | %lu\n",
+            _input_names[input], percentiles[i], sw_sizes[j],
+            performance1 / runs, performance2 / runs, performance3 / runs);
+      }
+    }
+  }
+  g_free(values);
+}
+
+//------------------------------------------------------------
+
+#define MESSENGER_BENCH_MESSAGES_NUM 100000
+
+typedef struct{
+  Messenger*  ping;
+  Messenger*  pong;
+}MessengerBenchPeer;
+
+static gpointer _bench_messenger_echo(MessengerBenchPeer* peer)
+{
+  guint64* message;
+  for(;;){
+    message = messenger_pop_block(peer->ping);
+    if(*message == 0){
+      messenger_throw_block(peer->ping, message);
+      break;
+    }
+    messenger_push_block(peer->pong, message);
+  }
+  return NULL;
+}
+
+//Sends timestamped messages to an other thread, which sends them back,
+//and prints the distribution of the one way latency.
+void swperctester_bench_messenger_latency(void)
+{
+  MessengerBenchPeer peer;
+  latencyhist_t* hist = latencyhist_ctor("messenger");
+  GThread* thread;
+  guint64* message;
+  gint32 i;
+
+  peer.ping = make_messenger(sizeof(guint64));
+  peer.pong = make_messenger(sizeof(guint64));
+  thread = g_thread_new("messenger-echo", (GThreadFunc) _bench_messenger_echo, &peer);
+  for(i = 0; i < MESSENGER_BENCH_MESSAGES_NUM; ++i){
+    message = messenger_retrieve_block(peer.ping);
+    *message = latencyhist_now();
+    messenger_push_block(peer.ping, message);
+    message = messenger_pop_block(peer.pong);
+    latencyhist_record(hist, (latencyhist_now() - *message) / 2);
+    messenger_throw_block(peer.ping, message);
+  }
+  message = messenger_retrieve_block(peer.ping);
+  *message = 0;
+  messenger_push_block(peer.ping, message);
+  g_thread_join(thread);
+
+  g_print("messenger one way latency in ns | p50: %lu | p90: %lu | p99: %lu | max: %lu\n",
+      latencyhist_get_percentile(hist, 50.),
+      latencyhist_get_percentile(hist, 90.),
+      latencyhist_get_percentile(hist, 99.),
+      latencyhist_get_max(hist));
+
+  latencyhist_dtor(hist);
+  g_object_unref(peer.ping);
+  g_object_unref(peer.pong);
+}
+
+//Selects subflows for the same packet with 2, 8 and 32 active subflows
+//and prints the time a selection takes.
+void swperctester_bench_select_subflow(void)
+{
+  const gint32 packets_num = 1000000;
+  const guint subflows_nums[] = {2, 8, 32};
+  Mediator* monitoring;
+  SndSubflows* subflows;
+  SndPackets* sndpackets;
+  SndQueue* sndqueue;
+  SndTracker* sndtracker;
+  StreamSplitter* splitter;
+  SndPacket* packet;
+  GstClockTime start;
+  guint32 selected[MPRTP_PLUGIN_MAX_SUBFLOW_NUM];
+  guint i, j;
+  gint32 k;
+
+  for (i = 0; i < G_N_ELEMENTS(subflows_nums); ++i) {
+    monitoring = make_mediator();
+    subflows = make_sndsubflows(monitoring);
+    sndpackets = make_sndpackets();
+    sndqueue = make_sndqueue(subflows);
+    sndtracker = make_sndtracker(subflows, sndqueue);
+    splitter = make_stream_splitter(subflows, sndtracker, sndqueue);
+    sndsubflows_add_on_subflow_joined_cb(subflows, (ListenerFunc) stream_splitter_on_subflow_joined, splitter);
+    sndsubflows_add_on_subflow_detached_cb(subflows, (ListenerFunc) stream_splitter_on_subflow_detached, splitter);
+    sndsubflows_add_on_desired_bitrate_changed_cb(subflows,
+        (ListenerFunc) stream_splitter_on_subflow_desired_target_chaned, splitter);
+    for (j = 0; j < subflows_nums[i]; ++j) {
+      sndsubflows_join(subflows, j);
+      //targets are growing with the subflow id, so the selection ratios can be checked
+      sndsubflow_set_desired_bitrate(sndsubflows_get_subflow(subflows, j), (j + 1) * 100000);
+      selected[j] = 0;
+    }
+
+    packet = sndpackets_make_packet(sndpackets, gst_rtp_buffer_new_allocate(1200, 0, 0));
+    start = gst_util_get_timestamp();
+    for (k = 0; k < packets_num; ++k) {
+      ++selected[stream_splitter_select_subflow(splitter, packet)->id];
+    }
+    g_print("subflow selection with %u subflows: %.1f ns/packet, selected on the first: %u, on the last: %u\n",
+        subflows_nums[i], (gdouble)(gst_util_get_timestamp() - start) / packets_num,
+        selected[0], selected[subflows_nums[i] - 1]);
+
+    for (j = 0; j < subflows_nums[i]; ++j) {
+      sndsubflows_detach(subflows, j);
+    }
+    gst_buffer_unref(sndpacket_retrieve(packet));
+    g_object_unref(splitter);
+    g_object_unref(sndtracker);
+    g_object_unref(sndqueue);
+    g_object_unref(sndpackets);
+    g_object_unref(subflows);
+    g_object_unref(monitoring);
+  }
+}
+
+//Feeds the decoder with 5000 packets per second for 10 seconds, every tenth
+//packet is protected by a fec packet and every hundredth is repaired.
+void swperctester_bench_fecdecoder(void) {
+  FECDecoder* decoder = make_fecdecoder();
+  RcvPackets* rcvpackets = make_rcvpackets();
+  GstClockTime start, push_elapsed = 0, repair_elapsed = 0;
+  gint32 i, repaired = 0, packets_num = 50000;
+  guint16 seq;
+
+  for(i = 0; i < packets_num; ++i){
+    GstBuffer* buffer = gst_rtp_buffer_new_allocate(1200, 0, 0);
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    RcvPacket* packet;
+    seq = i;
+    gst_rtp_buffer_map(buffer, GST_MAP_READWRITE, &rtp);
+    gst_rtp_buffer_set_seq(&rtp, seq);
+    gst_rtp_buffer_unmap(&rtp);
+
+    packet = rcvpackets_get_packet(rcvpackets, buffer);
+    packet->received = i * 200 * GST_USECOND;
+    if(i % 100 != 99){
+      start = gst_util_get_timestamp();
+      fecdecoder_push_rcv_packet(decoder, packet);
+      push_elapsed += gst_util_get_timestamp() - start;
+    }
+    rcvpacket_unref(packet);
+
+    if(i % 10 == 9){
+      GstBuffer* fecbuffer = gst_rtp_buffer_new_allocate(1200 + 10, 0, 0);
+      GstRTPFECHeader* fec_header;
+      gst_rtp_buffer_map(fecbuffer, GST_MAP_READWRITE, &rtp);
+      fec_header = (GstRTPFECHeader*) gst_rtp_buffer_get_payload(&rtp);
+      fec_header->sn_base = g_htons((guint16)(seq - 9));
+      fec_header->N_MASK  = 10;
+      gst_rtp_buffer_unmap(&rtp);
+      fecdecoder_push_fec_buffer(decoder, fecbuffer);
+    }
+
+    if(i % 100 == 99){
+      GstBuffer* repaired_buffer;
+      start = gst_util_get_timestamp();
+      repaired_buffer = fecdecoder_pop_rtp_packet(decoder, seq);
+      repair_elapsed += gst_util_get_timestamp() - start;
+      if(repaired_buffer){
+        ++repaired;
+        gst_buffer_unref(repaired_buffer);
+      }
+    }
+  }
+  g_print("fecdecoder at 5000 packets/s | push: %lu ns/packet | repair: %lu ns/repair | repaired: %d/%d\n",
+      push_elapsed / (packets_num - packets_num / 100),
+      repair_elapsed / (packets_num / 100),
+      repaired, packets_num / 100);
+
+  g_object_unref(decoder);
+  g_object_unref(rcvpackets);
+}
+
+//Ingests the same packets one by one and in batches of
+//PLAYOUTER_INGESTION_BATCH_SIZE and prints the achieved packets/sec.
+void swperctester_bench_ingestion(void)
+{
+  const gint32 packets_num = 100000;
+  RcvPackets* rcvpackets = make_rcvpackets();
+  RcvTracker* rcvtracker = make_rcvtracker();
+  GAsyncQueue* queue = g_async_queue_new();
+  GMutex mutex;
+  RcvPacket* packets[PLAYOUTER_INGESTION_BATCH_SIZE];
+  GstClockTime start, elapsed[2];
+  gint32 round, i, j;
+  RcvPacket* packet;
+
+  g_mutex_init(&mutex);
+  rcvpackets_set_mprtp_ext_header_id(rcvpackets, MPRTP_DEFAULT_EXTENSION_HEADER_ID);
+  for (round = 0; round < 2; ++round) {
+    FECDecoder* fec_decoder = make_fecdecoder();
+    start = gst_util_get_timestamp();
+    for (i = 0; i < packets_num; i += PLAYOUTER_INGESTION_BATCH_SIZE) {
+      for (j = 0; j < PLAYOUTER_INGESTION_BATCH_SIZE; ++j) {
+        GstBuffer* buffer = gst_rtp_buffer_new_allocate(1200, 0, 0);
+        GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+        gst_rtp_buffer_map(buffer, GST_MAP_READWRITE, &rtp);
+        gst_rtp_buffer_set_seq(&rtp, (guint16)(i + j));
+        gst_rtp_buffer_set_mprtp_extension(&rtp, MPRTP_DEFAULT_EXTENSION_HEADER_ID, 1, (guint16)(i + j));
+        gst_rtp_buffer_unmap(&rtp);
+        packets[j] = rcvpackets_get_packet(rcvpackets, buffer);
+      }
+      if (round == 0) {
+        for (j = 0; j < PLAYOUTER_INGESTION_BATCH_SIZE; ++j) {
+          fecdecoder_push_rcv_packet(fec_decoder, packets[j]);
+          g_mutex_lock(&mutex);
+          rcvtracker_add_packet(rcvtracker, packets[j]);
+          g_mutex_unlock(&mutex);
+          g_async_queue_push(queue, packets[j]);
+        }
+      } else {
+        fecdecoder_push_rcv_packets(fec_decoder, packets, PLAYOUTER_INGESTION_BATCH_SIZE);
+        g_mutex_lock(&mutex);
+        for (j = 0; j < PLAYOUTER_INGESTION_BATCH_SIZE; ++j) {
+          rcvtracker_add_packet(rcvtracker, packets[j]);
+        }
+        g_mutex_unlock(&mutex);
+        g_async_queue_lock(queue);
+        for (j = 0; j < PLAYOUTER_INGESTION_BATCH_SIZE; ++j) {
+          g_async_queue_push_unlocked(queue, packets[j]);
+        }
+        g_async_queue_unlock(queue);
+      }
+      while ((packet = g_async_queue_try_pop(queue)) != NULL) {
+        rcvpacket_unref(packet);
+      }
+    }
+    elapsed[round] = gst_util_get_timestamp() - start;
+    g_object_unref(fec_decoder);
+  }
+  g_print("playouter ingestion | single: %.0f packets/s | batched: %.0f packets/s\n",
+      (gdouble) packets_num * GST_SECOND / elapsed[0],
+      (gdouble) packets_num * GST_SECOND / elapsed[1]);
+
+  g_mutex_clear(&mutex);
+  g_async_queue_unref(queue);
+  g_object_unref(rcvtracker);
+  g_object_unref(rcvpackets);
+}
+
+//Queues and sends the same packets on one subflow without and with a clock tick
+//around every packet and prints the clock reads and the time a packet takes.
+void swperctester_bench_clock_reads(void)
+{
+  const gint32 packets_num = 100000;
+  Mediator* monitoring = make_mediator();
+  SndSubflows* subflows = make_sndsubflows(monitoring);
+  SndPackets* sndpackets = make_sndpackets();
+  SndQueue* sndqueue = make_sndqueue(subflows);
+  SndTracker* sndtracker = make_sndtracker(subflows, sndqueue);
+  GstClock* sysclock = gst_system_clock_obtain();
+  SndSubflow* subflow;
+  SndPacket* packet;
+  GstClockTime start, next_time, elapsed[2];
+  guint64 reads[2];
+  gint32 round, i;
+
+  sndsubflows_add_on_subflow_joined_cb(subflows, (ListenerFunc) sndqueue_on_subflow_joined, sndqueue);
+  sndsubflows_join(subflows, 1);
+  subflow = sndsubflows_get_subflow(subflows, 1);
+  for (round = 0; round < 2; ++round) {
+    reads[round] = clocktick_get_reads();
+    start = gst_util_get_timestamp();
+    for (i = 0; i < packets_num; ++i) {
+      if (round == 1) {
+        clocktick_begin(sysclock);
+      }
+      packet = sndpackets_make_packet(sndpackets, gst_rtp_buffer_new_allocate(1200, 0, 0));
+      sndpacket_setup_mprtp(packet, subflow->id, sndsubflow_get_next_subflow_seq(subflow));
+      sndqueue_push_packet(sndqueue, packet);
+      sndtracker_refresh(sndtracker);
+      next_time = 0;
+      packet = sndqueue_pop_packet(sndqueue, &next_time);
+      if (packet) {
+        sndtracker_packet_sent(sndtracker, packet);
+        gst_buffer_unref(sndpacket_retrieve(packet));
+      }
+      if (round == 1) {
+        clocktick_end();
+      }
+    }
+    elapsed[round] = gst_util_get_timestamp() - start;
+    reads[round] = clocktick_get_reads() - reads[round];
+  }
+  g_print("clock reads per packet | untick: %.2f (%.0f ns/packet) | tick: %.2f (%.0f ns/packet)\n",
+      (gdouble) reads[0] / packets_num, (gdouble) elapsed[0] / packets_num,
+      (gdouble) reads[1] / packets_num, (gdouble) elapsed[1] / packets_num);
+
+  g_object_unref(sysclock);
+  g_object_unref(sndtracker);
+  g_object_unref(sndqueue);
+  g_object_unref(sndpackets);
+  g_object_unref(subflows);
+  g_object_unref(monitoring);
+}
+
+#define BITXOR_BENCH_MAX_PACKETS 16
+void swperctester_bench_bitxor_n(void) {
+  guint8 *packets[BITXOR_BENCH_MAX_PACKETS];
+  guint8 parity[1200];
+  gint32 packets_num, i, j, runs = 10000;
+  GstClockTime start, elapsed_pairwise, elapsed_n;
+
+  for(i = 0; i < BITXOR_BENCH_MAX_PACKETS; ++i){
+    packets[i] = g_malloc(1200);
+    for(j = 0; j < 1200; ++j){
+      packets[i][j] = g_random_int_range(0, 256);
+    }
+  }
+
+  for(packets_num = 2; packets_num <= BITXOR_BENCH_MAX_PACKETS; ++packets_num){
+    start = gst_util_get_timestamp();
+    for(i = 0; i < runs; ++i){
+      memset(parity, 0, 1200);
+      for(j = 0; j < packets_num; ++j){
+        do_bitxor(parity, packets[j], 1200);
+      }
+    }
+    elapsed_pairwise = gst_util_get_timestamp() - start;
+
+    start = gst_util_get_timestamp();
+    for(i = 0; i < runs; ++i){
+      do_bitxor_n(parity, packets, packets_num, 1200);
+    }
+    elapsed_n = gst_util_get_timestamp() - start;
+
+    g_print("bitxor %2d packets of 1200 bytes | do_bitxor: %5lu ns | do_bitxor_n: %5lu ns\n",
+        packets_num, elapsed_pairwise / runs, elapsed_n / runs);
+  }
+
+  for(i = 0; i < BITXOR_BENCH_MAX_PACKETS; ++i){
+    g_free(packets[i]);
+  }
+}
+
+swplugin_define_swselfdoubleextractor(_int32_extractor, gint32);
+
+static void _on_sum_calculated(gdouble* result, gdouble* sum)
+{
+  *result = *sum;
+}
+
+//Adds the same samples to a boxed int32 window and a typed one, both summed by a swsum plugin
+void swperctester_bench_typed_window(void)
+{
+  const gint32 samples_num = 1000000;
+  SlidingWindow* boxed;
+  typedsw_int32_t* typed;
+  GstClockTime start;
+  gdouble boxed_sum = 0., typed_sum = 0.;
+  gint32 i;
+
+  boxed = make_slidingwindow_int32(1000, 0);
+  slidingwindow_add_plugin(boxed, make_swsum((ListenerFunc) _on_sum_calculated, &boxed_sum, _int32_extractor));
+  start = gst_util_get_timestamp();
+  for (i = 0; i < samples_num; ++i) {
+    slidingwindow_add_int(boxed, i & 1023);
+  }
+  g_print("boxed int32 window: %.1f ns/sample, sum: %f\n",
+      (gdouble)(gst_util_get_timestamp() - start) / samples_num, boxed_sum);
+
+  typed = typedsw_int32_ctor(1000, 0);
+  typedsw_add_plugin(TYPEDSW(typed), make_swsum((ListenerFunc) _on_sum_calculated, &typed_sum, _int32_extractor));
+  start = gst_util_get_timestamp();
+  for (i = 0; i < samples_num; ++i) {
+    typedsw_int32_add(typed, i & 1023);
+  }
+  g_print("typed int32 window: %.1f ns/sample, sum: %f\n",
+      (gdouble)(gst_util_get_timestamp() - start) / samples_num, typed_sum);
+
+  g_object_unref(boxed);
+  typedsw_int32_dtor(typed);
+}
+
+//Sends packets on one subflow and acknowledges each of them 32 packets later,
+//as the feedback processor does, to measure the per packet cost of the tracker
+//together with making and recycling the packets.
+void swperctester_bench_tracker_loop(void)
+{
+  const gint32 packets_num = 1000000;
+  const guint16 acked_behind = 32;
+  Mediator* monitoring;
+  SndSubflows* subflows;
+  SndPackets* sndpackets;
+  SndQueue* sndqueue;
+  SndTracker* sndtracker;
+  SndPacket* packet;
+  SndPacket* acked;
+  GstBuffer* buffer;
+  GstClockTime start;
+  guint16 seq = 0;
+  gint32 i;
+
+  monitoring = make_mediator();
+  subflows = make_sndsubflows(monitoring);
+  sndpackets = make_sndpackets();
+  sndqueue = make_sndqueue(subflows);
+  sndtracker = make_sndtracker(subflows, sndqueue);
+  sndsubflows_join(subflows, 1);
+  buffer = gst_rtp_buffer_new_allocate(1200, 0, 0);
+
+  start = gst_util_get_timestamp();
+  for (i = 0; i < packets_num; ++i, ++seq) {
+    packet = sndpackets_make_packet(sndpackets, gst_buffer_ref(buffer));
+    sndpacket_setup_mprtp(packet, 1, seq);
+    sndtracker_packet_sent(sndtracker, packet);
+    gst_buffer_unref(sndpacket_retrieve(packet));
+
+    acked = sndtracker_retrieve_sent_packet(sndtracker, 1, seq - acked_behind);
+    if (acked && !acked->acknowledged) {
+      acked->acknowledged = TRUE;
+      sndtracker_packet_acked(sndtracker, acked);
+    }
+    if ((i & 127) == 0) {
+      sndtracker_refresh(sndtracker);
+    }
+  }
+  g_print("tracker loop: %.1f ns/packet\n", (gdouble)(gst_util_get_timestamp() - start) / packets_num);
+
+  sndsubflows_detach(subflows, 1);
+  gst_buffer_unref(buffer);
+  g_object_unref(sndtracker);
+  g_object_unref(sndqueue);
+  g_object_unref(sndpackets);
+  g_object_unref(subflows);
+  g_object_unref(monitoring);
+}
+
+//Sends packets on one subflow and processes a congestion control feedback
+//acknowledging every 32 packets, as the subflow controller does at every report,
+//to measure the per packet cost of the whole controller loop:
+//making, sending, tracking, acknowledging and recycling the packets.
+//report_update drops the reports arrived closer than 5ms to the previous,
+//so the time of the last one is cleared before each.
+void swperctester_bench_controller_loop(void)
+{
+  const gint32 packets_num = 1000000;
+  const gint32 report_length = 32;
+  Mediator* monitoring;
+  SndSubflows* subflows;
+  SndPackets* sndpackets;
+  SndQueue* sndqueue;
+  SndTracker* sndtracker;
+  FRACTaLStat* stat;
+  FRACTaLFBProcessor* this;
+  GstMPRTCPReportSummary summary;
+  SndPacket* packet;
+  GstBuffer* buffer;
+  GstClockTime start;
+  guint16 seq = 0;
+  gint32 i, j;
+
+  monitoring = make_mediator();
+  subflows = make_sndsubflows(monitoring);
+  sndpackets = make_sndpackets();
+  sndqueue = make_sndqueue(subflows);
+  sndtracker = make_sndtracker(subflows, sndqueue);
+  sndsubflows_join(subflows, 1);
+  stat = g_malloc0(sizeof(FRACTaLStat));
+  this = make_fractalfbprocessor(sndtracker, sndsubflows_get_subflow(subflows, 1), stat);
+  buffer = gst_rtp_buffer_new_allocate(1200, 0, 0);
+
+  memset(&summary, 0, sizeof(summary));
+  summary.XR.CongestionControlFeedback.processed = TRUE;
+  summary.XR.CongestionControlFeedback.vector_length = report_length;
+  //every packet of the report is received
+  for (j = 0; j < report_length; ++j) {
+    report_summary_bit_set(summary.XR.CongestionControlFeedback.lost, j);
+  }
+
+  start = gst_util_get_timestamp();
+  for (i = 0; i < packets_num; ++i, ++seq) {
+    packet = sndpackets_make_packet(sndpackets, gst_buffer_ref(buffer));
+    sndpacket_setup_mprtp(packet, 1, seq);
+    sndtracker_packet_sent(sndtracker, packet);
+    gst_buffer_unref(sndpacket_retrieve(packet));
+
+    if (((i + 1) % report_length) != 0) {
+      continue;
+    }
+    summary.XR.CongestionControlFeedback.begin_seq = (guint16)(seq + 1 - report_length);
+    summary.XR.CongestionControlFeedback.end_seq = (guint16)(seq + 1);
+    summary.XR.CongestionControlFeedback.report_timestamp = timestamp_generator_get_ts(this->ts_generator);
+    this->last_report_update = 0;
+    fractalfbprocessor_report_update(this, &summary);
+    sndtracker_refresh(sndtracker);
+  }
+  g_print("controller loop: %.1f ns/packet\n", (gdouble)(gst_util_get_timestamp() - start) / packets_num);
 
-  g_print("%lu | %lu | %lu\n",
-      GST_TIME_AS_USECONDS(performance1),
-      GST_TIME_AS_USECONDS(performance2),
-      GST_TIME_AS_USECONDS(performance3));
+  //the packets are given back to sndpackets before it is unrefed
+  sndsubflows_detach(subflows, 1);
+  gst_buffer_unref(buffer);
+  g_object_unref(this);
+  g_free(stat);
+  g_object_unref(sndtracker);
+  g_object_unref(sndqueue);
+  g_object_unref(sndpackets);
+  g_object_unref(subflows);
+  g_object_unref(monitoring);
 }
@@ -10,4 +10,17 @@
 #include <gst/gst.h>
 
 void swperctester_do(void);
+
+//Benches of the plugin building blocks, printing their results,
+//call them from gst_mprtpscheduler_init like swperctester_do
+void swperctester_bench_messenger_latency(void);
+void swperctester_bench_select_subflow(void);
+void swperctester_bench_fecdecoder(void);
+void swperctester_bench_ingestion(void);
+void swperctester_bench_clock_reads(void);
+void swperctester_bench_bitxor_n(void);
+void swperctester_bench_typed_window(void);
+void swperctester_bench_tracker_loop(void);
+void swperctester_bench_controller_loop(void);
+
 #endif /* INCGUARD_SWPERCTESTER_H_ */
@@ -0,0 +1,125 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+#include "../plugins/mprtputils.h"
+
+#define BITXOR_TEST_MAX_LENGTH 1300
+#define BITXOR_TEST_MAX_SOURCES 16
+#define BITXOR_TEST_MAX_OFFSET 8
+
+static void _fill_random(guint8* data, gint32 length)
+{
+  gint32 i;
+  for(i = 0; i < length; ++i){
+    data[i] = g_random_int_range(0, 256);
+  }
+}
+
+//XORs one byte at a time and compares with do_bitxor,
+//the bytes around the XORed range must stay untouched.
+static gboolean _check_do_bitxor(gint32 length, gint32 offset)
+{
+  guint8 to[BITXOR_TEST_MAX_LENGTH + BITXOR_TEST_MAX_OFFSET];
+  guint8 from[BITXOR_TEST_MAX_LENGTH + BITXOR_TEST_MAX_OFFSET];
+  guint8 expected[BITXOR_TEST_MAX_LENGTH + BITXOR_TEST_MAX_OFFSET];
+  gint32 i;
+
+  _fill_random(to, sizeof(to));
+  _fill_random(from, sizeof(from));
+  memcpy(expected, to, sizeof(to));
+  for(i = 0; i < length; ++i){
+    expected[offset + i] ^= from[offset + i];
+  }
+  do_bitxor(to + offset, from + offset, length);
+  if(memcmp(to, expected, sizeof(to)) != 0){
+    g_print("do_bitxor test: FAILED at length %d, offset %d\n", length, offset);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+//Every length up to 64 and around a packet size from unaligned addresses
+static gboolean _test_do_bitxor(void)
+{
+  gint32 length, offset;
+  gboolean result = TRUE;
+
+  for(offset = 0; offset < BITXOR_TEST_MAX_OFFSET; ++offset){
+    for(length = 0; length <= 64; ++length){
+      result &= _check_do_bitxor(length, offset);
+    }
+    for(length = 1199; length <= 1201; ++length){
+      result &= _check_do_bitxor(length, offset);
+    }
+  }
+  if(result){
+    g_print("do_bitxor test: OK\n");
+  }
+  return result;
+}
+
+//Compares do_bitxor_n with a byte by byte XOR for every source count,
+//lengths around the vector widths and unaligned sources,
+//then with the result aliasing its first source.
+static gboolean _test_do_bitxor_n(void)
+{
+  const gint32 lengths[] = {0, 1, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 95, 96, 127, 128, 129, 1200, 1201};
+  guint8 *sources[BITXOR_TEST_MAX_SOURCES], *from[BITXOR_TEST_MAX_SOURCES];
+  guint8 to[BITXOR_TEST_MAX_LENGTH + BITXOR_TEST_MAX_OFFSET];
+  guint8 expected[BITXOR_TEST_MAX_LENGTH];
+  gint32 from_num, i, j, offset;
+  guint l;
+  gboolean result = TRUE;
+
+  for(i = 0; i < BITXOR_TEST_MAX_SOURCES; ++i){
+    sources[i] = g_malloc(BITXOR_TEST_MAX_LENGTH + BITXOR_TEST_MAX_OFFSET);
+  }
+  for(from_num = 0; from_num <= BITXOR_TEST_MAX_SOURCES; ++from_num){
+    for(l = 0; l < G_N_ELEMENTS(lengths); ++l){
+      offset = (from_num + l) % BITXOR_TEST_MAX_OFFSET;
+      for(i = 0; i < from_num; ++i){
+        _fill_random(sources[i], BITXOR_TEST_MAX_LENGTH + BITXOR_TEST_MAX_OFFSET);
+        from[i] = sources[i] + (offset + i) % BITXOR_TEST_MAX_OFFSET;
+      }
+      memset(expected, 0, sizeof(expected));
+      for(i = 0; i < from_num; ++i){
+        for(j = 0; j < lengths[l]; ++j){
+          expected[j] ^= from[i][j];
+        }
+      }
+      _fill_random(to, sizeof(to));
+      do_bitxor_n(to + offset, from, from_num, lengths[l]);
+      if(memcmp(to + offset, expected, lengths[l]) != 0){
+        g_print("do_bitxor_n test: FAILED with %d sources of %d bytes\n", from_num, lengths[l]);
+        result = FALSE;
+      }
+      if(from_num < 1){
+        continue;
+      }
+      do_bitxor_n(from[0], from, from_num, lengths[l]);
+      if(memcmp(from[0], expected, lengths[l]) != 0){
+        g_print("do_bitxor_n test: FAILED in place with %d sources of %d bytes\n", from_num, lengths[l]);
+        result = FALSE;
+      }
+    }
+  }
+  for(i = 0; i < BITXOR_TEST_MAX_SOURCES; ++i){
+    g_free(sources[i]);
+  }
+  if(result){
+    g_print("do_bitxor_n test: OK\n");
+  }
+  return result;
+}
+
+int main (int argc, char **argv)
+{
+  gboolean passed = TRUE;
+  gst_init(&argc, &argv);
+
+  passed &= _test_do_bitxor();
+  passed &= _test_do_bitxor_n();
+
+  return passed ? 0 : 1;
+}
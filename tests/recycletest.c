@@ -0,0 +1,145 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+#include "../plugins/recycle.h"
+
+#define RECYCLE_TEST_THREADS_NUM 4
+#define RECYCLE_TEST_ITEMS_NUM 1000000
+#define RECYCLE_TEST_MAX_ITEMS_IN_FLIGHT 128
+
+typedef struct{
+  Recycle*      recycle;
+  GAsyncQueue*  queue;
+  guint64       first;
+  guint64       sum;
+}RecycleTestWorker;
+
+static guint64 _recycle_test_stop;
+
+static gpointer _recycle_test_producer(RecycleTestWorker* worker)
+{
+  guint64 i, *item;
+  for(i = 0; i < RECYCLE_TEST_ITEMS_NUM; ++i){
+    while(RECYCLE_TEST_MAX_ITEMS_IN_FLIGHT < g_async_queue_length(worker->queue)){
+      g_thread_yield();
+    }
+    item = recycle_retrieve(worker->recycle);
+    *item = worker->first + i;
+    g_async_queue_push(worker->queue, item);
+  }
+  return NULL;
+}
+
+static gpointer _recycle_test_consumer(RecycleTestWorker* worker)
+{
+  guint64* item;
+  while((item = g_async_queue_pop(worker->queue)) != &_recycle_test_stop){
+    worker->sum += *item;
+    recycle_add(worker->recycle, item);
+  }
+  return NULL;
+}
+
+//Producers retrieve numbered items and consumers sum and add them back on other threads.
+//An item handed out twice at once would be overwritten and break the sum.
+static gboolean _test_recycle_threads(void)
+{
+  Recycle* recycle = make_recycle_uint64(256, NULL);
+  GAsyncQueue* queue = g_async_queue_new();
+  RecycleTestWorker producers[RECYCLE_TEST_THREADS_NUM];
+  RecycleTestWorker consumers[RECYCLE_TEST_THREADS_NUM];
+  GThread* threads[2 * RECYCLE_TEST_THREADS_NUM];
+  guint64 n = (guint64) RECYCLE_TEST_THREADS_NUM * RECYCLE_TEST_ITEMS_NUM;
+  guint64 sum = 0, hits, misses;
+  GstClockTime start, elapsed;
+  gint32 i;
+
+  start = gst_util_get_timestamp();
+  for(i = 0; i < RECYCLE_TEST_THREADS_NUM; ++i){
+    producers[i].recycle = consumers[i].recycle = recycle;
+    producers[i].queue   = consumers[i].queue   = queue;
+    producers[i].first   = (guint64) i * RECYCLE_TEST_ITEMS_NUM + 1;
+    consumers[i].sum     = 0;
+    threads[i] = g_thread_new("recycle-producer", (GThreadFunc) _recycle_test_producer, producers + i);
+    threads[RECYCLE_TEST_THREADS_NUM + i] = g_thread_new("recycle-consumer", (GThreadFunc) _recycle_test_consumer, consumers + i);
+  }
+  for(i = 0; i < RECYCLE_TEST_THREADS_NUM; ++i){
+    g_thread_join(threads[i]);
+  }
+  for(i = 0; i < RECYCLE_TEST_THREADS_NUM; ++i){
+    g_async_queue_push(queue, &_recycle_test_stop);
+  }
+  for(i = 0; i < RECYCLE_TEST_THREADS_NUM; ++i){
+    g_thread_join(threads[RECYCLE_TEST_THREADS_NUM + i]);
+    sum += consumers[i].sum;
+  }
+  elapsed = gst_util_get_timestamp() - start;
+
+  hits = recycle_get_hits(recycle);
+  misses = recycle_get_misses(recycle);
+  g_print("recycle threads test: %s | retrieves: %lu/%lu | hits: %lu | misses: %lu | %.0f ns/item\n",
+      sum == n * (n + 1) / 2 ? "OK" : "FAILED",
+      hits + misses, n, hits, misses,
+      (gdouble) elapsed / n);
+
+  g_async_queue_unref(queue);
+  g_object_unref(recycle);
+  return sum == n * (n + 1) / 2;
+}
+
+typedef struct{
+  Recycle*      freed;
+  Recycle*      kept;
+  GAsyncQueue*  cached;
+  GAsyncQueue*  freed_done;
+}RecycleTestSweeper;
+
+static gpointer _recycle_test_sweeper(RecycleTestSweeper* sweeper)
+{
+  guint64* item;
+  //the thread caches magazines of the pool the main thread frees meanwhile
+  item = recycle_retrieve(sweeper->freed);
+  recycle_add(sweeper->freed, item);
+  g_async_queue_push(sweeper->cached, sweeper);
+  g_async_queue_pop(sweeper->freed_done);
+  //the next access of any pool gives back the magazines of the freed one
+  item = recycle_retrieve(sweeper->kept);
+  recycle_add(sweeper->kept, item);
+  return NULL;
+}
+
+//A pool freed while another thread still has magazines of it,
+//the thread must not touch it afterwards.
+static gboolean _test_recycle_freed_pool(void)
+{
+  RecycleTestSweeper sweeper;
+  GThread* thread;
+
+  sweeper.freed      = make_recycle_uint64(16, NULL);
+  sweeper.kept       = make_recycle_uint64(16, NULL);
+  sweeper.cached     = g_async_queue_new();
+  sweeper.freed_done = g_async_queue_new();
+  thread = g_thread_new("recycle-sweeper", (GThreadFunc) _recycle_test_sweeper, &sweeper);
+  g_async_queue_pop(sweeper.cached);
+  g_object_unref(sweeper.freed);
+  g_async_queue_push(sweeper.freed_done, &sweeper);
+  g_thread_join(thread);
+
+  g_object_unref(sweeper.kept);
+  g_async_queue_unref(sweeper.cached);
+  g_async_queue_unref(sweeper.freed_done);
+  g_print("recycle freed pool test: OK\n");
+  return TRUE;
+}
+
+int main (int argc, char **argv)
+{
+  gboolean passed = TRUE;
+  gst_init(&argc, &argv);
+
+  passed &= _test_recycle_threads();
+  passed &= _test_recycle_freed_pool();
+
+  return passed ? 0 : 1;
+}
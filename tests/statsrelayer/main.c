@@ -37,7 +37,7 @@ static void _print_help(void) {
   g_print("RELAYS RELAY|...\n");
   g_print("RELAY  SOURCE!MAPPER!SINK\n");
   g_print("MAPPER binary!packet2csv\n");
-  g_print("SOURCE file|mkfifo|unix_dgram_socket:PATH\n");
+  g_print("SOURCE file|mkfifo|unix_dgram_socket|shm:PATH\n");
   g_print("SINK   file|mkfifo|unix_dgram_socket:PATH\n");
   g_print("PATH   aA-zZ0-9/\n");
   g_print("SIZE   0-9...\n");
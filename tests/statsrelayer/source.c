@@ -17,13 +17,14 @@ static void _read_file(Source* this);
 static void _read_mkfifo(Source* this);
 static void _rcvfrom_unix_socket(Source* this);
 static void _read_stdin(Source* this);
+static void _read_shm(Source* this);
 
 static void _set_stop(Source* this);
 
 Source* make_source(const gchar* string, guint item_size) {
   Source *this = g_malloc0(sizeof(Source));
   gchar **tokens = g_strsplit(string, ":", -1);
-  this->type = common_assign_string_to_int(tokens[0], "file", "mkfifo", "unix_dgram_socket", "stdin", NULL);
+  this->type = common_assign_string_to_int(tokens[0], "file", "mkfifo", "unix_dgram_socket", "stdin", "shm", NULL);
   this->type_in_string = g_ascii_strup(tokens[0], strlen(tokens[0]));
   fprintf(stdout, "Create Source. Type: %s\n", tokens[0]);
 
@@ -48,6 +49,11 @@ Source* make_source(const gchar* string, guint item_size) {
       this->start_process = make_process((ProcessCb)_read_stdin, this);
       this->stop_process = make_process((ProcessCb)_set_stop, this);
       break;
+    case SOURCE_TYPE_SHM:
+      strcpy(this->path, tokens[1]);
+      this->start_process = make_process((ProcessCb)_read_shm, this);
+      this->stop_process = make_process((ProcessCb)_set_stop, this);
+      break;
     default:
       fprintf(stderr, "No Type for source\n");
   }
@@ -73,14 +79,15 @@ void source_dtor(Source* this) {
 }
 
 void source_sprintf(Source* this, gchar* string) {
-  sprintf(string, "Source type: %s, target: %s, number of sent items: %d, amount of bytes: %d\n",
-      this->type_in_string, this->path, this->sent_packets, this->sent_bytes);
+  sprintf(string, "Source type: %s, target: %s, number of sent items: %d, amount of bytes: %d, dropped items: %" G_GUINT64_FORMAT "\n",
+      this->type_in_string, this->path, this->sent_packets, this->sent_bytes, this->dropped_packets);
 }
 
 void source_reset_metrics(Source* this) {
   fprintf(stdout, "Reset source socket");
   this->sent_packets = 0;
   this->sent_bytes = 0;
+  this->dropped_packets = 0;
 }
 
 static void _refresh_metrics(Source* this, guint item_length) {
@@ -208,6 +215,44 @@ void _read_stdin(Source* this) {
  }
 }
 
+void _read_shm(Source* this) {
+  shmring_t* ring = NULL;
+  guint64 dropped = 0;
+  while(!this->stop) {
+    if (!ring) {
+      ring = shmring_open(this->path);
+      if (!ring) { // The writer has not created the ring yet
+        g_usleep(100000);
+        continue;
+      }
+      if (this->item_size < shmring_get_item_size(ring)) {
+        fprintf(stderr, "Items of the shm ring %s are larger (%d) than the source item size (%d)\n",
+            this->path, shmring_get_item_size(ring), this->item_size);
+        shmring_dtor(ring);
+        process_call(this->stop_process);
+        return;
+      }
+      dropped = shmring_get_dropped(ring);
+    }
+    memset(this->databed, 0, this->item_size);
+    if (!shmring_pop(ring, this->databed)) {
+      // The writer is gone, the next one creates a new ring under the same name
+      if (shmring_is_closed(ring) && shmring_readcapacity(ring) == 0) {
+        shmring_dtor(ring);
+        ring = NULL;
+        continue;
+      }
+      g_usleep(1000);
+      continue;
+    }
+    pushport_send(this->output, this->databed);
+    _refresh_metrics(this, shmring_get_item_size(ring));
+    this->dropped_packets += shmring_get_dropped(ring) - dropped;
+    dropped = shmring_get_dropped(ring);
+  }
+  shmring_dtor(ring);
+  g_print("shm read is closed\n");
+}
 
 void _set_stop(Source* this) {
   fprintf(stdout, "Stop Source %s\n", this->path);
@@ -9,12 +9,14 @@
 #define TESTS_STATSRELAYER_SOURCE_H_
 #include <gst/gst.h>
 #include "common.h"
+#include "../../plugins/lib_shmring.h"
 
 typedef enum {
   SOURCE_TYPE_FILE = 1,
   SOURCE_TYPE_MKFIFO = 2,
   SOURCE_TYPE_UNIX_DGRAM_SOCKET = 3,
   SOURCE_TYPE_STDIN = 4,
+  SOURCE_TYPE_SHM = 5,
 }SourceType;
 
 typedef struct {
@@ -32,6 +34,7 @@ typedef struct {
   gboolean reset;
   guint sent_packets;
   guint sent_bytes;
+  guint64 dropped_packets;
 }Source;
 
 Source* make_source(const gchar* string, guint item_size);
@@ -0,0 +1,157 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+#include "../plugins/lib_timerwheel.h"
+
+#define TIMERWHEEL_TEST_TIMERS_NUM 2000
+#define TIMERWHEEL_TEST_STEPS_NUM 20000
+#define TIMERWHEEL_TEST_SEEDS_NUM 30
+#define TIMERWHEEL_TEST_RESOLUTION (50 * GST_USECOND)
+
+typedef struct{
+  timerwheeltimer_t  timers[TIMERWHEEL_TEST_TIMERS_NUM];
+  GstClockTime       expires[TIMERWHEEL_TEST_TIMERS_NUM];
+  GstClockTime       now;
+  gboolean           failed;
+}TimerWheelTestState;
+
+static void _timerwheel_test_on_expired(TimerWheelTestState* state, timerwheeltimer_t* timer)
+{
+  gint32 index = timer - state->timers;
+  if(state->now < state->expires[index]){
+    g_print("timer %d expired at %lu, before its time %lu\n", index, state->now, state->expires[index]);
+    state->failed = TRUE;
+  }
+}
+
+//The earliest expiration time found by scanning every timer
+static GstClockTime _brute_force_next_expiry(TimerWheelTestState* state)
+{
+  GstClockTime result = GST_CLOCK_TIME_NONE;
+  gint32 i;
+  for(i = 0; i < TIMERWHEEL_TEST_TIMERS_NUM; ++i){
+    if(timerwheel_timer_is_pending(state->timers + i) &&
+       (result == GST_CLOCK_TIME_NONE || state->expires[i] < result)){
+      result = state->expires[i];
+    }
+  }
+  return result;
+}
+
+//No timer due at now may stay pending after the wheel advanced to it
+static gboolean _check_nothing_due(TimerWheelTestState* state)
+{
+  gint32 i;
+  for(i = 0; i < TIMERWHEEL_TEST_TIMERS_NUM; ++i){
+    if(timerwheel_timer_is_pending(state->timers + i) && state->expires[i] <= state->now){
+      g_print("timer %d due at %lu is still pending at %lu\n", i, state->expires[i], state->now);
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+//Adds, moves and removes random timers with expirations from a tick to beyond
+//the highest level and advances the wheel by random steps, some of them
+//exactly to the next expiry. The next expiry must match a brute force scan.
+static gboolean _test_random_operations(guint32 seed)
+{
+  TimerWheelTestState* state = g_malloc0(sizeof(TimerWheelTestState));
+  GRand* rand = g_rand_new_with_seed(seed);
+  timerwheel_t* wheel;
+  GstClockTime next, expected, delay;
+  gint32 step, op, i;
+  gboolean result = TRUE;
+
+  state->now = (GstClockTime) g_rand_int(rand) * 1000;
+  wheel = timerwheel_ctor(TIMERWHEEL_TEST_RESOLUTION, state->now);
+  for(step = 0; step < TIMERWHEEL_TEST_STEPS_NUM && result; ++step){
+    op = g_rand_int_range(rand, 0, 10);
+    i = g_rand_int_range(rand, 0, TIMERWHEEL_TEST_TIMERS_NUM);
+    if(op < 4){
+      if(g_rand_int_range(rand, 0, 4) == 0){
+        delay = g_rand_double(rand) * TIMERWHEEL_TEST_RESOLUTION * 30000000;
+      }else{
+        delay = g_rand_int_range(rand, 0, 200) * TIMERWHEEL_TEST_RESOLUTION + g_rand_int_range(rand, 0, TIMERWHEEL_TEST_RESOLUTION);
+      }
+      state->expires[i] = state->now + delay;
+      timerwheel_add(wheel, state->timers + i, state->expires[i]);
+      continue;
+    }
+    if(op < 5){
+      timerwheel_remove(wheel, state->timers + i);
+      continue;
+    }
+    next = timerwheel_get_next_expiry(wheel);
+    expected = _brute_force_next_expiry(state);
+    if(next != expected){
+      g_print("random operations test: FAILED with seed %u, next expiry is %lu instead of %lu\n",
+          seed, next, expected);
+      result = FALSE;
+      break;
+    }
+    if(op < 8){
+      state->now += g_rand_double(rand) * TIMERWHEEL_TEST_RESOLUTION * 100;
+    }else if(op < 9 && expected != GST_CLOCK_TIME_NONE){
+      state->now = MAX(state->now, expected);
+    }else{
+      state->now += g_rand_double(rand) * TIMERWHEEL_TEST_RESOLUTION * 100000;
+    }
+    timerwheel_advance(wheel, state->now, (TimerWheelExpired) _timerwheel_test_on_expired, state);
+    result = !state->failed && _check_nothing_due(state);
+  }
+  timerwheel_dtor(wheel);
+  g_rand_free(rand);
+  g_free(state);
+  return result;
+}
+
+//Advances from one next expiry to the other until every timer expired,
+//with a third of the timers far beyond the range of the lower levels.
+static gboolean _test_drain(void)
+{
+  TimerWheelTestState* state = g_malloc0(sizeof(TimerWheelTestState));
+  GRand* rand = g_rand_new_with_seed(1);
+  timerwheel_t* wheel;
+  gboolean result = TRUE;
+  gint32 i;
+
+  state->now = GST_MSECOND;
+  wheel = timerwheel_ctor(TIMERWHEEL_TEST_RESOLUTION, state->now);
+  for(i = 0; i < TIMERWHEEL_TEST_TIMERS_NUM; ++i){
+    state->expires[i] = state->now + (GstClockTime) g_rand_int_range(rand, 0, 2 * GST_SECOND) * (i % 3 ? 1 : 50);
+    timerwheel_add(wheel, state->timers + i, state->expires[i]);
+  }
+  timerwheel_remove(wheel, state->timers + 7);
+  while(wheel->timers_num && result){
+    state->now = MAX(state->now, timerwheel_get_next_expiry(wheel));
+    timerwheel_advance(wheel, state->now, (TimerWheelExpired) _timerwheel_test_on_expired, state);
+    result = !state->failed && _check_nothing_due(state);
+  }
+  timerwheel_dtor(wheel);
+  g_rand_free(rand);
+  g_free(state);
+  if(result){
+    g_print("drain test: OK\n");
+  }
+  return result;
+}
+
+int main (int argc, char **argv)
+{
+  gboolean passed = TRUE, result = TRUE;
+  guint32 seed;
+  gst_init(&argc, &argv);
+
+  for(seed = 1; seed < TIMERWHEEL_TEST_SEEDS_NUM && result; ++seed){
+    result = _test_random_operations(seed);
+  }
+  if(result){
+    g_print("random operations test: OK\n");
+  }
+  passed &= result;
+  passed &= _test_drain();
+
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+#include "../plugins/lib_typedsw.h"
+
+#define TYPEDSW_TEST_MAX_ITEMS 1024
+#define TYPEDSW_TEST_THRESHOLD (20 * GST_MSECOND)
+
+//Remembers the pointers and the values the add pipe got,
+//the rem pipe must get them back in the same order still holding the value,
+//so a slot reused before its value is removed is caught.
+typedef struct{
+  gint32*   pointers[TYPEDSW_TEST_MAX_ITEMS];
+  gint32    values[TYPEDSW_TEST_MAX_ITEMS];
+  gint32    head;
+  gint32    tail;
+  gboolean  failed;
+}TypedSWTestObserver;
+
+static void _typedsw_test_on_add(TypedSWTestObserver* observer, gint32* value)
+{
+  observer->pointers[observer->tail % TYPEDSW_TEST_MAX_ITEMS] = value;
+  observer->values[observer->tail % TYPEDSW_TEST_MAX_ITEMS] = *value;
+  ++observer->tail;
+}
+
+static void _typedsw_test_on_rem(TypedSWTestObserver* observer, gint32* value)
+{
+  gint32 index = observer->head % TYPEDSW_TEST_MAX_ITEMS;
+  if(observer->head == observer->tail){
+    g_print("removed %d from an empty window\n", *value);
+    observer->failed = TRUE;
+    return;
+  }
+  if(observer->pointers[index] != value || observer->values[index] != *value){
+    g_print("removed %d, expected %d\n", *value, observer->values[index]);
+    observer->failed = TRUE;
+  }
+  ++observer->head;
+}
+
+static typedsw_int32_t* _make_observed_window(TypedSWTestObserver* observer, gint32 num_limit, GstClockTime threshold)
+{
+  typedsw_int32_t* result = typedsw_int32_ctor(num_limit, threshold);
+  SlidingWindowPlugin* plugin = swplugin_ctor();
+  memset(observer, 0, sizeof(TypedSWTestObserver));
+  plugin->add_pipe = (void (*)(gpointer,gpointer)) _typedsw_test_on_add;
+  plugin->add_data = observer;
+  plugin->rem_pipe = (void (*)(gpointer,gpointer)) _typedsw_test_on_rem;
+  plugin->rem_data = observer;
+  plugin->disposer = g_free;
+  typedsw_add_plugin(TYPEDSW(result), plugin);
+  return result;
+}
+
+static gboolean _check_window(TypedSWTestObserver* observer, typedsw_int32_t* window,
+    const gchar* test, gint32 count, gint32 oldest)
+{
+  if(observer->failed){
+    g_print("%s test: FAILED, the rem pipe got a wrong value\n", test);
+    return FALSE;
+  }
+  if(typedsw_get_counter(TYPEDSW(window)) != count || observer->tail - observer->head != count){
+    g_print("%s test: FAILED, %d items instead of %d\n", test, typedsw_get_counter(TYPEDSW(window)), count);
+    return FALSE;
+  }
+  if(0 < count && *typedsw_int32_peek_oldest(window) != oldest){
+    g_print("%s test: FAILED, the oldest is %d instead of %d\n", test, *typedsw_int32_peek_oldest(window), oldest);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+//The window holds at most num_limit items, the ring wraps several times
+static gboolean _test_count_obsolation(void)
+{
+  TypedSWTestObserver observer;
+  typedsw_int32_t* window = _make_observed_window(&observer, 8, 0);
+  gboolean result = TRUE;
+  gint32 i;
+
+  for(i = 0; i < 100 && result; ++i){
+    typedsw_int32_add(window, i);
+    result = _check_window(&observer, window, "count obsolation", MIN(i + 1, 8), MAX(0, i - 7));
+  }
+  if(result && *typedsw_int32_peek_newest(window) != 99){
+    g_print("count obsolation test: FAILED, the newest is %d\n", *typedsw_int32_peek_newest(window));
+    result = FALSE;
+  }
+  typedsw_int32_clear(window);
+  result &= _check_window(&observer, window, "count obsolation", 0, 0);
+  typedsw_int32_dtor(window);
+  if(result){
+    g_print("count obsolation test: OK\n");
+  }
+  return result;
+}
+
+//Like SlidingWindow, an add first obsolates down to the act limit,
+//so the window has act_limit + 1 items afterwards
+static gboolean _test_act_limit_obsolation(void)
+{
+  TypedSWTestObserver observer;
+  typedsw_int32_t* window = _make_observed_window(&observer, 16, 0);
+  gboolean result = TRUE;
+  gint32 i;
+
+  for(i = 0; i < 16; ++i){
+    typedsw_int32_add(window, i);
+  }
+  typedsw_set_act_limit(TYPEDSW(window), 3);
+  for(i = 16; i < 40 && result; ++i){
+    typedsw_int32_add(window, i);
+    result = _check_window(&observer, window, "act limit obsolation", 4, i - 3);
+  }
+  typedsw_set_act_limit(TYPEDSW(window), 16);
+  for(i = 40; i < 60 && result; ++i){
+    typedsw_int32_add(window, i);
+    result = _check_window(&observer, window, "act limit obsolation", MIN(i - 35, 16), MAX(36, i - 15));
+  }
+  typedsw_int32_dtor(window);
+  if(result){
+    g_print("act limit obsolation test: OK\n");
+  }
+  return result;
+}
+
+//Items older than the threshold are removed at the next refresh,
+//except the min_itemnum newest ones
+static gboolean _test_time_obsolation(void)
+{
+  TypedSWTestObserver observer;
+  typedsw_int32_t* window = _make_observed_window(&observer, 100, TYPEDSW_TEST_THRESHOLD);
+  gboolean result = TRUE;
+  gint32 i;
+
+  for(i = 0; i < 10; ++i){
+    typedsw_int32_add(window, i);
+  }
+  typedsw_int32_refresh(window);
+  result &= _check_window(&observer, window, "time obsolation", 10, 0);
+  g_usleep(2 * GST_TIME_AS_USECONDS(TYPEDSW_TEST_THRESHOLD));
+  typedsw_int32_add(window, 10);
+  result &= _check_window(&observer, window, "time obsolation", 1, 10);
+  g_usleep(2 * GST_TIME_AS_USECONDS(TYPEDSW_TEST_THRESHOLD));
+  typedsw_int32_refresh(window);
+  result &= _check_window(&observer, window, "time obsolation", 0, 0);
+
+  typedsw_set_min_itemnum(TYPEDSW(window), 2);
+  for(i = 11; i < 20; ++i){
+    typedsw_int32_add(window, i);
+  }
+  g_usleep(2 * GST_TIME_AS_USECONDS(TYPEDSW_TEST_THRESHOLD));
+  typedsw_int32_refresh(window);
+  result &= _check_window(&observer, window, "time obsolation", 2, 18);
+  typedsw_int32_dtor(window);
+  if(result){
+    g_print("time obsolation test: OK\n");
+  }
+  return result;
+}
+
+int main (int argc, char **argv)
+{
+  gboolean passed = TRUE;
+  gst_init(&argc, &argv);
+
+  passed &= _test_count_obsolation();
+  passed &= _test_act_limit_obsolation();
+  passed &= _test_time_obsolation();
+
+  return passed ? 0 : 1;
+}